@@ -1,9 +1,10 @@
 #pragma once
 
-#include <thread>
 #include <memory>
 #include <vector>
 #include <tuple>
+#include <atomic>
+#include <mutex>
 
 #include "Awaitable.hpp"
 
@@ -14,21 +15,44 @@ namespace Event_Namespace__ {
     class EventHandler;
     template <typename... Args>
     class EventCaller;
+
+    // Handler lists are immutable snapshots. Firing takes the current
+    // snapshot and calls every handler on the firing thread without taking
+    // the writer lock, so a handler may Connect or Disconnect while it runs;
+    // Connect/Disconnect publish a copy and the old list lives on for as long
+    // as a firing still holds it. The lists and the writer lock belong to a
+    // block shared with the handlers, so a Disconnect racing ~Event either
+    // finds that block alive or does nothing.
     template <typename... Args>
     class Event final {
-        std::vector<std::shared_ptr<EventHandler<Args...>>> handles;
+        using HandlerList = std::vector<std::shared_ptr<EventHandler<Args...>>>;
+        struct Shared {
+            std::mutex write_mtx;
+            std::shared_ptr<const HandlerList> handles = std::make_shared<const HandlerList>();
+            void remove(EventHandler<Args...>* handler) {
+                std::lock_guard<std::mutex> lck(write_mtx);
+                auto cur = std::atomic_load(&handles);
+                auto next = std::make_shared<HandlerList>();
+                next->reserve(cur->size());
+                for (auto& h : *cur) {
+                    if (h.get() != handler) next->push_back(h);
+                }
+                std::atomic_store(&handles, std::shared_ptr<const HandlerList>(std::move(next)));
+            }
+        };
+        std::shared_ptr<Shared> shared = std::make_shared<Shared>();
         bool callermade = false;
         ArgumentedAwaitable<Args...> awaitable;
-        
-        template <typename... Args>
+
+        template <typename...>
         friend class EventHandler;
-        template <typename... Args>
+        template <typename...>
         friend class EventCaller;
-        
+
         void InternalCall(Args...);
 
     public:
-        Event() {};
+        Event() = default;
         ~Event();
         Event(const Event&) = delete;
         Event& operator=(const Event&) = delete;
@@ -36,53 +60,66 @@ namespace Event_Namespace__ {
         EventCaller<Args...> createCaller();
         std::shared_ptr<EventHandler<Args...>> Connect(void (*)(void*, Args...), void*);
         std::tuple<Args...> Wait();
+        size_t HandlerCount() {
+            return std::atomic_load(&shared->handles)->size();
+        }
     };
     template <typename... Args>
     class EventHandler final {
-        Event<Args...>* event;
-        bool isDisconnected = false;
-        void* instance;
+        using Shared = typename Event<Args...>::Shared;
+        std::weak_ptr<Shared> event;
+        std::atomic<bool> isDisconnected{false};
         void (*function)(void*,Args...);
-        template <typename... Args>
+        void* instance;
+        template <typename...>
         friend class Event;
-        EventHandler(Event<Args...>* e, void (*f)(void*,Args...), void* instance) : event(e), function(f), instance(instance) {};
-        ~EventHandler() {};
     public:
-        EventHandler() {
+        EventHandler(const std::shared_ptr<Shared>& e, void (*f)(void*,Args...), void* instance) : event(e), function(f), instance(instance) {};
+        EventHandler() : function(nullptr), instance(nullptr) {
             isDisconnected = true;
         }
         EventHandler(const EventHandler&) = delete;
         EventHandler& operator=(const EventHandler&) = delete;
+        bool Connected() {
+            return !isDisconnected;
+        }
         void Disconnect() {
-            if (!isDisconnected) {
-                isDisconnected = true;
-                event->handles.erase(std::remove(event->handles.begin(), event->handles.end(), std::shared_ptr<EventHandler<Args...>>(this)), event->handles.end());
-            }
+            if (isDisconnected.exchange(true)) return;
+            if (auto e = event.lock()) e->remove(this);
         }
     };
     template <typename... Args>
     class EventCaller final {
         Event<Args...>* event;
-        template <typename... Args>
+        template <typename...>
         friend class Event;
         EventCaller(Event<Args...>* e) : event(e) {};
-        ~EventCaller() {};
     public:
         void operator()(Args... args) {
-            event->InternalCall(event, args...);
+            event->InternalCall(args...);
         }
     };
     template <typename... Args>
+    Event<Args...>::~Event() {
+        std::lock_guard<std::mutex> lck(shared->write_mtx);
+        for (auto& h : *std::atomic_load(&shared->handles)) h->isDisconnected = true;
+    }
+    template <typename... Args>
     void Event<Args...>::InternalCall(Args... args) {
-        ArgumentedAwaitable.notify_all(args...);
-        for (auto& handle : handles) {
-            std::thread(handle->function, handle->instance, args...).detach();
+        awaitable.notify_all(args...);
+        auto list = std::atomic_load(&shared->handles);
+        for (auto& handle : *list) {
+            if (handle->isDisconnected.load(std::memory_order_relaxed)) continue;
+            handle->function(handle->instance, args...);
         }
     }
     template <typename... Args>
     std::shared_ptr<EventHandler<Args...>> Event<Args...>::Connect(void (*f)(void*,Args...), void* instance) {
-        auto handle = std::make_shared<Event_Handler<Args...>>(this, f, instance);
-        handles.push_back(handle);
+        auto handle = std::make_shared<EventHandler<Args...>>(shared, f, instance);
+        std::lock_guard<std::mutex> lck(shared->write_mtx);
+        auto next = std::make_shared<HandlerList>(*std::atomic_load(&shared->handles));
+        next->push_back(handle);
+        std::atomic_store(&shared->handles, std::shared_ptr<const HandlerList>(std::move(next)));
         return handle;
     }
     template <typename... Args>
@@ -92,9 +129,9 @@ namespace Event_Namespace__ {
     template <typename... Args>
     EventCaller<Args...> Event<Args...>::createCaller() {
         callermade = true;
-        return Event_Caller<Args...>(this);
+        return EventCaller<Args...>(this);
     }
 }
 using Event_Namespace__::Event;
 using Event_Namespace__::EventHandler;
-using Event_Namespace__::EventCaller;
\ No newline at end of file
+using Event_Namespace__::EventCaller;
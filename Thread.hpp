@@ -1,5 +1,10 @@
 #pragma once
 #include <thread>
+#include <atomic>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
 #include "Awaitable.hpp"
 class Thread : public Awaitable {
     std::thread* native_thread = nullptr;
@@ -30,6 +35,35 @@ public:
         detach();
         native_thread = new std::thread(func);
     }
+    void create(void (*func)(void*), void* instance) {
+        detach();
+        native_thread = new std::thread(func, instance);
+    }
+    // the new thread restricts itself to one core before func runs, so no
+    // work is ever done elsewhere; false if unsupported or refused, in
+    // which case func runs unpinned
+    bool create(void (*func)(void*), void* instance, int cpu) {
+        detach();
+        std::atomic<int> pinned{-1};
+        native_thread = new std::thread([func, instance, cpu, &pinned]() {
+            pinned.store(pinSelf(cpu) ? 1 : 0);
+            func(instance);
+        });
+        while (pinned.load() < 0) std::this_thread::yield();
+        return pinned.load() == 1;
+    }
+    // affinity is only set on Linux; elsewhere this reports false
+    static bool pinSelf(int cpu) {
+#ifdef __linux__
+        if (cpu < 0 || cpu >= CPU_SETSIZE) return false;
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+        return false;
+#endif
+    }
     Thread(std::thread* thr) {
         native_thread = thr;
     }
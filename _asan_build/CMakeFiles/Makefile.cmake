@@ -0,0 +1,76 @@
+# CMAKE generated file: DO NOT EDIT!
+# Generated by "Unix Makefiles" Generator, CMake Version 3.25
+
+# The generator used is:
+set(CMAKE_DEPENDS_GENERATOR "Unix Makefiles")
+
+# The top level Makefile was generated from the following files:
+set(CMAKE_MAKEFILE_DEPENDS
+  "CMakeCache.txt"
+  "/root/repo/CMakeLists.txt"
+  "CMakeFiles/3.25.1/CMakeCXXCompiler.cmake"
+  "CMakeFiles/3.25.1/CMakeSystem.cmake"
+  "/root/repo/tests/CMakeLists.txt"
+  "/usr/share/cmake-3.25/Modules/CMakeCXXInformation.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeCommonLanguageInclude.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeGenericSystem.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeInitializeConfigs.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeLanguageInformation.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeSystemSpecificInformation.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeSystemSpecificInitialize.cmake"
+  "/usr/share/cmake-3.25/Modules/CheckCXXSourceCompiles.cmake"
+  "/usr/share/cmake-3.25/Modules/CheckIncludeFileCXX.cmake"
+  "/usr/share/cmake-3.25/Modules/CheckLibraryExists.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/CMakeCommonCompilerMacros.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/GNU-CXX.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/GNU.cmake"
+  "/usr/share/cmake-3.25/Modules/FindPackageHandleStandardArgs.cmake"
+  "/usr/share/cmake-3.25/Modules/FindPackageMessage.cmake"
+  "/usr/share/cmake-3.25/Modules/FindThreads.cmake"
+  "/usr/share/cmake-3.25/Modules/Internal/CheckSourceCompiles.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/Linux-GNU-CXX.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/Linux-GNU.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/Linux.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/UnixPaths.cmake"
+  )
+
+# The corresponding makefile is:
+set(CMAKE_MAKEFILE_OUTPUTS
+  "Makefile"
+  "CMakeFiles/cmake.check_cache"
+  )
+
+# Byproducts of CMake generate step:
+set(CMAKE_MAKEFILE_PRODUCTS
+  "CMakeFiles/CMakeDirectoryInformation.cmake"
+  "tests/CMakeFiles/CMakeDirectoryInformation.cmake"
+  )
+
+# Dependency information for all targets:
+set(CMAKE_DEPEND_INFO_FILES
+  "tests/CMakeFiles/test_headers.dir/DependInfo.cmake"
+  "tests/CMakeFiles/test_diagnostics.dir/DependInfo.cmake"
+  "tests/CMakeFiles/test_serializer.dir/DependInfo.cmake"
+  "tests/CMakeFiles/test_stimulus.dir/DependInfo.cmake"
+  "tests/CMakeFiles/test_cosim.dir/DependInfo.cmake"
+  "tests/CMakeFiles/test_netlist.dir/DependInfo.cmake"
+  "tests/CMakeFiles/test_config.dir/DependInfo.cmake"
+  "tests/CMakeFiles/test_cyclesim.dir/DependInfo.cmake"
+  "tests/CMakeFiles/test_timing.dir/DependInfo.cmake"
+  "tests/CMakeFiles/test_activity.dir/DependInfo.cmake"
+  "tests/CMakeFiles/test_resistive.dir/DependInfo.cmake"
+  "tests/CMakeFiles/test_random.dir/DependInfo.cmake"
+  "tests/CMakeFiles/test_demand.dir/DependInfo.cmake"
+  "tests/CMakeFiles/test_jit.dir/DependInfo.cmake"
+  "tests/CMakeFiles/test_vectorfile.dir/DependInfo.cmake"
+  "tests/CMakeFiles/test_settle.dir/DependInfo.cmake"
+  "tests/CMakeFiles/test_realtime.dir/DependInfo.cmake"
+  "tests/CMakeFiles/test_events.dir/DependInfo.cmake"
+  "tests/CMakeFiles/test_subcircuit.dir/DependInfo.cmake"
+  "tests/CMakeFiles/test_aig.dir/DependInfo.cmake"
+  "tests/CMakeFiles/test_watchpoints.dir/DependInfo.cmake"
+  "tests/CMakeFiles/test_memorygates.dir/DependInfo.cmake"
+  "tests/CMakeFiles/test_faultsim.dir/DependInfo.cmake"
+  "tests/CMakeFiles/test_mainsim.dir/DependInfo.cmake"
+  "tests/CMakeFiles/test_partition.dir/DependInfo.cmake"
+  )
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test_cyclesim.dir/cyclesim.cpp.o"
+  "CMakeFiles/test_cyclesim.dir/cyclesim.cpp.o.d"
+  "test_cyclesim"
+  "test_cyclesim.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test_cyclesim.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
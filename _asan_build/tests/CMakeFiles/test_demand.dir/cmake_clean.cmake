@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test_demand.dir/demand.cpp.o"
+  "CMakeFiles/test_demand.dir/demand.cpp.o.d"
+  "test_demand"
+  "test_demand.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test_demand.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
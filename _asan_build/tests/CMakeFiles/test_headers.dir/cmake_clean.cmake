@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test_headers.dir/headers.cpp.o"
+  "CMakeFiles/test_headers.dir/headers.cpp.o.d"
+  "test_headers"
+  "test_headers.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test_headers.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test_mainsim.dir/mainsim.cpp.o"
+  "CMakeFiles/test_mainsim.dir/mainsim.cpp.o.d"
+  "test_mainsim"
+  "test_mainsim.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test_mainsim.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
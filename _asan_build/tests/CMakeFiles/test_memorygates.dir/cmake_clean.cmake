@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test_memorygates.dir/memorygates.cpp.o"
+  "CMakeFiles/test_memorygates.dir/memorygates.cpp.o.d"
+  "test_memorygates"
+  "test_memorygates.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test_memorygates.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test_resistive.dir/resistive.cpp.o"
+  "CMakeFiles/test_resistive.dir/resistive.cpp.o.d"
+  "test_resistive"
+  "test_resistive.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test_resistive.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
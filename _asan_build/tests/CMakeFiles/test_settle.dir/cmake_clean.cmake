@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test_settle.dir/settle.cpp.o"
+  "CMakeFiles/test_settle.dir/settle.cpp.o.d"
+  "test_settle"
+  "test_settle.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test_settle.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
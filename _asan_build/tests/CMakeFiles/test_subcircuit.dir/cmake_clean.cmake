@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test_subcircuit.dir/subcircuit.cpp.o"
+  "CMakeFiles/test_subcircuit.dir/subcircuit.cpp.o.d"
+  "test_subcircuit"
+  "test_subcircuit.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test_subcircuit.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test_vectorfile.dir/vectorfile.cpp.o"
+  "CMakeFiles/test_vectorfile.dir/vectorfile.cpp.o.d"
+  "test_vectorfile"
+  "test_vectorfile.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test_vectorfile.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
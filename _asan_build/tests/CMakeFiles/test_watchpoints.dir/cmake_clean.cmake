@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test_watchpoints.dir/watchpoints.cpp.o"
+  "CMakeFiles/test_watchpoints.dir/watchpoints.cpp.o.d"
+  "test_watchpoints"
+  "test_watchpoints.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test_watchpoints.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
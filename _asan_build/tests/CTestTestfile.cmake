@@ -0,0 +1,56 @@
+# CMake generated Testfile for 
+# Source directory: /root/repo/tests
+# Build directory: /root/repo/_asan_build/tests
+# 
+# This file includes the relevant testing commands required for 
+# testing this directory and lists subdirectories to be tested as well.
+add_test(headers "/root/repo/_asan_build/tests/test_headers")
+set_tests_properties(headers PROPERTIES  WORKING_DIRECTORY "/root/repo/_asan_build/tests" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;32;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(diagnostics "/root/repo/_asan_build/tests/test_diagnostics")
+set_tests_properties(diagnostics PROPERTIES  WORKING_DIRECTORY "/root/repo/_asan_build/tests" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;32;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(serializer "/root/repo/_asan_build/tests/test_serializer")
+set_tests_properties(serializer PROPERTIES  WORKING_DIRECTORY "/root/repo/_asan_build/tests" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;32;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(stimulus "/root/repo/_asan_build/tests/test_stimulus")
+set_tests_properties(stimulus PROPERTIES  WORKING_DIRECTORY "/root/repo/_asan_build/tests" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;32;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(cosim "/root/repo/_asan_build/tests/test_cosim")
+set_tests_properties(cosim PROPERTIES  WORKING_DIRECTORY "/root/repo/_asan_build/tests" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;32;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(netlist "/root/repo/_asan_build/tests/test_netlist")
+set_tests_properties(netlist PROPERTIES  WORKING_DIRECTORY "/root/repo/_asan_build/tests" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;32;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(config "/root/repo/_asan_build/tests/test_config")
+set_tests_properties(config PROPERTIES  WORKING_DIRECTORY "/root/repo/_asan_build/tests" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;32;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(cyclesim "/root/repo/_asan_build/tests/test_cyclesim")
+set_tests_properties(cyclesim PROPERTIES  WORKING_DIRECTORY "/root/repo/_asan_build/tests" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;32;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(timing "/root/repo/_asan_build/tests/test_timing")
+set_tests_properties(timing PROPERTIES  WORKING_DIRECTORY "/root/repo/_asan_build/tests" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;32;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(activity "/root/repo/_asan_build/tests/test_activity")
+set_tests_properties(activity PROPERTIES  WORKING_DIRECTORY "/root/repo/_asan_build/tests" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;32;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(resistive "/root/repo/_asan_build/tests/test_resistive")
+set_tests_properties(resistive PROPERTIES  WORKING_DIRECTORY "/root/repo/_asan_build/tests" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;32;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(random "/root/repo/_asan_build/tests/test_random")
+set_tests_properties(random PROPERTIES  WORKING_DIRECTORY "/root/repo/_asan_build/tests" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;32;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(demand "/root/repo/_asan_build/tests/test_demand")
+set_tests_properties(demand PROPERTIES  WORKING_DIRECTORY "/root/repo/_asan_build/tests" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;32;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(jit "/root/repo/_asan_build/tests/test_jit")
+set_tests_properties(jit PROPERTIES  SKIP_RETURN_CODE "77" WORKING_DIRECTORY "/root/repo/_asan_build/tests" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;32;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(vectorfile "/root/repo/_asan_build/tests/test_vectorfile")
+set_tests_properties(vectorfile PROPERTIES  WORKING_DIRECTORY "/root/repo/_asan_build/tests" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;32;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(settle "/root/repo/_asan_build/tests/test_settle")
+set_tests_properties(settle PROPERTIES  WORKING_DIRECTORY "/root/repo/_asan_build/tests" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;32;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(realtime "/root/repo/_asan_build/tests/test_realtime")
+set_tests_properties(realtime PROPERTIES  WORKING_DIRECTORY "/root/repo/_asan_build/tests" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;32;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(events "/root/repo/_asan_build/tests/test_events")
+set_tests_properties(events PROPERTIES  WORKING_DIRECTORY "/root/repo/_asan_build/tests" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;32;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(subcircuit "/root/repo/_asan_build/tests/test_subcircuit")
+set_tests_properties(subcircuit PROPERTIES  WORKING_DIRECTORY "/root/repo/_asan_build/tests" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;32;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(aig "/root/repo/_asan_build/tests/test_aig")
+set_tests_properties(aig PROPERTIES  WORKING_DIRECTORY "/root/repo/_asan_build/tests" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;32;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(watchpoints "/root/repo/_asan_build/tests/test_watchpoints")
+set_tests_properties(watchpoints PROPERTIES  WORKING_DIRECTORY "/root/repo/_asan_build/tests" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;32;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(memorygates "/root/repo/_asan_build/tests/test_memorygates")
+set_tests_properties(memorygates PROPERTIES  WORKING_DIRECTORY "/root/repo/_asan_build/tests" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;32;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(faultsim "/root/repo/_asan_build/tests/test_faultsim")
+set_tests_properties(faultsim PROPERTIES  WORKING_DIRECTORY "/root/repo/_asan_build/tests" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;32;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(mainsim "/root/repo/_asan_build/tests/test_mainsim")
+set_tests_properties(mainsim PROPERTIES  WORKING_DIRECTORY "/root/repo/_asan_build/tests" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;32;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(partition "/root/repo/_asan_build/tests/test_partition")
+set_tests_properties(partition PROPERTIES  WORKING_DIRECTORY "/root/repo/_asan_build/tests" _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;32;add_test;/root/repo/tests/CMakeLists.txt;0;")
@@ -0,0 +1,97 @@
+// c++ -O2
+// c++ (Debian 12.2.0-14+deb12u1) 12.2.0
+// Copyright (C) 2022 Free Software Foundation, Inc.
+// This is free software; see the source for copying conditions.  There is NO
+// warranty; not even for MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// 
+// generated by LogicSim::NativeCompiler
+extern "C" {
+extern const unsigned long long lsjit_slots = 48ULL;
+static void lsjit_part0(unsigned long long* __restrict v) {
+    unsigned long long t;
+    t = (v[1] & v[4]) & 0x1ULL;
+    v[5] = t;
+    t = (v[6] | v[4]) & 0x1ULL;
+    v[7] = t;
+    t = ~(v[9] | v[4]) & 0x1ULL;
+    v[11] = t;
+    t = ~(v[1]) & 0x1ULL;
+    v[13] = t;
+    t = (v[1] | v[16]) & 0x1ULL;
+    v[17] = t;
+    t = ~(v[9] ^ v[1]) & 0x1ULL;
+    v[29] = t;
+    t = ~(v[1]) & 0x1ULL;
+    v[30] = t;
+    t = ~(v[4]) & 0x1ULL;
+    v[38] = t;
+    t = ~(v[16] | v[16]) & 0x1ULL;
+    v[44] = t;
+    t = (v[5]) & 0x1ULL;
+    v[14] = t;
+    t = ~(v[1] & v[5]) & 0x1ULL;
+    v[19] = t;
+    t = (v[9] & v[5]) & 0x1ULL;
+    v[32] = t;
+    t = (v[7] ^ v[4]) & 0x1ULL;
+    v[8] = t;
+    t = ~(v[9] & v[7]) & 0x1ULL;
+    v[10] = t;
+    t = ~(v[5] ^ v[11]) & 0x1ULL;
+    v[12] = t;
+    t = (v[16] | v[13]) & 0x1ULL;
+    v[33] = t;
+    t = (v[17] ^ v[6]) & 0x1ULL;
+    v[18] = t;
+    t = (v[14] | v[3]) & 0x1ULL;
+    v[25] = t;
+    t = ~(v[6] & v[8]) & 0x1ULL;
+    v[27] = t;
+    t = ~(v[5] ^ v[8]) & 0x1ULL;
+    v[37] = t;
+    t = (v[11] & v[12]) & 0x1ULL;
+    v[15] = t;
+    t = ~(v[11] | v[18]) & 0x1ULL;
+    v[20] = t;
+    t = (v[9] & v[18]) & 0x1ULL;
+    v[24] = t;
+    t = ~(v[1] | v[18]) & 0x1ULL;
+    v[28] = t;
+    t = (v[7] ^ v[25]) & 0x1ULL;
+    v[26] = t;
+    t = ~(v[27] & v[4]) & 0x1ULL;
+    v[43] = t;
+    t = ~(v[13] ^ v[15]) & 0x1ULL;
+    v[21] = t;
+    t = ~(v[15]) & 0x1ULL;
+    v[22] = t;
+    t = (v[13] ^ v[24]) & 0x1ULL;
+    v[34] = t;
+    t = ~(v[24] & v[15]) & 0x1ULL;
+    v[35] = t;
+    t = (v[24] ^ v[17]) & 0x1ULL;
+    v[42] = t;
+    t = (v[26]) & 0x1ULL;
+    v[31] = t;
+    t = ~(v[43] ^ v[8]) & 0x1ULL;
+    v[45] = t;
+    t = (v[21]) & 0x1ULL;
+    v[23] = t;
+    t = (v[21]) & 0x1ULL;
+    v[0] = t;
+    t = (v[4] | v[22]) & 0x1ULL;
+    v[41] = t;
+    t = ~(v[34] | v[19]) & 0x1ULL;
+    v[36] = t;
+    t = (v[23]) & 0x1ULL;
+    v[39] = t;
+    t = (v[17] & v[36]) & 0x1ULL;
+    v[40] = t;
+    t = ~(v[40]) & 0x1ULL;
+    v[2] = t;
+}
+void lsjit_evaluate(unsigned long long* __restrict v) {
+    lsjit_part0(v);
+    v[46] = 0;
+}
+}
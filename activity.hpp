@@ -0,0 +1,231 @@
+#pragma once
+
+#include <vector>
+#include <string>
+
+#include "main_init.hpp"
+#include "netlist.hpp"
+#include "mainsim.hpp"
+#include "cyclesim.hpp"
+#include "serializer.hpp"
+
+namespace LogicSim {
+    // Per-wire switching activity for power estimation. Counters are kept as
+    // parallel arrays indexed by a slot stored in the Wire itself, and every
+    // word counts all of its bits at once: rise/fall are bit transitions and
+    // high is bit-time spent at 1, so single-bit nets give SAIF T1/TC directly.
+    //
+    // Event-driven runs are collected from the value-change path in Pin::drive
+    // (time taken from a MainSim, if given); cycle-based runs are sampled from
+    // a CycleSimulator once per cycle. A change hook installed before start()
+    // keeps being called and is put back by stop().
+    class ActivityCollector final : public LogicSimObject {
+        inline static ActivityCollector* active = nullptr;
+        // whatever hook was installed before start(); called after ours
+        inline static void (*chained)(Wire*, unsigned short, unsigned long long, unsigned long long) = nullptr;
+        inline static unsigned long long next_generation = 1;
+        unsigned long long generation;
+        MainSim* sim;
+        vector<Wire*> wires;
+        vector<string> names;
+        vector<unsigned long long> rise;
+        vector<unsigned long long> fall;
+        vector<unsigned long long> high;
+        vector<unsigned long long> value;
+        vector<unsigned long long> since;
+        vector<unsigned long long> seen;
+        vector<unsigned int> netlist_slots;
+        vector<unsigned long long> previous;
+        bool identity = false;
+        SimTime start_time = 0;
+        unsigned long long duration = 0;
+
+        SimTime now() {
+            return sim != nullptr ? sim->getTime() : 0;
+        }
+        static void onWireChange(Wire* w, unsigned short index, unsigned long long before, unsigned long long after) {
+            if (index == 0 && active != nullptr) active->record(w, before, after);
+            if (chained != nullptr) chained(w, index, before, after);
+        }
+        static unsigned long long currentBits(Wire* w) {
+            return w->getStateCount() == 0 ? 0 : wire_value_bits(w->getWireState(0)->peekState());
+        }
+        // a wire first seen mid-run held initial since the run started
+        unsigned int slotFor(Wire* w, unsigned long long initial) {
+            unsigned long long tag = w->getActivityTag();
+            if ((tag >> 32) == generation) return (unsigned int)tag;
+            unsigned int s = (unsigned int)wires.size();
+            w->setActivityTag((generation << 32) | s);
+            wires.push_back(w);
+            names.emplace_back();
+            rise.push_back(0);
+            fall.push_back(0);
+            high.push_back(0);
+            value.push_back(initial);
+            since.push_back(start_time);
+            seen.push_back(initial);
+            return s;
+        }
+        void record(Wire* w, unsigned long long before, unsigned long long after) {
+            unsigned int s = slotFor(w, before);
+            SimTime t = now();
+            high[s] += (unsigned long long)count_ones(value[s]) * (t - since[s]);
+            rise[s] += (unsigned long long)count_ones(~before & after);
+            fall[s] += (unsigned long long)count_ones(before & ~after);
+            value[s] = after;
+            since[s] = t;
+            seen[s] |= after;
+        }
+        void bindNetlist(Netlist& netlist, const vector<unsigned long long>& v) {
+            auto& nw = netlist.getWires();
+            identity = wires.empty();
+            netlist_slots.resize(nw.size());
+            for (unsigned int i = 0; i < nw.size(); i++) {
+                netlist_slots[i] = slotFor(nw[i], v[i]);
+                identity = identity && netlist_slots[i] == i;
+            }
+            previous.assign(v.begin(), v.begin() + nw.size());
+        }
+    public:
+        virtual const char* getObjectType() {
+            return "ActivityCollector";
+        }
+        ActivityCollector(MainSim* sim = nullptr) : generation(next_generation++), sim(sim) {};
+        ActivityCollector(const ActivityCollector&) = delete;
+        ActivityCollector& operator=(const ActivityCollector&) = delete;
+        ~ActivityCollector() {
+            stop();
+        }
+        void start() {
+            if (active != nullptr && active != this)
+                throw LogicSimException("Another activity collector is already running", this);
+            active = this;
+            if (wire_change_hook != onWireChange) {
+                chained = wire_change_hook;
+                wire_change_hook = onWireChange;
+            }
+            start_time = now();
+            for (size_t s = 0; s < wires.size(); s++) since[s] = start_time;
+        }
+        // also gives every wire of netlist a slot up front, so nets that
+        // never toggle are still reported
+        void start(Netlist& netlist) {
+            start();
+            for (auto w : netlist.getWires()) slotFor(w, currentBits(w));
+        }
+        // closes the open high intervals and unhooks; counters are kept
+        void stop() {
+            if (active != this) return;
+            SimTime t = now();
+            for (size_t s = 0; s < wires.size(); s++) {
+                high[s] += (unsigned long long)count_ones(value[s]) * (t - since[s]);
+                since[s] = t;
+            }
+            duration += t - start_time;
+            // a hook installed on top of ours still calls it, so it stays
+            if (wire_change_hook == onWireChange) {
+                wire_change_hook = chained;
+                chained = nullptr;
+            }
+            active = nullptr;
+        }
+        // one cycle of a CycleSimulator; the wire arrays are walked in
+        // netlist order so the common case is a straight vectorizable loop
+        void sample(CycleSimulator& cs, Netlist& netlist) {
+            const vector<unsigned long long>& v = cs.getValues();
+            size_t n = netlist.getWires().size();
+            if (netlist_slots.size() != n) bindNetlist(netlist, v);
+            const unsigned long long* cur = v.data();
+            unsigned long long* prev = previous.data();
+            if (identity) {
+                unsigned long long* r = rise.data();
+                unsigned long long* f = fall.data();
+                unsigned long long* h = high.data();
+                unsigned long long* sn = seen.data();
+                for (size_t i = 0; i < n; i++) {
+                    unsigned long long c = cur[i], p = prev[i];
+                    r[i] += (unsigned long long)count_ones(~p & c);
+                    f[i] += (unsigned long long)count_ones(p & ~c);
+                    h[i] += (unsigned long long)count_ones(c);
+                    sn[i] |= c;
+                    prev[i] = c;
+                }
+            } else {
+                for (size_t i = 0; i < n; i++) {
+                    unsigned int s = netlist_slots[i];
+                    unsigned long long c = cur[i], p = prev[i];
+                    rise[s] += (unsigned long long)count_ones(~p & c);
+                    fall[s] += (unsigned long long)count_ones(p & ~c);
+                    high[s] += (unsigned long long)count_ones(c);
+                    seen[s] |= c;
+                    prev[i] = c;
+                }
+            }
+            duration++;
+        }
+        void reset() {
+            for (size_t s = 0; s < wires.size(); s++) {
+                rise[s] = fall[s] = high[s] = 0;
+                since[s] = now();
+                seen[s] = value[s];
+            }
+            // cycle runs keep the current values in previous[], not value[]
+            for (size_t i = 0; i < netlist_slots.size(); i++) seen[netlist_slots[i]] = previous[i];
+            start_time = now();
+            duration = 0;
+        }
+        void setName(Wire* w, const string& name) {
+            names[slotFor(w, currentBits(w))] = name;
+        }
+        unsigned long long getDuration() {
+            return duration;
+        }
+        unsigned long long getRises(Wire* w) {
+            unsigned long long tag = w->getActivityTag();
+            return (tag >> 32) == generation ? rise[(unsigned int)tag] : 0;
+        }
+        unsigned long long getFalls(Wire* w) {
+            unsigned long long tag = w->getActivityTag();
+            return (tag >> 32) == generation ? fall[(unsigned int)tag] : 0;
+        }
+        unsigned long long getHighTime(Wire* w) {
+            unsigned long long tag = w->getActivityTag();
+            return (tag >> 32) == generation ? high[(unsigned int)tag] : 0;
+        }
+        // transitions per time unit
+        double toggleRate(Wire* w) {
+            if (duration == 0) return 0;
+            return (double)(getRises(w) + getFalls(w)) / (double)duration;
+        }
+        // SAIF 2.0 style backward annotation; buses report aggregate bit-times
+        // with T0 derived from the widest value seen on the net
+        void writeSAIF(StateWriter& out, const string& design = "top") {
+            out.put("(SAIFILE\n(SAIFVERSION \"2.0\")\n(DIRECTION \"backward\")\n(DESIGN \"");
+            out.put(design.data(), design.size());
+            out.put("\")\n(DURATION ");
+            out.putInt(duration);
+            out.put(")\n(INSTANCE ");
+            out.put(design.data(), design.size());
+            out.put("\n  (NET\n");
+            for (size_t s = 0; s < wires.size(); s++) {
+                unsigned long long width = seen[s] == 0 ? 1 : 64 - (unsigned long long)count_leading_zeros(seen[s]);
+                unsigned long long total = duration * width;
+                out.put("    (");
+                if (names[s].empty()) {
+                    out.put('n');
+                    out.putInt(s);
+                } else {
+                    out.put(names[s].data(), names[s].size());
+                }
+                out.put(" (T0 ");
+                out.putInt(total > high[s] ? total - high[s] : 0);
+                out.put(") (T1 ");
+                out.putInt(high[s]);
+                out.put(") (TC ");
+                out.putInt(rise[s] + fall[s]);
+                out.put(") (IG 0))\n");
+            }
+            out.put("  )\n)\n)\n");
+        }
+    };
+};
@@ -0,0 +1,317 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <unordered_map>
+
+#include "main_init.hpp"
+#include "netlist.hpp"
+#include "digitallogicgates.hpp"
+
+namespace LogicSim {
+    // And-inverter graph with structural hashing. A literal is node * 2 plus
+    // a complement bit; node 0 is constant false, so literal 0 is false and
+    // literal 1 is true. Inputs are nodes without fanins.
+    class AIG final : public LogicSimObject {
+        struct Node {
+            unsigned int a;
+            unsigned int b;
+        };
+        vector<Node> nodes;
+        unordered_map<unsigned long long, unsigned int> strash;
+    public:
+        static constexpr unsigned int LIT_FALSE = 0;
+        static constexpr unsigned int LIT_TRUE = 1;
+        virtual const char* getObjectType() {
+            return "AIG";
+        }
+        AIG() {
+            nodes.push_back({NO_INDEX, NO_INDEX});
+        }
+        static unsigned int negate(unsigned int l) {
+            return l ^ 1;
+        }
+        unsigned int input() {
+            nodes.push_back({NO_INDEX, NO_INDEX});
+            return (unsigned int)(nodes.size() - 1) * 2;
+        }
+        unsigned int andOf(unsigned int a, unsigned int b) {
+            if (a > b) std::swap(a, b);
+            if (a == LIT_FALSE || a == negate(b)) return LIT_FALSE;
+            if (a == LIT_TRUE || a == b) return b;
+            unsigned long long key = ((unsigned long long)a << 32) | b;
+            auto it = strash.find(key);
+            if (it != strash.end()) return it->second;
+            nodes.push_back({a, b});
+            unsigned int l = (unsigned int)(nodes.size() - 1) * 2;
+            strash[key] = l;
+            return l;
+        }
+        unsigned int orOf(unsigned int a, unsigned int b) {
+            return negate(andOf(negate(a), negate(b)));
+        }
+        unsigned int xorOf(unsigned int a, unsigned int b) {
+            return orOf(andOf(a, negate(b)), andOf(negate(a), b));
+        }
+        unsigned int build(LogicFunction f, const vector<unsigned int>& in) {
+            unsigned int v = in.empty() ? LIT_FALSE : in[0];
+            for (size_t i = 1; i < in.size(); i++) {
+                switch (f) {
+                case LogicFunction::AND:
+                case LogicFunction::NAND:
+                    v = andOf(v, in[i]);
+                    break;
+                case LogicFunction::OR:
+                case LogicFunction::NOR:
+                    v = orOf(v, in[i]);
+                    break;
+                case LogicFunction::XOR:
+                case LogicFunction::XNOR:
+                    v = xorOf(v, in[i]);
+                    break;
+                default:
+                    break;
+                }
+            }
+            switch (f) {
+            case LogicFunction::NOT:
+            case LogicFunction::NAND:
+            case LogicFunction::NOR:
+            case LogicFunction::XNOR:
+                return negate(v);
+            default:
+                return v;
+            }
+        }
+        size_t size() {
+            return nodes.size();
+        }
+        size_t andCount() {
+            return strash.size();
+        }
+    };
+
+    struct StructuralReport {
+        size_t gates_before = 0;
+        size_t gates_after = 0;
+        size_t merged_wires = 0;
+        size_t constant_wires = 0;
+        size_t removed_gates = 0;
+        size_t and_nodes = 0;
+    };
+
+    // Pre-simulation cleanup of a Netlist. Single-bit combinational logic is
+    // hashed into an AIG; wires that end up with the same literal are merged
+    // onto the first of them in topological order, wires with a constant
+    // literal are moved onto a shared ConstantGate, and logic with no path to
+    // an observable wire is removed. Observable wires are primary outputs,
+    // inputs of gates that cannot be hashed (sequential, multi-bit, or no
+    // logic function) and explicitly probed wires; observe() maps any of the
+    // original wires to the live wire carrying its value. The constant gates
+    // belong to the optimizer, which must outlive the optimized circuit.
+    class StructuralOptimizer final : public LogicSimObject {
+        Netlist& netlist;
+        AIG aig;
+        vector<unsigned int> wire_lit;
+        unordered_map<unsigned int, unsigned int> lit_wire;
+        vector<bool> probed;
+        unique_ptr<DigitalLogic::ConstantGate> constants[2];
+        unique_ptr<Wire> constant_wires[2];
+        unordered_map<Wire*, Wire*> mapping;
+
+        bool hashable(unsigned int g) {
+            NetlistGate& ng = netlist.getGates()[g];
+            if (ng.gate == nullptr || ng.gate->isSequential() || ng.function == LogicFunction::NONE) return false;
+            if (ng.gate->isConfigurable()) {
+                auto c = (ConfigurableBasicGate*)ng.gate;
+                auto a = c->config_table.find(ConfigKeys::Bits);
+                if (a != c->config_table.end() && a->second.get()->get_t<unsigned short>() != 1) return false;
+            }
+            for (auto w : ng.outputs) {
+                if (w != NO_INDEX && netlist.getDrivers(w).size() != 1) return false;
+            }
+            return true;
+        }
+        Wire* constantWire(bool v) {
+            if (!constants[v]) {
+                constants[v].reset(new DigitalLogic::ConstantGate(v));
+                constant_wires[v].reset(new Wire());
+                connect(constants[v]->getPin(0), constant_wires[v].get());
+                constants[v]->drive();
+                netlist.addGate(constants[v].get());
+            }
+            return constant_wires[v].get();
+        }
+        // hashable gates in topological order; everything else is a cut point
+        vector<unsigned int> order() {
+            auto& gates = netlist.getGates();
+            vector<unsigned int> pending(gates.size(), 0), ready;
+            vector<bool> logic(gates.size(), false);
+            for (unsigned int g = 0; g < gates.size(); g++) logic[g] = hashable(g);
+            for (unsigned int g = 0; g < gates.size(); g++) {
+                if (!logic[g]) continue;
+                for (auto w : gates[g].inputs) {
+                    if (w == NO_INDEX) continue;
+                    for (auto d : netlist.getDrivers(w)) {
+                        if (d != g && logic[d]) pending[g]++;
+                    }
+                }
+                if (pending[g] == 0) ready.push_back(g);
+            }
+            for (size_t i = 0; i < ready.size(); i++) {
+                for (auto w : gates[ready[i]].outputs) {
+                    if (w == NO_INDEX) continue;
+                    for (auto r : netlist.getFanout(w)) {
+                        if (r != ready[i] && logic[r] && --pending[r] == 0) ready.push_back(r);
+                    }
+                }
+            }
+            for (unsigned int g = 0; g < gates.size(); g++) {
+                if (logic[g] && pending[g] != 0)
+                    throw LogicSimException("Combinational loop prevents structural hashing", gates[g].gate);
+            }
+            return ready;
+        }
+        void moveReaders(unsigned int from, Wire* to) {
+            vector<Pin*> pins;
+            for (auto r : netlist.getFanout(from)) {
+                NetlistGate& ng = netlist.getGates()[r];
+                for (size_t k = 0; k < ng.inputs.size(); k++) {
+                    if (ng.inputs[k] == from) pins.push_back(ng.input_pins[k]);
+                }
+            }
+            std::sort(pins.begin(), pins.end());
+            pins.erase(std::unique(pins.begin(), pins.end()), pins.end());
+            for (auto p : pins) netlist.connectPin(p, to);
+        }
+    public:
+        virtual const char* getObjectType() {
+            return "StructuralOptimizer";
+        }
+        StructuralOptimizer(Netlist& netlist) : netlist(netlist) {};
+        StructuralOptimizer(const StructuralOptimizer&) = delete;
+        StructuralOptimizer& operator=(const StructuralOptimizer&) = delete;
+        // keeps w (or a wire equivalent to it) alive through the optimization
+        void probe(Wire* w) {
+            unsigned int id = netlist.wireIndex(w);
+            if (id == NO_INDEX) return;
+            if (probed.size() <= id) probed.resize(id + 1, false);
+            probed[id] = true;
+        }
+        StructuralReport optimize() {
+            StructuralReport report;
+            auto& gates = netlist.getGates();
+            for (auto& ng : gates) {
+                if (ng.gate != nullptr) report.gates_before++;
+            }
+            vector<unsigned int> topo = order();
+            size_t nw = netlist.getWires().size();
+            wire_lit.assign(nw, NO_INDEX);
+            probed.resize(nw, false);
+            vector<bool> from_logic(nw, false);
+            for (auto g : topo) {
+                for (auto w : gates[g].outputs) {
+                    if (w != NO_INDEX) from_logic[w] = true;
+                }
+            }
+            for (unsigned int w = 0; w < nw; w++) {
+                if (!from_logic[w]) wire_lit[w] = aig.input();
+            }
+            vector<unsigned int> in;
+            for (auto g : topo) {
+                in.clear();
+                for (auto w : gates[g].inputs) in.push_back(w == NO_INDEX ? AIG::LIT_FALSE : wire_lit[w]);
+                unsigned int l = aig.build(gates[g].function, in);
+                for (auto w : gates[g].outputs) {
+                    if (w != NO_INDEX) wire_lit[w] = l;
+                }
+            }
+            report.and_nodes = aig.andCount();
+
+            // observables are fixed before anything is rewired
+            vector<unsigned int> observed;
+            for (unsigned int w = 0; w < nw; w++) {
+                bool obs = probed[w] || netlist.getFanout(w).empty();
+                for (auto r : netlist.getFanout(w)) {
+                    if (!hashable(r)) obs = true;
+                }
+                if (obs) observed.push_back(w);
+            }
+
+            auto& wires = netlist.getWires();
+            vector<Wire*> target(nw, nullptr);
+            for (auto g : topo) {
+                for (auto w : gates[g].outputs) {
+                    if (w == NO_INDEX || target[w] != nullptr) continue;
+                    unsigned int l = wire_lit[w];
+                    if (l == AIG::LIT_FALSE || l == AIG::LIT_TRUE) {
+                        target[w] = constantWire(l == AIG::LIT_TRUE);
+                        report.constant_wires++;
+                        continue;
+                    }
+                    auto it = lit_wire.find(l);
+                    if (it == lit_wire.end()) {
+                        lit_wire[l] = w;
+                        target[w] = wires[w];
+                    } else {
+                        target[w] = wires[it->second];
+                        report.merged_wires++;
+                    }
+                }
+            }
+            for (unsigned int w = 0; w < nw; w++) {
+                if (target[w] != nullptr && target[w] != wires[w]) moveReaders(w, target[w]);
+            }
+            mapping.clear();
+            for (unsigned int w = 0; w < nw; w++) {
+                mapping[wires[w]] = target[w] != nullptr ? target[w] : wires[w];
+            }
+
+            // mark everything feeding an observable, then drop the rest of the logic
+            vector<bool> live(gates.size(), false);
+            vector<unsigned int> work;
+            for (auto w : observed) {
+                unsigned int id = netlist.wireIndex(mapping[wires[w]]);
+                if (id == NO_INDEX) continue;
+                for (auto d : netlist.getDrivers(id)) work.push_back(d);
+            }
+            for (unsigned int g = 0; g < gates.size(); g++) {
+                if (gates[g].gate != nullptr && !hashable(g)) work.push_back(g);
+            }
+            while (!work.empty()) {
+                unsigned int g = work.back();
+                work.pop_back();
+                if (live[g]) continue;
+                live[g] = true;
+                for (auto w : gates[g].inputs) {
+                    if (w == NO_INDEX) continue;
+                    for (auto d : netlist.getDrivers(w)) {
+                        if (!live[d]) work.push_back(d);
+                    }
+                }
+            }
+            vector<BasicGate*> dead;
+            for (unsigned int g = 0; g < gates.size(); g++) {
+                if (gates[g].gate != nullptr && !live[g]) dead.push_back(gates[g].gate);
+            }
+            for (auto g : dead) netlist.removeGate(g);
+            report.removed_gates = dead.size();
+            for (auto& ng : gates) {
+                if (ng.gate != nullptr) report.gates_after++;
+            }
+            return report;
+        }
+        // where to read an original wire's value after optimize()
+        Wire* observe(Wire* w) {
+            auto it = mapping.find(w);
+            return it == mapping.end() ? w : it->second;
+        }
+        unsigned int literalOf(Wire* w) {
+            unsigned int id = netlist.wireIndex(w);
+            return id == NO_INDEX || id >= wire_lit.size() ? NO_INDEX : wire_lit[id];
+        }
+        AIG& getAIG() {
+            return aig;
+        }
+    };
+};
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "main_init.hpp"
+
+namespace DigitalLogic {
+    using LogicSim::ConfigurableBasicGate;
+    using LogicSim::WireStateValue;
+    using LogicSim::LogicSimException;
+
+    typedef unsigned long long SimTime;
+    const SimTime NEVER = ~0ULL;
+
+    // Config: "Period" (ulonglong), optional "Phase" (ulonglong) and
+    // "DutyCycle" (float, 0..1, default 0.5). Times are simulator ticks.
+    class ClockGate : public ConfigurableBasicGate {
+        SimTime period = 0;
+        SimTime phase = 0;
+        SimTime high_time = 0;
+        bool level = false;
+    protected:
+        virtual void init() override {
+            auto a = config_table.find(LogicSim::ConfigKeys::Period);
+            if (a == config_table.end())
+                throw LogicSimException("Missing 'Period' in config table", this);
+            period = a->second.get()->get_t<unsigned long long>();
+            if (period == 0)
+                throw LogicSimException("'Period' must be non-zero", this);
+            a = config_table.find(LogicSim::ConfigKeys::Phase);
+            phase = a == config_table.end() ? 0 : a->second.get()->get_t<unsigned long long>();
+            long double duty = 0.5;
+            a = config_table.find(LogicSim::ConfigKeys::DutyCycle);
+            if (a != config_table.end()) duty = a->second.get()->get_t<long double>();
+            if (duty < 0 || duty > 1)
+                throw LogicSimException("'DutyCycle' must be between 0 and 1", this);
+            high_time = (SimTime)(duty * (long double)period + 0.5);
+            level = false;
+        }
+        virtual void update() override {
+            write_pin(0, WireStateValue(level));
+        }
+    public:
+        ClockGate() : ConfigurableBasicGate(0, 1) {};
+        virtual const char* getObjectType() override {
+            return "ClockGate";
+        }
+        bool levelAt(SimTime t) {
+            if (t < phase || high_time == 0) return false;
+            if (high_time >= period) return true;
+            return (t - phase) % period < high_time;
+        }
+        // first edge strictly after t
+        SimTime nextEdge(SimTime t) {
+            if (high_time == 0) return NEVER;
+            if (t < phase) return phase;
+            if (high_time >= period) return NEVER;
+            SimTime r = (t - phase) % period;
+            SimTime base = t - r;
+            return r < high_time ? base + high_time : base + period;
+        }
+        SimTime getPeriod() {
+            return period;
+        }
+        bool getLevel() {
+            return level;
+        }
+        void setLevel(bool l) {
+            if (l == level) return;
+            level = l;
+            update();
+        }
+    };
+};
@@ -0,0 +1,366 @@
+#pragma once
+
+#include <atomic>
+#include <vector>
+#include <string>
+#include <thread>
+#include <algorithm>
+#include <deque>
+#include <cstring>
+#include <cerrno>
+
+#ifndef WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include "main_init.hpp"
+#include "mainsim.hpp"
+#include "netlist.hpp"
+
+namespace LogicSim {
+    namespace Exceptions {
+        class CosimError : public LogicSimException {
+        public:
+            CosimError(const string& what, LogicSimObject* obj) : LogicSimException("Co-simulation: " + what, obj) {};
+        };
+    };
+
+    struct CosimMessage {
+        static constexpr unsigned int NULL_MESSAGE = 1;
+        SimTime time;
+        unsigned int wire;
+        unsigned int flags;
+        unsigned long long value;
+    };
+
+    // Layout of the shared segment: header, then partitions*partitions
+    // channels (from-major), each a cache-line aligned head/tail pair followed
+    // by its ring. Only address-free lock-free atomics live in the segment.
+    struct CosimHeader {
+        static constexpr unsigned long long MAGIC = 0x4C53494D434F5349ULL;
+        unsigned long long magic;
+        unsigned int partitions;
+        unsigned int capacity;
+    };
+    struct alignas(64) CosimChannelHeader {
+        alignas(64) std::atomic<unsigned long long> head;
+        alignas(64) std::atomic<unsigned long long> tail;
+    };
+
+    class CosimChannel final {
+        CosimChannelHeader* hdr = nullptr;
+        CosimMessage* ring = nullptr;
+        unsigned long long mask = 0;
+    public:
+        CosimChannel() = default;
+        CosimChannel(CosimChannelHeader* hdr, unsigned int capacity) : hdr(hdr), ring((CosimMessage*)(hdr + 1)), mask(capacity - 1) {};
+        bool tryPush(const CosimMessage& m) {
+            unsigned long long t = hdr->tail.load(std::memory_order_relaxed);
+            if (t - hdr->head.load(std::memory_order_acquire) > mask) return false;
+            ring[t & mask] = m;
+            hdr->tail.store(t + 1, std::memory_order_release);
+            return true;
+        }
+        void push(const CosimMessage& m) {
+            while (!tryPush(m)) std::this_thread::yield();
+        }
+        bool pop(CosimMessage& m) {
+            unsigned long long h = hdr->head.load(std::memory_order_relaxed);
+            if (h == hdr->tail.load(std::memory_order_acquire)) return false;
+            m = ring[h & mask];
+            hdr->head.store(h + 1, std::memory_order_release);
+            return true;
+        }
+    };
+
+    class CosimRegion final : public LogicSimObject {
+        string name;
+        void* base = nullptr;
+        size_t length = 0;
+        bool owner = false;
+        CosimHeader* header = nullptr;
+
+        static size_t channelBytes(unsigned int capacity) {
+            return sizeof(CosimChannelHeader) + ((sizeof(CosimMessage) * capacity + 63) / 64) * 64;
+        }
+        static size_t regionBytes(unsigned int partitions, unsigned int capacity) {
+            return 64 + channelBytes(capacity) * partitions * partitions;
+        }
+        void map(int fd, size_t n) {
+#ifndef WIN32
+            base = mmap(nullptr, n, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            close(fd);
+            if (base == MAP_FAILED) {
+                base = nullptr;
+                throw Exceptions::CosimError("mmap of '" + name + "' failed", this);
+            }
+            length = n;
+            header = (CosimHeader*)base;
+#endif
+        }
+    public:
+        virtual const char* getObjectType() {
+            return "CosimRegion";
+        }
+        // creates (and owns) the segment; workers attach with the one-argument
+        // constructor. Fails if the name exists, e.g. left over from a crashed
+        // run, rather than unlinking a segment another run may be using.
+        CosimRegion(const string& name, unsigned int partitions, unsigned int capacity = 4096) : name(name) {
+#ifdef WIN32
+            throw Exceptions::CosimError("shared memory co-simulation is not supported on this platform", this);
+#else
+            unsigned int c = 1;
+            while (c < capacity) c <<= 1;
+            size_t n = regionBytes(partitions, c);
+            int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+            if (fd < 0 && errno == EEXIST) throw Exceptions::CosimError("'" + name + "' already exists", this);
+            if (fd < 0) throw Exceptions::CosimError("shm_open of '" + name + "' failed", this);
+            // the destructor does not run if construction fails, so a
+            // segment created here is removed here until it is mapped
+            if (ftruncate(fd, (off_t)n) != 0) {
+                close(fd);
+                shm_unlink(name.c_str());
+                throw Exceptions::CosimError("ftruncate of '" + name + "' failed", this);
+            }
+            try {
+                map(fd, n);
+            } catch (...) {
+                shm_unlink(name.c_str());
+                throw;
+            }
+            owner = true;
+            std::memset(base, 0, n);
+            header->partitions = partitions;
+            header->capacity = c;
+            std::atomic_thread_fence(std::memory_order_release);
+            header->magic = CosimHeader::MAGIC;
+#endif
+        }
+        CosimRegion(const string& name) : name(name) {
+#ifdef WIN32
+            throw Exceptions::CosimError("shared memory co-simulation is not supported on this platform", this);
+#else
+            int fd = shm_open(name.c_str(), O_RDWR, 0600);
+            if (fd < 0) throw Exceptions::CosimError("shm_open of '" + name + "' failed", this);
+            struct stat st;
+            if (fstat(fd, &st) != 0) {
+                close(fd);
+                throw Exceptions::CosimError("fstat of '" + name + "' failed", this);
+            }
+            map(fd, (size_t)st.st_size);
+            // the destructor does not run if construction fails
+            if (length < sizeof(CosimHeader) || header->magic != CosimHeader::MAGIC ||
+                header->capacity == 0 || (header->capacity & (header->capacity - 1)) != 0 ||
+                length < regionBytes(header->partitions, header->capacity)) {
+                munmap(base, length);
+                base = nullptr;
+                header = nullptr;
+                throw Exceptions::CosimError("'" + name + "' is not a co-simulation region", this);
+            }
+#endif
+        }
+        CosimRegion(const CosimRegion&) = delete;
+        CosimRegion& operator=(const CosimRegion&) = delete;
+        ~CosimRegion() {
+#ifndef WIN32
+            if (base != nullptr) munmap(base, length);
+            if (owner) shm_unlink(name.c_str());
+#endif
+        }
+        unsigned int getPartitions() {
+            return header->partitions;
+        }
+        CosimChannel channel(unsigned int from, unsigned int to) {
+            size_t off = 64 + channelBytes(header->capacity) * (from * header->partitions + to);
+            return CosimChannel((CosimChannelHeader*)((char*)base + off), header->capacity);
+        }
+        CosimHeader* getHeader() {
+            return header;
+        }
+    };
+
+    // drives an imported boundary wire inside this process
+    class BoundaryGate final : public BasicGate {
+    protected:
+        virtual void update() override {};
+    public:
+        BoundaryGate() : BasicGate(0, 1) {};
+        virtual const char* getObjectType() override {
+            return "BoundaryGate";
+        }
+        void drive(WireStateValue value) {
+            write_pin(0, value);
+        }
+    };
+
+    // One process's view: conservative (Chandy-Misra-Bryant) synchronization.
+    // Local time only advances up to the minimum channel clock of all
+    // inputs. Every boundary wire has a delay of lookahead: a value seen at
+    // local time now is sent stamped now + lookahead, and after every
+    // advance a null message with the same stamp follows the data. Local
+    // time only grows between publishes, so a null message stamped t means
+    // every message up to and including t has been sent; only null
+    // messages move a channel clock, and time may advance up to it.
+    class CosimPartition final : public LogicSimObject {
+        struct Export {
+            Wire* wire;
+            unsigned int id;
+            vector<unsigned int> to;
+            unsigned long long last;
+            bool sent;
+        };
+        struct Import {
+            unsigned int id;
+            unique_ptr<BoundaryGate> gate;
+        };
+        CosimRegion& region;
+        MainSim& sim;
+        unsigned int rank;
+        SimTime lookahead;
+        vector<Export> exports;
+        vector<Import> imports;
+        vector<unsigned int> inputs;
+        vector<SimTime> channel_clock;
+        vector<std::deque<CosimMessage>> pending;
+        unsigned long long sent = 0;
+        unsigned long long received = 0;
+
+        BoundaryGate* importGate(unsigned int id) {
+            for (auto& i : imports) {
+                if (i.id == id) return i.gate.get();
+            }
+            return nullptr;
+        }
+        void receive() {
+            for (auto from : inputs) {
+                CosimChannel ch = region.channel(from, rank);
+                CosimMessage m;
+                while (ch.pop(m)) {
+                    received++;
+                    // more data with the same stamp may still be on its way
+                    if (m.flags & CosimMessage::NULL_MESSAGE) channel_clock[from] = std::max(channel_clock[from], m.time);
+                    else pending[from].push_back(m);
+                }
+            }
+        }
+        SimTime safeTime() {
+            SimTime t = NEVER;
+            for (auto from : inputs) t = std::min(t, channel_clock[from]);
+            return t;
+        }
+        void applyUpTo(SimTime limit) {
+            while (true) {
+                unsigned int best = NO_INDEX;
+                for (auto from : inputs) {
+                    if (pending[from].empty() || pending[from].front().time > limit) continue;
+                    if (best == NO_INDEX || pending[from].front().time < pending[best].front().time) best = from;
+                }
+                if (best == NO_INDEX) break;
+                CosimMessage m = pending[best].front();
+                pending[best].pop_front();
+                sim.runUntil(m.time);
+                BoundaryGate* g = importGate(m.wire);
+                if (g != nullptr) g->drive(WireStateValue(m.value));
+            }
+            sim.runUntil(limit);
+        }
+        void publish() {
+            SimTime stamp = sim.getTime() + lookahead;
+            for (auto& e : exports) {
+                unsigned long long v = wire_value_bits(e.wire->getState(0));
+                if (e.sent && v == e.last) continue;
+                e.last = v;
+                e.sent = true;
+                for (auto to : e.to) {
+                    region.channel(rank, to).push({stamp, e.id, 0, v});
+                    sent++;
+                }
+            }
+            for (unsigned int to = 0; to < region.getPartitions(); to++) {
+                if (to == rank) continue;
+                region.channel(rank, to).push({stamp, 0, CosimMessage::NULL_MESSAGE, 0});
+            }
+        }
+    public:
+        virtual const char* getObjectType() {
+            return "CosimPartition";
+        }
+        CosimPartition(CosimRegion& region, MainSim& sim, unsigned int rank, SimTime lookahead) :
+            region(region), sim(sim), rank(rank), lookahead(lookahead) {
+            if (lookahead == 0)
+                throw Exceptions::CosimError("lookahead must be non-zero to avoid deadlock", this);
+            unsigned int n = region.getPartitions();
+            channel_clock.assign(n, 0);
+            pending.resize(n);
+            for (unsigned int i = 0; i < n; i++) {
+                if (i != rank) inputs.push_back(i);
+            }
+        }
+        void exportWire(Wire* wire, unsigned int id, const vector<unsigned int>& to) {
+            exports.push_back({wire, id, to, 0, false});
+        }
+        void importWire(Wire* wire, unsigned int id) {
+            Import i;
+            i.id = id;
+            i.gate.reset(new BoundaryGate());
+            connect(i.gate->getPin(0), wire);
+            imports.push_back(std::move(i));
+        }
+        // earliest stamp among received but unapplied data
+        SimTime nextPending() {
+            SimTime t = NEVER;
+            for (auto from : inputs) {
+                if (!pending[from].empty()) t = std::min(t, pending[from].front().time);
+            }
+            return t;
+        }
+        void run(SimTime end) {
+            publish();
+            while (sim.getTime() < end) {
+                receive();
+                // stop at every local event and applied input, so a change is
+                // published stamped with its own time plus the lookahead
+                SimTime target = std::min(std::min(safeTime(), end), std::min(sim.nextEventTime(), nextPending()));
+                if (target <= sim.getTime()) {
+                    std::this_thread::yield();
+                    continue;
+                }
+                applyUpTo(target);
+                publish();
+            }
+        }
+        unsigned long long getSent() {
+            return sent;
+        }
+        unsigned long long getReceived() {
+            return received;
+        }
+    };
+
+#ifndef WIN32
+    // Forks one child process per partition (rank 1..n-1), runs rank 0 in
+    // the caller and returns how many children exited unsuccessfully.
+    inline unsigned int run_partitions(unsigned int n, void (*f)(unsigned int, void*), void* instance) {
+        vector<pid_t> children;
+        for (unsigned int r = 1; r < n; r++) {
+            pid_t pid = fork();
+            if (pid == 0) {
+                f(r, instance);
+                _exit(0);
+            }
+            if (pid > 0) children.push_back(pid);
+        }
+        f(0, instance);
+        unsigned int failed = 0;
+        for (auto pid : children) {
+            int status = 0;
+            if (waitpid(pid, &status, 0) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) failed++;
+        }
+        return failed;
+    }
+#endif
+};
@@ -1,11 +1,15 @@
 #pragma once
-#include <stdlib.h>
-#include <time.h> 
+#include <time.h>
 
-#define BOOL_RAND (rand() % 2)
-#define BYTE_RAND (rand() % 256)
-#define SHORT_RAND ((BYTE_RAND << 8) | BYTE_RAND)
-#define LONG_RAND ((SHORT_RAND << 16) | SHORT_RAND)
-#define LONGLONG_RAND ((LONG_RAND << 32) | LONG_RAND)
+#include "random.hpp"
 
-#define INIT_RAND() srand(time(NULL))
\ No newline at end of file
+// Compatibility macros over the calling thread's RandomStream (random.hpp).
+// INIT_RAND() keeps the old time-based seeding; call
+// LogicSim::Random::setSeed() instead for reproducible runs.
+#define BOOL_RAND (LogicSim::Random::local().bit())
+#define BYTE_RAND ((unsigned char)LogicSim::Random::local().bits(8))
+#define SHORT_RAND ((unsigned short)LogicSim::Random::local().bits(16))
+#define LONG_RAND ((unsigned int)LogicSim::Random::local().bits(32))
+#define LONGLONG_RAND (LogicSim::Random::local().next())
+
+#define INIT_RAND() LogicSim::Random::setSeed((unsigned long long)time(NULL))
@@ -0,0 +1,249 @@
+#pragma once
+
+#include <vector>
+
+#include "main_init.hpp"
+#include "netlist.hpp"
+
+namespace LogicSim {
+    // Cycle-based evaluation for fully synchronous designs. The combinational
+    // logic between registers is compiled into a flat tape in topological
+    // order and evaluated exactly once per cycle; there is no event queue,
+    // no delta cycles and no driver resolution. All sequential gates are
+    // treated as sharing one clock and latch at the start of each cycle.
+    class CycleSimulator final : public LogicSimObject {
+        struct Op {
+            LogicFunction function;
+            unsigned int first;
+            unsigned int count;
+            unsigned int output_first;
+            unsigned int output_count;
+            unsigned long long mask;
+        };
+        struct Register {
+            unsigned int d;
+            unsigned int q;
+            unsigned long long mask;
+        };
+        Netlist& netlist;
+        vector<Op> tape;
+        vector<unsigned int> operands;
+        vector<unsigned int> results;
+        vector<Register> registers;
+        vector<unsigned long long> values;
+        vector<unsigned long long> latched;
+        // by Netlist gate index: its op on the tape, or its register
+        vector<unsigned int> op_of;
+        vector<unsigned int> register_of;
+        unsigned int zero_slot = 0;
+        unsigned int scratch_slot = 0;
+        unsigned long long cycles = 0;
+        bool dirty = true;
+        // inputs were set after the last evaluate(), so register inputs are stale
+        bool unsettled = true;
+        // installed by a NativeCompiler; dropped whenever the tape is rebuilt
+        void (*native)(unsigned long long*) = nullptr;
+        friend class NativeCompiler;
+
+        // A change that only touched a gate's function or width (what
+        // Netlist::gateChanged reports) is patched into its op in place. An
+        // added, removed or rewired gate can move anything in the topological
+        // order, so those rebuild the tape on the next evaluation.
+        static void onNetlistChange(void* instance, const vector<unsigned int>& affected) {
+            auto sim = (CycleSimulator*)instance;
+            if (sim->dirty) return;
+            for (auto g : affected) {
+                if (!sim->patch(g)) {
+                    sim->dirty = true;
+                    return;
+                }
+            }
+            // native code has the old functions baked in
+            sim->native = nullptr;
+        }
+        unsigned int slot(unsigned int wire, bool output) {
+            if (wire != NO_INDEX) return wire;
+            return output ? scratch_slot : zero_slot;
+        }
+        // false unless the gate still sits on the tape with the same wiring
+        bool patch(unsigned int g) {
+            auto& gates = netlist.getGates();
+            if (g >= gates.size() || g >= op_of.size() || gates[g].gate == nullptr) return false;
+            NetlistGate& ng = gates[g];
+            if (register_of[g] != NO_INDEX) {
+                Register& r = registers[register_of[g]];
+                if (!ng.gate->isSequential() || ng.inputs.empty() || ng.outputs.empty()) return false;
+                if (r.d != slot(ng.inputs[0], false) || r.q != slot(ng.outputs[0], true)) return false;
+                r.mask = gateMask(ng.gate);
+                return true;
+            }
+            if (op_of[g] == NO_INDEX || ng.gate->isSequential() || ng.function == LogicFunction::NONE) return false;
+            Op& op = tape[op_of[g]];
+            if (op.count != ng.inputs.size() || op.output_count != ng.outputs.size()) return false;
+            for (unsigned int k = 0; k < op.count; k++) {
+                if (operands[op.first + k] != slot(ng.inputs[k], false)) return false;
+            }
+            for (unsigned int k = 0; k < op.output_count; k++) {
+                if (results[op.output_first + k] != slot(ng.outputs[k], true)) return false;
+            }
+            op.function = ng.function;
+            op.mask = gateMask(ng.gate);
+            return true;
+        }
+    public:
+        virtual const char* getObjectType() {
+            return "CycleSimulator";
+        }
+        // value bits a gate produces, from its "Bits"; without one a logic
+        // gate produces 1 bit and a register holds all 64, as in event mode
+        static unsigned long long gateMask(BasicGate* g) {
+            unsigned long long all = g->isSequential() ? ~0ULL : 1;
+            if (!g->isConfigurable()) return all;
+            auto cg = (ConfigurableBasicGate*)g;
+            auto a = cg->config_table.find(ConfigKeys::Bits);
+            if (a == cg->config_table.end()) return all;
+            unsigned short bits = a->second.get()->get_t<unsigned short>();
+            return bits >= 64 ? ~0ULL : ((1ULL << bits) - 1);
+        }
+        CycleSimulator(Netlist& netlist) : netlist(netlist) {
+            netlist.onChange(&CycleSimulator::onNetlistChange, this);
+            compile();
+        }
+        ~CycleSimulator() {
+            netlist.removeListener(this);
+        }
+        CycleSimulator(const CycleSimulator&) = delete;
+        CycleSimulator& operator=(const CycleSimulator&) = delete;
+
+        void compile() {
+            auto& gates = netlist.getGates();
+            unsigned int nw = (unsigned int)netlist.getWires().size();
+            // wires added since the last compile take over the old zero and scratch slots
+            unsigned int old_nw = values.empty() ? 0 : zero_slot;
+            zero_slot = nw;
+            scratch_slot = nw + 1;
+            values.resize(nw + 2, 0);
+            for (unsigned int w = old_nw; w < nw; w++) values[w] = 0;
+            values[zero_slot] = 0;
+            values[scratch_slot] = 0;
+            tape.clear();
+            operands.clear();
+            results.clear();
+            registers.clear();
+            op_of.assign(gates.size(), NO_INDEX);
+            register_of.assign(gates.size(), NO_INDEX);
+
+            vector<unsigned int> pending(gates.size(), 0);
+            vector<unsigned int> ready;
+            unsigned int combinational = 0;
+            for (unsigned int g = 0; g < gates.size(); g++) {
+                NetlistGate& ng = gates[g];
+                if (ng.gate == nullptr) continue;
+                if (ng.gate->isSequential()) {
+                    if (ng.inputs.empty() || ng.outputs.empty())
+                        throw LogicSimException("Register needs a data input and an output", ng.gate);
+                    register_of[g] = (unsigned int)registers.size();
+                    registers.push_back({slot(ng.inputs[0], false), slot(ng.outputs[0], true), gateMask(ng.gate)});
+                    continue;
+                }
+                if (ng.function == LogicFunction::NONE)
+                    throw LogicSimException("Gate has no logic function for cycle-based simulation", ng.gate);
+                if (ng.inputs.size() > LOGIC_MAX_INPUTS)
+                    throw LogicSimException("Gate has more than " + to_string(LOGIC_MAX_INPUTS) + " inputs", ng.gate);
+                combinational++;
+                for (auto w : ng.inputs) {
+                    if (w == NO_INDEX) continue;
+                    for (auto d : netlist.getDrivers(w)) {
+                        if (d != g && !gates[d].gate->isSequential()) pending[g]++;
+                    }
+                }
+                if (pending[g] == 0) ready.push_back(g);
+            }
+            for (size_t i = 0; i < ready.size(); i++) {
+                NetlistGate& ng = gates[ready[i]];
+                Op op;
+                op.function = ng.function;
+                op.first = (unsigned int)operands.size();
+                op.count = (unsigned int)ng.inputs.size();
+                op.output_first = (unsigned int)results.size();
+                op.output_count = (unsigned int)ng.outputs.size();
+                op.mask = gateMask(ng.gate);
+                for (auto w : ng.inputs) operands.push_back(slot(w, false));
+                for (auto w : ng.outputs) {
+                    results.push_back(slot(w, true));
+                    if (w == NO_INDEX) continue;
+                    for (auto r : netlist.getFanout(w)) {
+                        if (r != ready[i] && !gates[r].gate->isSequential() && --pending[r] == 0) ready.push_back(r);
+                    }
+                }
+                op_of[ready[i]] = (unsigned int)tape.size();
+                tape.push_back(op);
+            }
+            if (tape.size() != combinational)
+                throw LogicSimException("Combinational loop prevents cycle-based simulation", this);
+            latched.assign(registers.size(), 0);
+            native = nullptr;
+            dirty = false;
+            unsettled = true;
+        }
+        void setInput(Wire* w, unsigned long long value) {
+            // a wire added since the last compile has no slot yet
+            if (dirty) compile();
+            unsigned int id = netlist.wireIndex(w);
+            if (id == NO_INDEX) return;
+            values[id] = value;
+            unsettled = true;
+        }
+        unsigned long long getValue(Wire* w) {
+            unsigned int id = netlist.wireIndex(w);
+            // wires from zero_slot on arrived after the last compile
+            return id == NO_INDEX || id >= zero_slot ? 0 : values[id];
+        }
+        void evaluate() {
+            if (dirty) compile();
+            unsettled = false;
+            if (native != nullptr) {
+                native(values.data());
+                return;
+            }
+            unsigned long long in[LOGIC_MAX_INPUTS];
+            unsigned long long* v = values.data();
+            const unsigned int* ops = operands.data();
+            const unsigned int* res = results.data();
+            for (auto& op : tape) {
+                for (unsigned int k = 0; k < op.count; k++) in[k] = v[ops[op.first + k]];
+                unsigned long long r = eval_logic(op.function, in, op.count) & op.mask;
+                for (unsigned int k = 0; k < op.output_count; k++) v[res[op.output_first + k]] = r;
+            }
+            v[zero_slot] = 0;
+        }
+        // one clock edge: every register samples D, then the logic settles once.
+        // Inputs set since the last evaluation are settled first, so D sees them.
+        void cycle() {
+            if (dirty) compile();
+            if (unsettled) evaluate();
+            for (size_t i = 0; i < registers.size(); i++) latched[i] = values[registers[i].d] & registers[i].mask;
+            for (size_t i = 0; i < registers.size(); i++) values[registers[i].q] = latched[i];
+            evaluate();
+            cycles++;
+        }
+        void run(unsigned long long n) {
+            for (unsigned long long i = 0; i < n; i++) cycle();
+        }
+        void reset() {
+            std::fill(values.begin(), values.end(), 0);
+            cycles = 0;
+            evaluate();
+        }
+        // indexed by Netlist wire index
+        const vector<unsigned long long>& getValues() {
+            return values;
+        }
+        unsigned long long getCycles() {
+            return cycles;
+        }
+        bool isNative() {
+            return native != nullptr;
+        }
+    };
+};
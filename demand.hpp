@@ -0,0 +1,210 @@
+#pragma once
+
+#include <vector>
+
+#include "main_init.hpp"
+#include "netlist.hpp"
+#include "cyclesim.hpp"
+
+namespace LogicSim {
+    // Demand-driven evaluation over a Netlist for designs that are probed at
+    // only a few wires. Nothing is evaluated when an input changes: the
+    // combinational fanout is marked dirty, stopping at wires that already
+    // are, since a dirty wire's whole fanout is dirty too. Reading a wire
+    // evaluates only the dirty part of its fanin cone and caches the result.
+    //
+    // Sources are wires without a combinational driver: primary inputs set
+    // with setInput() and register outputs. As in CycleSimulator, gates need
+    // a logic function, a multi-driver wire uses its first driver, and all
+    // registers share one clock; cycle() pulls the register inputs.
+    //
+    // Only combinational reads are lazy. Every clock edge pulls the D cone
+    // of every register, so a design with many registers is evaluated
+    // nearly in full once per cycle however few wires are probed; use
+    // CycleSimulator for register-heavy designs.
+    class DemandEvaluator final : public LogicSimObject {
+        struct Register {
+            unsigned int d;
+            unsigned int q;
+            unsigned long long mask;
+        };
+        Netlist& netlist;
+        vector<unsigned int> driver;
+        vector<unsigned long long> values;
+        vector<unsigned char> dirty;
+        vector<unsigned char> expanded;
+        vector<unsigned long long> masks;
+        vector<Register> registers;
+        vector<unsigned long long> latched;
+        vector<unsigned int> stack;
+        vector<unsigned long long> in;
+        unsigned long long evaluations = 0;
+        unsigned long long invalidations = 0;
+        unsigned long long cycles = 0;
+        bool stale = true;
+
+        static void onNetlistChange(void* instance, const vector<unsigned int>&) {
+            ((DemandEvaluator*)instance)->stale = true;
+        }
+        void invalidate(unsigned int w) {
+            auto& gates = netlist.getGates();
+            stack.clear();
+            stack.push_back(w);
+            while (!stack.empty()) {
+                unsigned int x = stack.back();
+                stack.pop_back();
+                for (auto r : netlist.getFanout(x)) {
+                    if (gates[r].gate == nullptr || gates[r].gate->isSequential()) continue;
+                    for (auto o : gates[r].outputs) {
+                        if (o == NO_INDEX || dirty[o] || driver[o] != r) continue;
+                        dirty[o] = 1;
+                        invalidations++;
+                        stack.push_back(o);
+                    }
+                }
+            }
+        }
+        void evaluateGate(unsigned int g) {
+            NetlistGate& ng = netlist.getGates()[g];
+            in.resize(ng.inputs.size());
+            for (size_t k = 0; k < ng.inputs.size(); k++) in[k] = ng.inputs[k] == NO_INDEX ? 0 : values[ng.inputs[k]];
+            unsigned long long r = eval_logic(ng.function, in.data(), in.size()) & masks[g];
+            for (auto o : ng.outputs) {
+                if (o == NO_INDEX || driver[o] != g) continue;
+                values[o] = r;
+                dirty[o] = 0;
+                expanded[o] = 0;
+            }
+            evaluations++;
+        }
+        // depth-first over the dirty fanin; a wire is expanded once its
+        // inputs are queued, and finding an expanded wire again is a loop
+        unsigned long long pull(unsigned int w) {
+            if (!dirty[w]) return values[w];
+            auto& gates = netlist.getGates();
+            stack.clear();
+            stack.push_back(w);
+            while (!stack.empty()) {
+                unsigned int x = stack.back();
+                if (!dirty[x]) {
+                    stack.pop_back();
+                    continue;
+                }
+                unsigned int g = driver[x];
+                bool ready = true;
+                for (auto i : gates[g].inputs) {
+                    if (i == NO_INDEX || !dirty[i]) continue;
+                    if (expanded[i]) {
+                        for (auto s : stack) expanded[s] = 0;
+                        throw LogicSimException("Combinational loop prevents demand-driven evaluation", gates[g].gate);
+                    }
+                    stack.push_back(i);
+                    ready = false;
+                }
+                if (!ready) {
+                    expanded[x] = 1;
+                    continue;
+                }
+                evaluateGate(g);
+                stack.pop_back();
+            }
+            return values[w];
+        }
+    public:
+        virtual const char* getObjectType() {
+            return "DemandEvaluator";
+        }
+        DemandEvaluator(Netlist& netlist) : netlist(netlist) {
+            netlist.onChange(&DemandEvaluator::onNetlistChange, this);
+            compile();
+        }
+        ~DemandEvaluator() {
+            netlist.removeListener(this);
+        }
+        DemandEvaluator(const DemandEvaluator&) = delete;
+        DemandEvaluator& operator=(const DemandEvaluator&) = delete;
+
+        // source values are kept by wire index; everything driven starts dirty
+        void compile() {
+            auto& gates = netlist.getGates();
+            size_t nw = netlist.getWires().size();
+            values.resize(nw, 0);
+            driver.assign(nw, NO_INDEX);
+            dirty.assign(nw, 0);
+            expanded.assign(nw, 0);
+            masks.assign(gates.size(), 0);
+            registers.clear();
+            for (unsigned int g = 0; g < gates.size(); g++) {
+                NetlistGate& ng = gates[g];
+                if (ng.gate == nullptr) continue;
+                masks[g] = CycleSimulator::gateMask(ng.gate);
+                if (ng.gate->isSequential()) {
+                    if (ng.inputs.empty() || ng.outputs.empty() || ng.inputs[0] == NO_INDEX || ng.outputs[0] == NO_INDEX)
+                        throw LogicSimException("Register needs a data input and an output", ng.gate);
+                    registers.push_back({ng.inputs[0], ng.outputs[0], masks[g]});
+                    continue;
+                }
+                if (ng.function == LogicFunction::NONE)
+                    throw LogicSimException("Gate has no logic function for demand-driven evaluation", ng.gate);
+                for (auto o : ng.outputs) {
+                    if (o == NO_INDEX || driver[o] != NO_INDEX) continue;
+                    driver[o] = g;
+                    dirty[o] = 1;
+                }
+            }
+            latched.assign(registers.size(), 0);
+            stale = false;
+        }
+        void setInput(Wire* w, unsigned long long value) {
+            if (stale) compile();
+            unsigned int id = netlist.wireIndex(w);
+            if (id == NO_INDEX || driver[id] != NO_INDEX || values[id] == value) return;
+            values[id] = value;
+            invalidate(id);
+        }
+        unsigned long long getValue(Wire* w) {
+            if (stale) compile();
+            unsigned int id = netlist.wireIndex(w);
+            return id == NO_INDEX ? 0 : pull(id);
+        }
+        bool isDirty(Wire* w) {
+            if (stale) compile();
+            unsigned int id = netlist.wireIndex(w);
+            return id != NO_INDEX && id < dirty.size() && dirty[id];
+        }
+        // one clock edge: every register samples D, then Q changes invalidate
+        void cycle() {
+            if (stale) compile();
+            for (size_t i = 0; i < registers.size(); i++) latched[i] = pull(registers[i].d) & registers[i].mask;
+            for (size_t i = 0; i < registers.size(); i++) {
+                unsigned int q = registers[i].q;
+                if (values[q] == latched[i]) continue;
+                values[q] = latched[i];
+                invalidate(q);
+            }
+            cycles++;
+        }
+        void run(unsigned long long n) {
+            for (unsigned long long i = 0; i < n; i++) cycle();
+        }
+        void reset() {
+            if (stale) compile();
+            std::fill(values.begin(), values.end(), 0);
+            for (size_t w = 0; w < driver.size(); w++) dirty[w] = driver[w] != NO_INDEX;
+            cycles = 0;
+        }
+        // gate evaluations and dirty markings so far
+        unsigned long long getEvaluations() {
+            return evaluations;
+        }
+        unsigned long long getInvalidations() {
+            return invalidations;
+        }
+        unsigned long long getCycles() {
+            return cycles;
+        }
+        void resetStatistics() {
+            evaluations = invalidations = 0;
+        }
+    };
+};
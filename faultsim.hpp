@@ -0,0 +1,178 @@
+#pragma once
+
+#include <vector>
+#include <thread>
+#include <atomic>
+
+#include "main_init.hpp"
+#include "netlist.hpp"
+
+namespace LogicSim {
+    struct Fault {
+        unsigned int gate = 0;
+        unsigned short slot = 0;
+        bool output = false;
+        bool stuck_at = false;
+        Pin* pin = nullptr;
+    };
+
+    struct FaultCoverageReport {
+        size_t total = 0;
+        size_t detected = 0;
+        vector<size_t> detected_after_pattern;
+        vector<long long> detected_by;
+        double coverage() {
+            return total == 0 ? 1.0 : (double)detected / (double)total;
+        }
+    };
+
+    // Parallel-fault simulation: lane 0 of every word is the good machine,
+    // lanes 1..63 each carry one faulty machine. A batch stops as soon as all
+    // of its faults have been detected at an observed wire.
+    class FaultSimulator final : public LogicSimObject {
+        static constexpr unsigned int lanes = 63;
+        struct Injection {
+            unsigned short slot;
+            bool output;
+            unsigned long long and_mask;
+            unsigned long long or_mask;
+        };
+        Netlist& netlist;
+        vector<Fault> faults;
+        vector<unsigned int> inputs;
+        vector<unsigned int> observed;
+        unsigned int threads = 0;
+
+        void runBatch(size_t first, const vector<unsigned int>& order, const vector<vector<bool>>& patterns, vector<long long>& detected_by,
+                      vector<unsigned long long>& values, vector<unsigned long long>& in,
+                      vector<vector<Injection>>& injections, vector<unsigned int>& touched) {
+            auto& gates = netlist.getGates();
+            size_t count = std::min<size_t>(lanes, faults.size() - first);
+            unsigned long long remaining = 0;
+            for (size_t i = 0; i < count; i++) {
+                const Fault& f = faults[first + i];
+                unsigned long long bit = 1ULL << (i + 1);
+                if (injections[f.gate].empty()) touched.push_back(f.gate);
+                injections[f.gate].push_back({f.slot, f.output, ~bit, f.stuck_at ? bit : 0});
+                remaining |= bit;
+            }
+            for (size_t p = 0; p < patterns.size() && remaining != 0; p++) {
+                const vector<bool>& pattern = patterns[p];
+                for (size_t i = 0; i < inputs.size(); i++) {
+                    values[inputs[i]] = (i < pattern.size() && pattern[i]) ? ~0ULL : 0;
+                }
+                for (auto g : order) {
+                    NetlistGate& ng = gates[g];
+                    auto& inj = injections[g];
+                    size_t n = ng.inputs.size();
+                    for (size_t k = 0; k < n; k++) {
+                        in[k] = ng.inputs[k] == NO_INDEX ? 0 : values[ng.inputs[k]];
+                    }
+                    for (auto& j : inj) {
+                        if (!j.output) in[j.slot] = (in[j.slot] & j.and_mask) | j.or_mask;
+                    }
+                    unsigned long long v = eval_logic(ng.function, in.data(), n);
+                    for (size_t k = 0; k < ng.outputs.size(); k++) {
+                        if (ng.outputs[k] == NO_INDEX) continue;
+                        unsigned long long o = v;
+                        for (auto& j : inj) {
+                            if (j.output && j.slot == k) o = (o & j.and_mask) | j.or_mask;
+                        }
+                        values[ng.outputs[k]] = o;
+                    }
+                }
+                unsigned long long diff = 0;
+                for (auto w : observed) {
+                    unsigned long long v = values[w];
+                    diff |= v ^ ((v & 1) ? ~0ULL : 0);
+                }
+                diff &= remaining;
+                remaining &= ~diff;
+                while (diff != 0) {
+                    unsigned int lane = count_trailing_zeros(diff);
+                    detected_by[first + lane - 1] = (long long)p;
+                    diff &= diff - 1;
+                }
+            }
+            for (auto g : touched) injections[g].clear();
+            touched.clear();
+        }
+    public:
+        virtual const char* getObjectType() {
+            return "FaultSimulator";
+        }
+        FaultSimulator(Netlist& netlist) : netlist(netlist) {
+            if (!netlist.getCyclic().empty())
+                throw LogicSimException("Fault simulation requires an acyclic netlist", this);
+            auto& gates = netlist.getGates();
+            for (unsigned int g = 0; g < gates.size(); g++) {
+                if (gates[g].gate == nullptr) continue;
+                if (gates[g].function == LogicFunction::NONE)
+                    throw LogicSimException("Gate has no logic function for fault simulation", gates[g].gate);
+                for (unsigned short k = 0; k < gates[g].inputs.size(); k++) {
+                    faults.push_back({g, k, false, false, gates[g].input_pins[k]});
+                    faults.push_back({g, k, false, true, gates[g].input_pins[k]});
+                }
+                for (unsigned short k = 0; k < gates[g].outputs.size(); k++) {
+                    faults.push_back({g, k, true, false, gates[g].output_pins[k]});
+                    faults.push_back({g, k, true, true, gates[g].output_pins[k]});
+                }
+            }
+            inputs = netlist.primaryInputs();
+            observed = netlist.primaryOutputs();
+        }
+        const vector<Fault>& getFaults() {
+            return faults;
+        }
+        // pattern bits are given in the order of Netlist::primaryInputs()
+        const vector<unsigned int>& getInputs() {
+            return inputs;
+        }
+        void setObserved(const vector<Wire*>& wires) {
+            observed.clear();
+            for (auto w : wires) {
+                unsigned int id = netlist.wireIndex(w);
+                if (id != NO_INDEX) observed.push_back(id);
+            }
+        }
+        void setThreads(unsigned int n) {
+            threads = n;
+        }
+        FaultCoverageReport run(const vector<vector<bool>>& patterns) {
+            FaultCoverageReport report;
+            report.total = faults.size();
+            report.detected_by.assign(faults.size(), -1);
+            size_t batches = (faults.size() + lanes - 1) / lanes;
+            unsigned int n = threads != 0 ? threads : std::max(1u, std::thread::hardware_concurrency());
+            if (n > batches) n = (unsigned int)std::max<size_t>(1, batches);
+            std::atomic<size_t> next{0};
+            const vector<unsigned int>& order = netlist.getOrder();
+            auto worker = [&]() {
+                size_t max_inputs = 1;
+                for (auto& g : netlist.getGates()) max_inputs = std::max(max_inputs, g.inputs.size());
+                vector<unsigned long long> values(netlist.getWires().size(), 0);
+                vector<unsigned long long> in(max_inputs, 0);
+                vector<vector<Injection>> injections(netlist.getGates().size());
+                vector<unsigned int> touched;
+                for (size_t b = next++; b < batches; b = next++) {
+                    runBatch(b * lanes, order, patterns, report.detected_by, values, in, injections, touched);
+                }
+            };
+            vector<std::thread> pool;
+            for (unsigned int i = 1; i < n; i++) pool.emplace_back(worker);
+            worker();
+            for (auto& t : pool) t.join();
+
+            report.detected_after_pattern.assign(patterns.size(), 0);
+            for (auto d : report.detected_by) {
+                if (d < 0) continue;
+                report.detected++;
+                report.detected_after_pattern[(size_t)d]++;
+            }
+            for (size_t p = 1; p < patterns.size(); p++) {
+                report.detected_after_pattern[p] += report.detected_after_pattern[p - 1];
+            }
+            return report;
+        }
+    };
+};
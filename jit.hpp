@@ -0,0 +1,312 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cctype>
+#include <cstdlib>
+#include <unordered_map>
+
+#ifndef WIN32
+#include <cerrno>
+#include <dlfcn.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#include "main_init.hpp"
+#include "netlist.hpp"
+#include "cyclesim.hpp"
+
+namespace LogicSim {
+    namespace Exceptions {
+        class JitError : public LogicSimException {
+        public:
+            JitError(const string& what, LogicSimObject* obj) : LogicSimException("Native compilation: " + what, obj) {};
+        };
+    };
+
+    // Turns the levelized tape of a CycleSimulator into straight-line C++
+    // over its flat value array, builds it into a shared object with the
+    // system compiler and installs the result as the simulator's evaluate().
+    // Objects are cached in cache_dir under a hash of the generated source,
+    // the compiler command, its flags and its --version output. The source
+    // is kept next to each object, prefixed with those settings, and an
+    // object is reused only if that file matches byte for byte, so a hash
+    // collision or a replaced compiler means a rebuild, never wrong code.
+    //
+    // The loaded code belongs to the compiler object, which must outlive
+    // the simulator's use of it. Any change to the netlist makes the
+    // simulator recompile its tape and fall back to interpretation until
+    // attach() is called again.
+    //
+    // The compiler is run without a shell: the compiler setting is one
+    // program name or path, and the flags are split at whitespace.
+    class NativeCompiler final : public LogicSimObject {
+        static constexpr size_t OPS_PER_FUNCTION = 4096;
+        string cache_dir;
+        string compiler;
+        string flags = "-O2";
+        // the object each simulator runs; replaced ones are closed
+        unordered_map<CycleSimulator*, void*> handles;
+        string version;
+        string version_of;
+        unsigned long long hash = 0;
+        bool cached = false;
+
+        static unsigned long long hashOf(const string& s) {
+            unsigned long long h = 0xCBF29CE484222325ULL;
+            for (unsigned char c : s) {
+                h ^= c;
+                h *= 0x100000001B3ULL;
+            }
+            return h;
+        }
+        static void putSlot(string& out, unsigned int slot) {
+            char buf[24];
+            std::snprintf(buf, sizeof(buf), "v[%u]", slot);
+            out += buf;
+        }
+        static void putMask(string& out, unsigned long long mask) {
+            char buf[32];
+            std::snprintf(buf, sizeof(buf), "0x%llxULL", mask);
+            out += buf;
+        }
+        static const char* joinOf(LogicFunction f) {
+            switch (f) {
+            case LogicFunction::AND:
+            case LogicFunction::NAND:
+                return " & ";
+            case LogicFunction::OR:
+            case LogicFunction::NOR:
+                return " | ";
+            case LogicFunction::XOR:
+            case LogicFunction::XNOR:
+                return " ^ ";
+            default:
+                return nullptr;
+            }
+        }
+        static bool inverted(LogicFunction f) {
+            return f == LogicFunction::NOT || f == LogicFunction::NAND || f == LogicFunction::NOR || f == LogicFunction::XNOR;
+        }
+        static void putOp(string& out, CycleSimulator& sim, const CycleSimulator::Op& op) {
+            unsigned int n = op.count;
+            const char* join = joinOf(op.function);
+            out += "    t = ";
+            if (inverted(op.function)) out += "~";
+            out += "(";
+            if (n == 0) out += "0ULL";
+            for (unsigned int k = 0; k < n; k++) {
+                if (k > 0 && join == nullptr) break;
+                if (k > 0) out += join;
+                putSlot(out, sim.operands[op.first + k]);
+            }
+            out += ") & ";
+            putMask(out, op.mask);
+            out += ";\n";
+            for (unsigned int k = 0; k < op.output_count; k++) {
+                out += "    ";
+                putSlot(out, sim.results[op.output_first + k]);
+                out += " = t;\n";
+            }
+        }
+#ifndef WIN32
+        // runs args[0] from PATH with args as its argv; output collects its
+        // stdout and stderr when given. The exit status, 127 when it could
+        // not be started, -1 when it did not exit normally.
+        static int run(const vector<string>& args, string* output) {
+            vector<char*> argv;
+            for (auto& a : args) argv.push_back(const_cast<char*>(a.c_str()));
+            argv.push_back(nullptr);
+            int fds[2] = {-1, -1};
+            if (output != nullptr && pipe(fds) != 0) return -1;
+            pid_t pid = fork();
+            if (pid == 0) {
+                if (output != nullptr) {
+                    dup2(fds[1], 1);
+                    dup2(fds[1], 2);
+                    close(fds[0]);
+                    close(fds[1]);
+                }
+                execvp(argv[0], argv.data());
+                _exit(127);
+            }
+            if (output != nullptr) {
+                close(fds[1]);
+                if (pid > 0) {
+                    char buf[256];
+                    ssize_t n;
+                    while ((n = read(fds[0], buf, sizeof(buf))) > 0 || (n < 0 && errno == EINTR)) {
+                        if (n > 0) output->append(buf, (size_t)n);
+                    }
+                }
+                close(fds[0]);
+            }
+            if (pid < 0) return -1;
+            int status;
+            while (waitpid(pid, &status, 0) < 0) {
+                if (errno != EINTR) return -1;
+            }
+            return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+        }
+#endif
+        static vector<string> words(const string& s) {
+            vector<string> out;
+            size_t i = 0;
+            while (i < s.size()) {
+                while (i < s.size() && std::isspace((unsigned char)s[i])) i++;
+                size_t j = i;
+                while (j < s.size() && !std::isspace((unsigned char)s[j])) j++;
+                if (j > i) out.push_back(s.substr(i, j - i));
+                i = j;
+            }
+            return out;
+        }
+        // each line of the compiler's --version output, as comments
+        const string& compilerVersion() {
+#ifndef WIN32
+            if (version_of == compiler) return version;
+            version.clear();
+            version_of = compiler;
+            string out;
+            if (run({compiler, "--version"}, &out) < 0) return version;
+            for (size_t i = 0; i < out.size();) {
+                size_t end = out.find('\n', i);
+                if (end == string::npos) end = out.size();
+                version += "// " + out.substr(i, end - i) + "\n";
+                i = end + 1;
+            }
+#endif
+            return version;
+        }
+        static bool sameFile(const string& path, const string& content) {
+            FILE* f = std::fopen(path.c_str(), "rb");
+            if (f == nullptr) return false;
+            string data;
+            char buf[4096];
+            size_t n;
+            while ((n = std::fread(buf, 1, sizeof(buf), f)) > 0) data.append(buf, n);
+            std::fclose(f);
+            return data == content;
+        }
+        string cachePath(const char* ext) {
+            char buf[40];
+            std::snprintf(buf, sizeof(buf), "/lsjit_%016llx.%s", hash, ext);
+            return cache_dir + buf;
+        }
+    public:
+        virtual const char* getObjectType() {
+            return "NativeCompiler";
+        }
+        NativeCompiler(const string& cache_dir = "lsjit_cache") : cache_dir(cache_dir) {
+            const char* cxx = std::getenv("CXX");
+            compiler = cxx != nullptr && *cxx != 0 ? cxx : "c++";
+        }
+        NativeCompiler(const NativeCompiler&) = delete;
+        NativeCompiler& operator=(const NativeCompiler&) = delete;
+        ~NativeCompiler() {
+#ifndef WIN32
+            for (auto& h : handles) dlclose(h.second);
+#endif
+        }
+        void setCompiler(const string& c) {
+            compiler = c;
+        }
+        void setFlags(const string& f) {
+            flags = f;
+        }
+        // the translation unit attach() would build for sim's current tape
+        string generate(CycleSimulator& sim) {
+            if (sim.dirty) sim.compile();
+            string out;
+            out.reserve(sim.tape.size() * 48 + 256);
+            out += "// generated by LogicSim::NativeCompiler\n";
+            out += "extern \"C\" {\n";
+            char buf[96];
+            std::snprintf(buf, sizeof(buf), "extern const unsigned long long lsjit_slots = %zuULL;\n", sim.values.size());
+            out += buf;
+            size_t parts = (sim.tape.size() + OPS_PER_FUNCTION - 1) / OPS_PER_FUNCTION;
+            for (size_t p = 0; p < parts; p++) {
+                std::snprintf(buf, sizeof(buf), "static void lsjit_part%zu(unsigned long long* __restrict v) {\n", p);
+                out += buf;
+                out += "    unsigned long long t;\n";
+                size_t end = (p + 1) * OPS_PER_FUNCTION;
+                if (end > sim.tape.size()) end = sim.tape.size();
+                for (size_t i = p * OPS_PER_FUNCTION; i < end; i++) putOp(out, sim, sim.tape[i]);
+                out += "}\n";
+            }
+            out += "void lsjit_evaluate(unsigned long long* __restrict v) {\n";
+            for (size_t p = 0; p < parts; p++) {
+                std::snprintf(buf, sizeof(buf), "    lsjit_part%zu(v);\n", p);
+                out += buf;
+            }
+            out += "    ";
+            putSlot(out, sim.zero_slot);
+            out += " = 0;\n}\n}\n";
+            return out;
+        }
+        // compiles or loads the code for sim and switches sim over to it
+        void attach(CycleSimulator& sim) {
+#ifdef WIN32
+            throw Exceptions::JitError("not supported on this platform", this);
+#else
+            string source = "// " + compiler + " " + flags + "\n" + compilerVersion() + generate(sim);
+            hash = hashOf(source);
+            mkdir(cache_dir.c_str(), 0755);
+            string so = cachePath("so");
+            string cpp = cachePath("cpp");
+            cached = access(so.c_str(), R_OK) == 0 && sameFile(cpp, source);
+            if (!cached) {
+                FILE* f = std::fopen(cpp.c_str(), "wb");
+                if (f == nullptr) throw Exceptions::JitError("cannot write '" + cpp + "'", this);
+                bool ok = std::fwrite(source.data(), 1, source.size(), f) == source.size();
+                ok = std::fclose(f) == 0 && ok;
+                if (!ok) throw Exceptions::JitError("cannot write '" + cpp + "'", this);
+                // built under a private name so concurrent runs never load a partial object
+                string tmp = so + "." + std::to_string((long long)getpid());
+                vector<string> args = words(flags);
+                args.insert(args.begin(), compiler);
+                for (const char* a : {"-shared", "-fPIC", "-o"}) args.push_back(a);
+                args.push_back(tmp);
+                args.push_back(cpp);
+                int status = run(args, nullptr);
+                if (status != 0) {
+                    std::remove(tmp.c_str());
+                    if (status == 127) throw Exceptions::JitError("cannot run '" + compiler + "'", this);
+                    throw Exceptions::JitError("'" + compiler + "' failed on '" + cpp + "'", this);
+                }
+                if (std::rename(tmp.c_str(), so.c_str()) != 0) {
+                    std::remove(tmp.c_str());
+                    throw Exceptions::JitError("cannot install '" + so + "'", this);
+                }
+            }
+            void* h = dlopen(so.c_str(), RTLD_NOW | RTLD_LOCAL);
+            if (h == nullptr) throw Exceptions::JitError(string("dlopen failed: ") + dlerror(), this);
+            auto slots = (const unsigned long long*)dlsym(h, "lsjit_slots");
+            auto fn = (void (*)(unsigned long long*))dlsym(h, "lsjit_evaluate");
+            if (slots == nullptr || fn == nullptr || *slots != sim.values.size()) {
+                dlclose(h);
+                throw Exceptions::JitError("'" + so + "' does not match the design", this);
+            }
+            sim.native = fn;
+            auto old = handles.find(&sim);
+            if (old != handles.end()) {
+                dlclose(old->second);
+                old->second = h;
+            } else {
+                handles[&sim] = h;
+            }
+#endif
+        }
+        // hash of the last attached design; names its files in the cache
+        unsigned long long getHash() {
+            return hash;
+        }
+        // whether the last attach() found its object already built
+        bool wasCached() {
+            return cached;
+        }
+    };
+};
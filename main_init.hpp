@@ -5,6 +5,13 @@
 #include <string>
 #include <unordered_map>
 #include <exception>
+#include <atomic>
+#include <array>
+#include <algorithm>
+#include <iterator>
+#include <type_traits>
+#include <new>
+#include <mutex>
 
 #include "Awaitable.hpp"
 #include "to_string.hpp"
@@ -20,20 +27,70 @@ namespace LogicSim {
     using std::make_shared;
     using std::exception;
     using std::runtime_error;
+    class LogicSimObject;
+    // every live object; objects may be built and destroyed on several
+    // threads, so walkers take a snapshot through live_objects()
     vector<LogicSimObject*> objects;
+    std::mutex objects_mtx;
     bool optimizedmode = false;
+    unsigned int settle_limit = 1000;
+
+    // bit scans without compiler builtins where they are missing; x != 0
+    inline unsigned int count_trailing_zeros(unsigned long long x) {
+#if defined(__GNUC__) || defined(__clang__)
+        return (unsigned int)__builtin_ctzll(x);
+#else
+        unsigned int n = 0;
+        while ((x & 1) == 0) {
+            x >>= 1;
+            n++;
+        }
+        return n;
+#endif
+    }
+    inline unsigned int count_leading_zeros(unsigned long long x) {
+#if defined(__GNUC__) || defined(__clang__)
+        return (unsigned int)__builtin_clzll(x);
+#else
+        unsigned int n = 0;
+        while ((x & (1ULL << 63)) == 0) {
+            x <<= 1;
+            n++;
+        }
+        return n;
+#endif
+    }
+    inline unsigned int count_ones(unsigned long long x) {
+#if defined(__GNUC__) || defined(__clang__)
+        return (unsigned int)__builtin_popcountll(x);
+#else
+        x = x - ((x >> 1) & 0x5555555555555555ULL);
+        x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+        x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+        return (unsigned int)((x * 0x0101010101010101ULL) >> 56);
+#endif
+    }
     class LogicSimObject {
     public:
         virtual const char* getObjectType() {
             return "LogicSimObject";
         }
         LogicSimObject() {
+            std::lock_guard<std::mutex> lck(objects_mtx);
             objects.push_back(this);
         }
-        ~LogicSimObject() {
-            objects.erase(std::remove(objects.begin(), objects.end(), this), objects.end());
+        // searched from the back: objects mostly die in reverse creation order;
+        // virtual, since gates are owned and deleted through base pointers
+        virtual ~LogicSimObject() {
+            std::lock_guard<std::mutex> lck(objects_mtx);
+            auto it = std::find(objects.rbegin(), objects.rend(), this);
+            if (it != objects.rend()) objects.erase(std::next(it).base());
         }
     };
+    inline vector<LogicSimObject*> live_objects() {
+        std::lock_guard<std::mutex> lck(objects_mtx);
+        return objects;
+    }
 
     class LogicSimException : public runtime_error {
     public:
@@ -51,7 +108,7 @@ namespace LogicSim {
         FLOAT,
         OBJ
     };
-    string wirestatetype_to_str(WireStateValueType t) {
+    inline const char* wirestatetype_name(WireStateValueType t) {
         switch (t) {
         case WireStateValueType::NONE:
             return "NONE";
@@ -70,29 +127,94 @@ namespace LogicSim {
         case WireStateValueType::OBJ:
             return "OBJECT";
         }
+        return "UNKNOWN";
+    }
+    string wirestatetype_to_str(WireStateValueType t) {
+        return wirestatetype_name(t);
     };
     namespace Exceptions {
         class ShortCircuitError;
-        class InvalidKeyError : public LogicSimException {
+        // Keeps only plain operands when thrown; the message is built on the
+        // first what(), so errors that are caught and dropped cost no strings.
+        class DeferredException : public LogicSimException {
+            mutable string message;
+            mutable bool formatted = false;
+        protected:
+            virtual string format() const = 0;
+        public:
+            DeferredException() : LogicSimException(string()) {};
+            const char* what() const noexcept override {
+                if (!formatted) {
+                    try {
+                        message = format();
+                    } catch (...) {
+                        return LogicSimException::what();
+                    }
+                    formatted = true;
+                }
+                return message.c_str();
+            }
+        };
+        class InvalidKeyError : public DeferredException {
+            // small trivially copyable keys are kept by value, others as text
+            alignas(8) unsigned char key[16];
+            string (*key_format)(const void*) = nullptr;
+            string key_text;
+            const char* type;
+            const void* obj;
+            const char* root_type = nullptr;
+            const void* root = nullptr;
+
+            template <typename K>
+            static string formatKey(const void* p) {
+                return to_string(*(const K*)p);
+            }
+            template <typename K>
+            void keep(const K& k) {
+                if constexpr (std::is_trivially_copyable<K>::value && sizeof(K) <= sizeof(key) && alignof(K) <= 8) {
+                    new (key) K(k);
+                    key_format = &formatKey<K>;
+                } else {
+                    key_text = to_string(k);
+                }
+            }
+        protected:
+            virtual string format() const override {
+                string s = "No value found for key: " + (key_format != nullptr ? key_format(key) : key_text)
+                    + " for TableType " + type + ":" + to_string((void*)obj);
+                if (root != nullptr) s += string(" in ") + root_type + ":" + to_string((void*)root);
+                return s;
+            }
         public:
             template <typename K>
-            InvalidKeyError(LogicSimObject* obj, K key) : 
-                LogicSimException("No value found for key: " + to_string(key)
-                + " for TableType "
-                + obj->getObjectType() + ":" + to_string(obj)) {};
+            InvalidKeyError(LogicSimObject* obj, const K& key) : type(obj->getObjectType()), obj(obj) {
+                keep(key);
+            };
             template <typename K>
-            InvalidKeyError(LogicSimObject* obj, K key, LogicSimObject* root) :
-                LogicSimException("No value found for key: " + to_string(key)
-                + " for TableType "
-                + obj->getObjectType() + ":" + to_string(obj)
-                + " in " + root->getObjectType() + ":" + to_string(root)) {};
+            InvalidKeyError(LogicSimObject* obj, const K& key, LogicSimObject* root) :
+                type(obj->getObjectType()), obj(obj), root_type(root->getObjectType()), root(root) {
+                keep(key);
+            };
+            // key formatted by format(&key) when the message is read
+            InvalidKeyError(LogicSimObject* obj, unsigned int key, string (*format)(const void*)) :
+                key_format(format), type(obj->getObjectType()), obj(obj) {
+                new (this->key) unsigned int(key);
+            };
         };
-        class UnexpectedWireValueTypeError : public LogicSimException {
+        class UnexpectedWireValueTypeError : public DeferredException {
+            WireStateValueType expected;
+            WireStateValueType actual;
+            const char* type;
+            const void* obj;
+        protected:
+            virtual string format() const override {
+                return "Invalid WireValueType: " + wirestatetype_to_str(expected)
+                    + " expected, but got " + wirestatetype_to_str(actual) + " at "
+                    + type + ":" + to_string((void*)obj);
+            }
         public:
             UnexpectedWireValueTypeError(LogicSimObject* obj, WireStateValueType expected, WireStateValueType actual) :
-                LogicSimException("Invalid WireValueType: " + wirestatetype_to_str(expected)
-                + " expected, but got " + wirestatetype_to_str(actual) + " at "
-                + obj->getObjectType() + ":" + to_string(obj)) {};    
+                expected(expected), actual(actual), type(obj->getObjectType()), obj(obj) {};
         };
         
     };
@@ -106,34 +228,30 @@ namespace LogicSim {
     }
 
     class ConfigEntry : public LogicSimObject {
-        unique_ptr<void> ptr;
+        template<typename T>
+        static void destroy(void* p) {
+            delete (T*)p;
+        }
+        unique_ptr<void, void (*)(void*)> ptr{nullptr, &destroy<char>};
         const char* type = "<null>";
     public:
         virtual string toString() {
             return "<unknown>";
         }
         template<typename T>
-        ConfigEntry(T obj, string type) {
-            T* new_obj = malloc(sizeof(T));
-            memcpy(&obj,new_obj,sizeof(T));
-            ptr.reset(new_obj);
-        }
+        ConfigEntry(T obj, string type) : ptr(new T(obj), &destroy<T>) {};
         template<typename T>
         T& get_t() {
-            return *(T*)ptr.get_t();
+            return *(T*)ptr.get();
         }
         template<typename T>
         void set_t(T obj) {
-            T* new_obj = malloc(sizeof(T));
-            memcpy(new_obj,&obj,sizeof(T));
-            ptr.reset(new_obj);
+            ptr = unique_ptr<void, void (*)(void*)>(new T(obj), &destroy<T>);
         }
-        void set_t<nullptr_t>(nullptr_t) {
-            ptr.reset(nullptr);
-        }
-        ConfigEntry(nullptr_t) {
+        void set_t(nullptr_t) {
             ptr.reset(nullptr);
         }
+        ConfigEntry(nullptr_t) {};
         string getType() { return type; }
         void* getPtr() {
             return ptr.get();
@@ -149,6 +267,10 @@ namespace LogicSim {
         }
     };
 
+    // records a failed lookup in diagnostics (defined after them); a lookup
+    // has nothing to return, so it throws under every policy
+    inline void report_invalid_key(LogicSimObject* obj);
+
     template<typename K, typename V>
     class Table : public LogicSimObject {
     private:
@@ -161,9 +283,10 @@ namespace LogicSim {
         unique_ptr<V>& operator[](const K& key) {
             auto v = entries.find(key);
             if (v == entries.end()) {
+                report_invalid_key(this);
                 throw Exceptions::InvalidKeyError(this, key);
             }
-            return v;
+            return v->second;
         }
         auto begin() {
             return entries.begin();
@@ -192,29 +315,163 @@ namespace LogicSim {
         string toString() {
             string ret = "{";
             for (auto& v : entries) {
-                ret += to_string(v.first) + ":" + to_string(v.second) + ",";
+                ret += to_string(v.first);
+                ret += ':';
+                ret += to_string(v.second);
+                ret += ',';
             }
-            ret += "}";
+            ret += '}';
             return ret;
         }
     };
-    class ConfigTable final : public Table<string, ConfigEntry> {
+    constexpr unsigned int config_key_hash(const char* s) {
+        unsigned int h = 2166136261u;
+        while (*s != 0) {
+            h ^= (unsigned char)*s++;
+            h *= 16777619u;
+        }
+        return h;
+    }
+    inline unordered_map<unsigned int, string>& config_key_names() {
+        static unordered_map<unsigned int, string> names;
+        return names;
+    }
+    inline std::mutex& config_key_names_mtx() {
+        static std::mutex mtx;
+        return mtx;
+    }
+    inline unsigned int intern_config_key(const string& name) {
+        unsigned int id = config_key_hash(name.c_str());
+        std::lock_guard<std::mutex> lck(config_key_names_mtx());
+        auto& names = config_key_names();
+        auto it = names.find(id);
+        if (it == names.end()) names[id] = name;
+        else if (it->second != name)
+            throw LogicSimException("Config key '" + name + "' collides with '" + it->second + "'");
+        return id;
+    }
+    // unknown ids get a placeholder, which is not remembered
+    inline string config_key_name(unsigned int id) {
+        std::lock_guard<std::mutex> lck(config_key_names_mtx());
+        auto& names = config_key_names();
+        auto it = names.find(id);
+        if (it != names.end()) return it->second;
+        return "#" + to_hex_string(id);
+    }
+    // 32-bit key; literals hash at compile time and keep their text so a
+    // ConfigTable can intern them when first stored, runtime strings are
+    // interned right away
+    struct ConfigKey {
+        unsigned int id;
+        const char* literal = nullptr;
+        constexpr ConfigKey(const char* name) : id(config_key_hash(name)), literal(name) {};
+        ConfigKey(const string& name) : id(intern_config_key(name)) {};
+        constexpr bool operator==(const ConfigKey& other) const {
+            return id == other.id;
+        }
+        constexpr bool operator!=(const ConfigKey& other) const {
+            return id != other.id;
+        }
+    };
+    namespace ConfigKeys {
+        constexpr ConfigKey Bits = "Bits";
+        constexpr ConfigKey Size = "Size";
+        constexpr ConfigKey Image = "Image";
+        constexpr ConfigKey Period = "Period";
+        constexpr ConfigKey Phase = "Phase";
+        constexpr ConfigKey DutyCycle = "DutyCycle";
+        constexpr ConfigKey Delay = "Delay";
+    };
+    inline bool config_keys_registered = [] {
+        for (auto name : {"Bits", "Size", "Image", "Period", "Phase", "DutyCycle", "Delay"}) intern_config_key(name);
+        return true;
+    }();
+
+    // sorted flat array keyed by ConfigKey id; gates usually carry a handful of entries
+    class ConfigTable final : public LogicSimObject {
+        typedef std::pair<unsigned int, unique_ptr<ConfigEntry>> Entry;
+        vector<Entry> entries;
+        vector<Entry>::iterator lower(unsigned int id) {
+            return std::lower_bound(entries.begin(), entries.end(), id,
+                [](const Entry& e, unsigned int k) { return e.first < k; });
+        }
+        static string keyText(const void* id) {
+            return config_key_name(*(const unsigned int*)id);
+        }
     public:
         virtual const char* getObjectType() {
             return "ConfigTable";
         }
+        ConfigTable() = default;
+        unique_ptr<ConfigEntry>& operator[](ConfigKey key) {
+            auto v = find(key);
+            if (v == entries.end()) {
+                report_invalid_key(this);
+                throw Exceptions::InvalidKeyError(this, key.id, &keyText);
+            }
+            return v->second;
+        }
+        auto begin() {
+            return entries.begin();
+        }
+        auto end() {
+            return entries.end();
+        }
+        bool exists(ConfigKey key) {
+            return find(key) != entries.end();
+        }
+        vector<Entry>::iterator find(ConfigKey key) {
+            auto it = lower(key.id);
+            if (it == entries.end() || it->first != key.id) return entries.end();
+            return it;
+        }
+        void insert(ConfigKey key, unique_ptr<ConfigEntry> value) {
+            auto it = lower(key.id);
+            if (it != entries.end() && it->first == key.id) {
+                it->second = std::move(value);
+                return;
+            }
+            if (key.literal != nullptr) intern_config_key(key.literal);
+            entries.emplace(it, key.id, std::move(value));
+        }
+        void insert(const char* name, unique_ptr<ConfigEntry> value) {
+            insert(ConfigKey(string(name)), std::move(value));
+        }
+        void erase(ConfigKey key) {
+            auto it = find(key);
+            if (it != entries.end()) entries.erase(it);
+        }
+        void clear() {
+            entries.clear();
+        }
+        size_t size() {
+            return entries.size();
+        }
+        string toString() {
+            string ret = "{";
+            for (auto& v : entries) {
+                ret += config_key_name(v.first);
+                ret += ':';
+                ret += v.second == nullptr ? string("null") : v.second->toString();
+                ret += ',';
+            }
+            ret += '}';
+            return ret;
+        }
     };
 
     class BasicGate;
     class Wire;
     class WireState;
-    class SubCircuit;   // to define
+    class SubCircuit;
     class Pin;        
-    class MainSim;     // to define
+    class MainSim;
     
-    class WireStateValue final : public LogicSimObject {
+    // a plain value: gates build one per write, so it stays out of the
+    // object registry and carries no vtable
+    class WireStateValue final {
     public:
-        virtual const char* getObjectType() {
+        const char* getObjectType() {
             return "WireStateValue";
         }
         unsigned short resistance = 0;
@@ -239,7 +496,18 @@ namespace LogicSim {
         WireStateValue(long double v) : fp(v), type(WireStateValueType::FLOAT) {};
         WireStateValue(const WireStateValue& other) {
             type = other.type;
-            ll = other.ll; //capture all bytes
+            resistance = other.resistance;
+            // a long double is wider than ll
+            if (type == WireStateValueType::FLOAT) fp = other.fp;
+            else ll = other.ll;
+        }
+        // the same shallow copy; an OBJ pointer is shared, not duplicated
+        WireStateValue& operator=(const WireStateValue& other) {
+            type = other.type;
+            resistance = other.resistance;
+            if (type == WireStateValueType::FLOAT) fp = other.fp;
+            else ll = other.ll;
+            return *this;
         }
         ~WireStateValue() {
             if (type == WireStateValueType::OBJ) {
@@ -247,7 +515,7 @@ namespace LogicSim {
             }
         }
         bool isNone() {
-            return resistance == -1;
+            return resistance == (unsigned short)-1;
         }
         bool is(const WireStateValue& other) {
             if (type != other.type) {
@@ -293,14 +561,203 @@ namespace LogicSim {
         s += ")";
         return s;
     }
+    inline unsigned long long wire_value_bits(const WireStateValue& v) {
+        switch (v.type) {
+            case WireStateValueType::BIT:
+                return v.b ? 1 : 0;
+            case WireStateValueType::BYTE:
+                return v.byte;
+            case WireStateValueType::WORD:
+                return v.s;
+            case WireStateValueType::DWORD:
+                return v.l;
+            case WireStateValueType::QWORD:
+                return v.ll;
+            default:
+                return 0;
+        }
+    }
+    // plain copy of a WireStateValue; never owns an OBJ pointer
+    struct DiagnosticValue {
+        WireStateValueType type = WireStateValueType::NONE;
+        unsigned short resistance = 0;
+        union {
+            unsigned long long bits = 0;
+            long double fp;
+        };
+        static DiagnosticValue of(const WireStateValue* v) {
+            DiagnosticValue ret;
+            if (v == nullptr) return ret;
+            ret.type = v->type;
+            ret.resistance = v->resistance;
+            if (v->type == WireStateValueType::FLOAT) ret.fp = v->fp;
+            else if (v->type == WireStateValueType::OBJ) ret.bits = (uintptr_t)v->ptr;
+            else ret.bits = wire_value_bits(*v);
+            return ret;
+        }
+        // whether v reads the same as this snapshot: type, strength and value
+        bool same(const WireStateValue& v) const {
+            if (v.type != type || v.resistance != resistance) return false;
+            if (type == WireStateValueType::FLOAT) return v.fp == fp;
+            if (type == WireStateValueType::OBJ) return (uintptr_t)v.ptr == bits;
+            return wire_value_bits(v) == bits;
+        }
+        string toString() const {
+            if (resistance == (unsigned short)-1) return "None";
+            string s = "WireStateValue(" + wirestatetype_to_str(type) + ":";
+            switch (type) {
+            case WireStateValueType::FLOAT:
+                s += to_string(fp);
+                break;
+            case WireStateValueType::OBJ:
+                s += to_hex_string((uintptr_t)bits);
+                break;
+            case WireStateValueType::BIT:
+                s += to_string((int)(bits & 1));
+                break;
+            default:
+                s += to_string(bits);
+                break;
+            }
+            s += ")";
+            return s;
+        }
+    };
     namespace Exceptions {
-        class ShortCircuitError : public LogicSimException {
+        class ShortCircuitError : public DeferredException {
+            DiagnosticValue a;
+            DiagnosticValue b;
+            const char* type;
+            const void* obj;
+        protected:
+            virtual string format() const override {
+                return "short circuit conflict between two wire state values " + a.toString()
+                    + "," + b.toString() + " at object " + type + ":" + to_string((void*)obj);
+            }
         public:
-            ShortCircuitError(WireStateValue* a,WireStateValue* b, LogicSimObject* obj) : LogicSimException(
-                "short circuit conflict between two wire state values " + to_string_v(a) 
-                + "," + to_string_v(b) + " at object " + obj->getObjectType() + ":" + to_string(obj)
-                ) {};
+            ShortCircuitError(const WireStateValue* a, const WireStateValue* b, LogicSimObject* obj) :
+                a(DiagnosticValue::of(a)), b(DiagnosticValue::of(b)), type(obj->getObjectType()), obj(obj) {};
         };
+        class OscillationError : public LogicSimException {
+        public:
+            OscillationError(LogicSimObject* obj, unsigned int repeats) : LogicSimException(
+                "net did not settle: gate evaluated more than " + to_string(repeats) + " times", obj) {};
+        };
+    }
+
+    enum class DiagnosticCode {
+        SHORT_CIRCUIT,
+        INVALID_KEY,
+        OSCILLATION,
+        COMBINATIONAL_LOOP,
+        STIMULUS_MISMATCH,
+        USER,
+        COUNT
+    };
+    enum class DiagnosticPolicy {
+        THROW,
+        LOG,
+        COUNT
+    };
+    string diagnosticcode_to_str(DiagnosticCode c) {
+        switch (c) {
+        case DiagnosticCode::SHORT_CIRCUIT:
+            return "SHORT_CIRCUIT";
+        case DiagnosticCode::INVALID_KEY:
+            return "INVALID_KEY";
+        case DiagnosticCode::OSCILLATION:
+            return "OSCILLATION";
+        case DiagnosticCode::COMBINATIONAL_LOOP:
+            return "COMBINATIONAL_LOOP";
+        case DiagnosticCode::STIMULUS_MISMATCH:
+            return "STIMULUS_MISMATCH";
+        case DiagnosticCode::USER:
+            return "USER";
+        default:
+            return "UNKNOWN";
+        }
+    }
+    struct DiagnosticRecord {
+        unsigned long long sequence = 0;
+        DiagnosticCode code = DiagnosticCode::USER;
+        LogicSimObject* obj = nullptr;
+        DiagnosticValue values[2];
+    };
+    // records are plain data; nothing is formatted until format() is called
+    class Diagnostics final {
+    public:
+        static constexpr size_t capacity = 1024;
+    private:
+        std::array<DiagnosticRecord, capacity> records;
+        std::array<DiagnosticPolicy, (size_t)DiagnosticCode::COUNT> policies;
+        std::array<std::atomic<unsigned long long>, (size_t)DiagnosticCode::COUNT> counters;
+        std::atomic<unsigned long long> head{0};
+        void (*sink)(const DiagnosticRecord&) = nullptr;
+
+    public:
+        Diagnostics() {
+            policies.fill(DiagnosticPolicy::THROW);
+            for (auto& c : counters) c = 0;
+        }
+        void setPolicy(DiagnosticCode code, DiagnosticPolicy policy) {
+            policies[(size_t)code] = policy;
+        }
+        DiagnosticPolicy getPolicy(DiagnosticCode code) {
+            return policies[(size_t)code];
+        }
+        void setSink(void (*f)(const DiagnosticRecord&)) {
+            sink = f;
+        }
+        // returns true if the caller should throw
+        bool report(DiagnosticCode code, LogicSimObject* obj, const WireStateValue* a = nullptr, const WireStateValue* b = nullptr) {
+            counters[(size_t)code]++;
+            DiagnosticPolicy policy = policies[(size_t)code];
+            if (policy == DiagnosticPolicy::COUNT) return false;
+            unsigned long long seq = head++;
+            DiagnosticRecord& r = records[seq % capacity];
+            r.sequence = seq;
+            r.code = code;
+            r.obj = obj;
+            r.values[0] = DiagnosticValue::of(a);
+            r.values[1] = DiagnosticValue::of(b);
+            if (policy == DiagnosticPolicy::LOG && sink != nullptr) sink(r);
+            return policy == DiagnosticPolicy::THROW;
+        }
+        unsigned long long count(DiagnosticCode code) {
+            return counters[(size_t)code];
+        }
+        size_t size() {
+            unsigned long long h = head;
+            return h < capacity ? (size_t)h : capacity;
+        }
+        // oldest first
+        vector<DiagnosticRecord> snapshot() {
+            vector<DiagnosticRecord> ret;
+            unsigned long long h = head;
+            unsigned long long start = h < capacity ? 0 : h - capacity;
+            ret.reserve((size_t)(h - start));
+            for (unsigned long long i = start; i < h; i++) {
+                ret.push_back(records[i % capacity]);
+            }
+            return ret;
+        }
+        void clear() {
+            head = 0;
+            for (auto& c : counters) c = 0;
+        }
+        static string format(const DiagnosticRecord& r) {
+            string s = "#" + to_string(r.sequence) + " " + diagnosticcode_to_str(r.code);
+            if (r.obj != nullptr) s += " at " + string(r.obj->getObjectType()) + ":" + to_string((void*)r.obj);
+            for (auto& v : r.values) {
+                if (v.type == WireStateValueType::NONE) continue;
+                s += " " + v.toString() + "@" + to_string(v.resistance);
+            }
+            return s;
+        }
+    };
+    Diagnostics diagnostics;
+    inline void report_invalid_key(LogicSimObject* obj) {
+        diagnostics.report(DiagnosticCode::INVALID_KEY, obj);
     }
 
     class WireState final : public LogicSimObject {
@@ -308,6 +765,8 @@ namespace LogicSim {
         std::vector<WireStateValue> values;
         Wire* root;
         WireStateValue overridevalue = WireStateValue();
+        // resolution left to a WireResolver; only the driver list is kept
+        bool external = false;
         std::vector<WireStateValue*> getStatesForResistance(unsigned short resistance) {
             std::vector<WireStateValue*> ret;
             for (auto& value : values) {
@@ -317,14 +776,18 @@ namespace LogicSim {
             }
             return ret;
         }
-        WireStateValue& HandlerCheck(WireStateValue* a, WireStateValue* b) {
+        WireStateValue HandlerCheck(WireStateValue* a, WireStateValue* b, bool may_throw = true) {
             for (auto& handler : wire_state_conflicts_handlers) {
                 auto ret = handler(*a, *b);
                 if (std::get<0>(ret)) {
-                    return *std::get<1>(ret);
+                    WireStateValue v = *std::get<1>(ret);
+                    delete std::get<1>(ret);
+                    return v;
                 }
             }
-            throw Exceptions::ShortCircuitError(a, b, (LogicSimObject*)this->root);
+            if (diagnostics.report(DiagnosticCode::SHORT_CIRCUIT, (LogicSimObject*)this->root, a, b) && may_throw)
+                throw Exceptions::ShortCircuitError(a, b, (LogicSimObject*)this->root);
+            return WireStateValue();
         }
         unsigned short getLowestResistance() {
             return overridevalue.resistance;
@@ -338,6 +801,16 @@ namespace LogicSim {
             }
             return ret;
         }
+        // None if the drivers conflict; the conflict is always reported to
+        // diagnostics, and thrown only if may_throw and its policy says so
+        void resolveLowest(bool may_throw = true) {
+            overridevalue = WireStateValue();
+            if (values.empty()) return;
+            auto arr = getStatesForResistance(getLowestResistanceArr());
+            WireStateValue v = *arr[0];
+            for (size_t i = 1; i < arr.size(); i++) v = HandlerCheck(arr[i], &v, may_throw);
+            overridevalue = v;
+        }
     public:
         virtual const char* getObjectType() {
             return "WireState";
@@ -346,9 +819,28 @@ namespace LogicSim {
         WireStateValue getState() {
             return overridevalue;
         }
+        // every value currently driven onto this state, with its resistance
+        const std::vector<WireStateValue>& getDrivers() {
+            return values;
+        }
+        // lets a WireResolver replace the lowest-resistance pick
+        void setResolved(const WireStateValue& v) {
+            overridevalue = v;
+        }
+        // handing resolution back picks the lowest-resistance drivers again
+        void setExternal(bool e, bool may_throw = true) {
+            bool was = external;
+            external = e;
+            if (was && !e) resolveLowest(may_throw);
+        }
+        // no copy; for the value-change path
+        const WireStateValue& peekState() {
+            return overridevalue;
+        }
         void pushState(WireStateValue value) {
-            if (value.resistance == -1) return;
+            if (value.resistance == (unsigned short)-1) return;
             values.push_back(value);
+            if (external) return;
             if (value.resistance < overridevalue.resistance) {
                 overridevalue = value;
                 return;
@@ -356,13 +848,11 @@ namespace LogicSim {
                 auto arr = getStatesForResistance(value.resistance);
                 WireStateValue v = WireStateValue();
                 if (arr.size() >= 1) {
-                    for (int i = 0; i < arr.size(); i++) {
+                    for (size_t i = 0; i < arr.size(); i++) {
                         if (i == 0) {
-                            v = arr[i];
+                            v = *arr[i];
                         } else {
-                            void* c = &HandlerCheck(arr[i], &v);
-                            v = *(WireStateValue*)c;
-                            delete c;
+                            v = HandlerCheck(arr[i], &v);
                         }
                     }
                 }
@@ -371,77 +861,180 @@ namespace LogicSim {
                 auto arr = getStatesForResistance(value.resistance);
                 WireStateValue v = WireStateValue();
                 if (arr.size() >= 1) {
-                    for (int i = 0; i < arr.size(); i++) {
+                    for (size_t i = 0; i < arr.size(); i++) {
                         if (i == 0) {
-                            v = arr[i];
+                            v = *arr[i];
                         } else {
-                            void* c = &HandlerCheck(arr[i], &v);
-                            v = *(WireStateValue*)c;
-                            delete c;
+                            v = HandlerCheck(arr[i], &v);
                         }
                     }
                 }
             }
         }
+        // the remaining drivers are resolved again from the lowest resistance
+        // up, whichever level the popped value came from
         void popState(WireStateValue value) {
-            if (value.resistance == -1) return;
+            if (value.resistance == (unsigned short)-1) return;
             for (auto it = values.begin(); it != values.end(); it++) {
                 if (it->is(value)) {
                     values.erase(it);
                     break;
                 }
             }
-            if (value.is(overridevalue)) {
-                overridevalue = WireStateValue();
+            if (external) return;
+            resolveLowest();
+        }
+    };
+    enum class LogicFunction {
+        NONE,
+        BUF,
+        NOT,
+        AND,
+        OR,
+        XOR,
+        NAND,
+        NOR,
+        XNOR
+    };
+    // widest gate the evaluators accept; wider gates are rejected when built or compiled
+    constexpr unsigned int LOGIC_MAX_INPUTS = 16;
+    inline unsigned long long eval_logic(LogicFunction f, const unsigned long long* in, size_t n) {
+        unsigned long long v = n > 0 ? in[0] : 0;
+        switch (f) {
+        case LogicFunction::AND:
+        case LogicFunction::NAND:
+            for (size_t i = 1; i < n; i++) v &= in[i];
+            break;
+        case LogicFunction::OR:
+        case LogicFunction::NOR:
+            for (size_t i = 1; i < n; i++) v |= in[i];
+            break;
+        case LogicFunction::XOR:
+        case LogicFunction::XNOR:
+            for (size_t i = 1; i < n; i++) v ^= in[i];
+            break;
+        default:
+            break;
+        }
+        switch (f) {
+        case LogicFunction::NOT:
+        case LogicFunction::NAND:
+        case LogicFunction::NOR:
+        case LogicFunction::XNOR:
+            return ~v;
+        default:
+            return v;
+        }
+    }
+    std::vector<void (*)(Pin*, int, const WireStateValue&)> pin_write_hooks;
+    // Replaces driver resolution for the wires it is attached to; called
+    // from Pin::drive after the driven value has been pushed.
+    class WireResolver {
+    public:
+        virtual void netChanged(Wire* wire, unsigned short index) = 0;
+        // from ~Wire; the resolver must forget the wire and must not throw
+        virtual void wireDestroyed(Wire* wire) = 0;
+    };
+    // called with the resolved value bits before and after a change, from
+    // Pin::drive and from resolvers through Wire::reportChange
+    void (*wire_change_hook)(Wire*, unsigned short, unsigned long long, unsigned long long) = nullptr;
+    enum class WatchKind {
+        EQUAL,
+        MASK,
+        RISING,
+        FALLING,
+        CHANGE,
+        RANGE
+    };
+    // Predicates are reduced to mask/value/range words when created, so a
+    // check is a couple of integer compares on the resolved value bits.
+    struct Watchpoint {
+        unsigned int id = 0;
+        WatchKind kind = WatchKind::CHANGE;
+        unsigned short index = 0;
+        unsigned long long mask = ~0ULL;
+        unsigned long long value = 0;
+        unsigned long long high = 0;
+        void (*callback)(void*, Wire*, unsigned long long) = nullptr;
+        void* instance = nullptr;
+        unsigned long long hits = 0;
+        bool enabled = true;
+
+        bool matches(unsigned long long before, unsigned long long after) const {
+            switch (kind) {
+            case WatchKind::EQUAL:
+            case WatchKind::MASK:
+                return (after & mask) == value && (before & mask) != value;
+            case WatchKind::RISING:
+                return !(before & mask) && (after & mask);
+            case WatchKind::FALLING:
+                return (before & mask) && !(after & mask);
+            case WatchKind::CHANGE:
+                return ((before ^ after) & mask) != 0;
+            case WatchKind::RANGE: {
+                unsigned long long b = before & mask, a = after & mask;
+                return a >= value && a <= high && !(b >= value && b <= high);
             }
-            if (values.size() == 0) return;
-            auto arr = getStatesForResistance(value.resistance);
-            WireStateValue v = WireStateValue();
-            if (arr.size() >= 1) {
-                for (int i = 0; i < arr.size(); i++) {
-                    if (i == 0) {
-                        v = arr[i];
-                    } else {
-                        void* c = &HandlerCheck(arr[i], &v);
-                        v = *(WireStateValue*)c;
-                        delete c;
-                    }
-                }
             }
-            overridevalue = v;
+            return false;
         }
     };
-    enum class PinMark {
+    enum class PinMark : unsigned char {
         INPUT,
         OUTPUT,
         BIDIRECTIONAL
     };
+    // names are rarely set and rarely read, so they live outside the pins;
+    // gates may be built and torn down on several threads at once
+    unordered_map<const Pin*, string> pin_names;
+    std::mutex pin_names_mtx;
     class Pin final : public LogicSimObject {
-        unsigned short pin_num;
-        string name;
+        BasicGate* root = nullptr;
         Wire* wire = nullptr;
-        WireStateValue state = WireStateValue();
+        unsigned short pin_num;
         PinMark mark = PinMark::BIDIRECTIONAL;
-        BasicGate* root = nullptr;
+        bool named = false;
+        unsigned short index = 0;
+        WireStateValue state = WireStateValue();
         friend class BasicGate;
+        friend void connect(Pin*, Wire*);
+        friend void disconnect(Pin*, Wire*);
+        void drive(int in, WireStateValue value);
+        void place(Wire* w, bool on);
     public:
         virtual const char* getObjectType() {
             return "Pin";
         }
         Pin(BasicGate* gate, unsigned short pin_num, string name) 
-            : root(gate), pin_num(pin_num), name(name) {};
+            : root(gate), pin_num(pin_num) {
+            setName(name);
+        };
         Pin(BasicGate* gate, unsigned short pin_num) 
-            : root(gate), pin_num(pin_num), name(to_string(pin_num)) {};
+            : root(gate), pin_num(pin_num) {};
         Pin(BasicGate* gate, unsigned short pin_num, PinMark mark) 
-            : root(gate), pin_num(pin_num), mark(mark), name(to_string(pin_num)) {};
+            : root(gate), pin_num(pin_num), mark(mark) {};
         Pin(BasicGate* gate, unsigned short pin_num, string name, PinMark mark) 
-            : root(gate), pin_num(pin_num), name(name), mark(mark) {};
+            : root(gate), pin_num(pin_num), mark(mark) {
+            setName(name);
+        };
+        Pin(const Pin&) = delete;
+        Pin& operator=(const Pin&) = delete;
         ~Pin();
         unsigned short getPinNum() {
             return pin_num;
         }
         string getName() {
-            return name;
+            if (named) {
+                std::lock_guard<std::mutex> lck(pin_names_mtx);
+                auto it = pin_names.find(this);
+                if (it != pin_names.end()) return it->second;
+            }
+            return to_string(pin_num);
+        }
+        void setName(const string& name) {
+            std::lock_guard<std::mutex> lck(pin_names_mtx);
+            pin_names[this] = name;
+            named = true;
         }
         PinMark getMark() {
             return mark;
@@ -467,27 +1060,80 @@ namespace LogicSim {
         bool hasWire() {
             return wire != nullptr;
         }
+        Wire* getWire() {
+            return wire;
+        }
         void setWire(Wire* wire);
         void write(int in,WireStateValue value);
         vector<WireState> read();
         
     };
     
+    vector<BasicGate*> update_queue;
+    bool update_settling = false;
+    // bumped by every settle, so gates can count their repeats within one
+    unsigned int settle_pass = 0;
+
+    // Fixed-size pin storage: one heap block holding exactly the gate's
+    // pins, or none for a gate without pins. It never grows after
+    // construction, so Pin pointers handed out by a gate stay valid for its
+    // lifetime.
+    class PinArray final {
+        Pin* data = nullptr;
+        unsigned short count = 0;
+    public:
+        PinArray() = default;
+        PinArray(const PinArray&) = delete;
+        PinArray& operator=(const PinArray&) = delete;
+        ~PinArray() {
+            for (unsigned short i = count; i > 0; i--) data[i - 1].~Pin();
+            ::operator delete((void*)data);
+        }
+        void allocate(unsigned short n) {
+            if (n > 0) data = (Pin*)::operator new(sizeof(Pin) * n);
+        }
+        template <typename... Args>
+        Pin& emplace(Args... args) {
+            return *new (&data[count++]) Pin(args...);
+        }
+        Pin& operator[](size_t i) {
+            return data[i];
+        }
+        size_t size() {
+            return count;
+        }
+        Pin* begin() {
+            return data;
+        }
+        Pin* end() {
+            return data + count;
+        }
+    };
+
     class BasicGate : public LogicSimObject {
     private:
         bool marked_forUpdate = false;
+        bool forced_x = false;
+        unsigned int pass = 0;
+        unsigned int repeats = 0;
         void await_for_update();
+        static void settle();
+        static void breakOscillation(const vector<BasicGate*>& looping);
         friend class Wire;
         void markForUpdate() {
+            // an input changing after the settle that forced it re-enables it
+            if (forced_x && (!update_settling || pass != settle_pass)) forced_x = false;
             if (!marked_forUpdate) {
                 marked_forUpdate = true;
                 await_for_update();
             }
         }
     protected:
-        vector<Pin> pins;
-        vector<Pin*> input_pins;
-        vector<Pin*> output_pins;
+        // inputs first, then outputs, then bidirectional pins (which count as both)
+        PinArray pins;
+        unsigned short input_count = 0;
+        unsigned short output_count = 0;
+        unsigned short bidirectional_count = 0;
         virtual void update() = 0;
         virtual void init() {};
         friend class MainSim;
@@ -496,58 +1142,77 @@ namespace LogicSim {
         }
         unsigned short get_pin_bits(unsigned short pin_num);
         void set_pin_bits(unsigned short pin_num, unsigned short bits);
+        WireStateValue read_pin(unsigned short pin_num, unsigned short index = 0);
+        void write_pin(unsigned short pin_num, WireStateValue value, unsigned short index = 0);
 
     public:
         virtual bool isConfigurable() {return false;}
+        virtual LogicFunction getLogicFunction() {return LogicFunction::NONE;}
+        virtual bool isSequential() {return false;}
+        bool isForcedX() {
+            return forced_x;
+        }
+        void clearForcedX() {
+            forced_x = false;
+        }
+        size_t getPinCount() {
+            return pins.size();
+        }
+        Pin* getPin(unsigned short pin_num) {
+            return &pins[pin_num];
+        }
+        // writes made between beginUpdate() and endUpdate() settle together
+        static bool beginUpdate() {
+            bool was = update_settling;
+            update_settling = true;
+            return was;
+        }
+        static void endUpdate(bool was) {
+            if (was) return;
+            update_settling = false;
+            if (!update_queue.empty()) settle();
+        }
         virtual const char* getObjectType() {
             return "BasicGate";
         }
-        BasicGate() = default;
-        BasicGate(unsigned short num_pins) {
-            for (int i = 0; i < num_pins; i++) {
-                pins.push_back(Pin(this,i + 1));
-                input_pins.push_back(&pins[i]);
-                output_pins.push_back(&pins[i]);
-            }
+        size_t getInputCount() {
+            return (size_t)input_count + bidirectional_count;
         }
-        BasicGate(unsigned short input_pins, unsigned short output_pins) {
-            for (int i = 0; i < input_pins; i++) {
-                pins.push_back(Pin(this, i + 1, PinMark::INPUT));
-                this->input_pins.push_back(&pins[i]);
-            }
-            for (int i = 0; i < output_pins; i++) {
-                pins.push_back(Pin(this, i + output_pins + 1, PinMark::OUTPUT));
-                this->output_pins.push_back(&pins[i]);
-            }
+        size_t getOutputCount() {
+            return (size_t)output_count + bidirectional_count;
         }
-        BasicGate(unsigned short input_pins, unsigned short output_pins, unsigned short bidirectional_pins) {
-            for (int i = 0; i < input_pins; i++) {
-                pins.push_back(Pin(this, i + 1, PinMark::INPUT));
-                this->input_pins.push_back(&pins[i]);
-            }
-            for (int i = 0; i < output_pins; i++) {
-                pins.push_back(Pin(this, i + output_pins + 1, PinMark::OUTPUT));
-                this->output_pins.push_back(&pins[i]);
-            }
-            for (int i = 0; i < bidirectional_pins; i++) {
-                pins.push_back(Pin(this, i + output_pins + input_pins + 1, PinMark::BIDIRECTIONAL));
-                this->output_pins.push_back(&pins[i]);
-                this->input_pins.push_back(&pins[i]);
-            }
+        Pin* getInputPin(size_t i) {
+            return &pins[i < input_count ? i : i + output_count];
+        }
+        Pin* getOutputPin(size_t i) {
+            return &pins[input_count + i];
+        }
+        BasicGate() = default;
+        BasicGate(unsigned short num_pins) : bidirectional_count(num_pins) {
+            pins.allocate(num_pins);
+            for (int i = 0; i < num_pins; i++) pins.emplace(this, (unsigned short)(i + 1));
+        }
+        BasicGate(unsigned short input_pins, unsigned short output_pins) : BasicGate(input_pins, output_pins, 0) {};
+        BasicGate(unsigned short input_pins, unsigned short output_pins, unsigned short bidirectional_pins) :
+            input_count(input_pins), output_count(output_pins), bidirectional_count(bidirectional_pins) {
+            pins.allocate(input_pins + output_pins + bidirectional_pins);
+            unsigned short n = 1;
+            for (int i = 0; i < input_pins; i++) pins.emplace(this, n++, PinMark::INPUT);
+            for (int i = 0; i < output_pins; i++) pins.emplace(this, n++, PinMark::OUTPUT);
+            for (int i = 0; i < bidirectional_pins; i++) pins.emplace(this, n++, PinMark::BIDIRECTIONAL);
         }
-
     };
     class ConfigurableBasicGate : public BasicGate {
     protected:
         unsigned short assert_config_bits() {
-            auto a = config_table.find("Bits");
+            auto a = config_table.find(ConfigKeys::Bits);
             if (a == config_table.end()) 
                 throw LogicSim::LogicSimException("Missing 'Bits' in config table", this);
             return a->second.get()->get_t<unsigned short>();
         }
         void assert_pin(unsigned short pin_n, unsigned short bits);
         void assert_all_pins() {
-            auto bits = config_table.find("Bits")->second.get()->get_t<unsigned short>();
+            auto bits = config_table.find(ConfigKeys::Bits)->second.get()->get_t<unsigned short>();
 
         }
     public:
@@ -571,12 +1236,17 @@ namespace LogicSim {
         friend void connect(Pin*,Wire*);
         friend void disconnect(Pin*,Wire*);
         vector<Pin*> pins;
+        unique_ptr<vector<Watchpoint>> watches;
+        unsigned long long activity_tag = 0;
+        WireResolver* resolver = nullptr;
+        void checkWatches(unsigned short index, unsigned long long before, unsigned long long after);
     public:
         virtual const char* getObjectType() {
             return "Wire";
         }
         Wire() = default;
         ~Wire() {
+            if (resolver != nullptr) resolver->wireDestroyed(this);
             for (auto pin : pins) {
                 pin->setWire(nullptr);
             }
@@ -588,19 +1258,233 @@ namespace LogicSim {
         vector<WireState> getState() {
             return state;
         }
+        size_t getStateCount() {
+            return state.size();
+        }
+        const vector<Pin*>& getPins() {
+            return pins;
+        }
+        // the watch list only exists while at least one watchpoint is attached
+        unsigned int addWatch(Watchpoint w) {
+            static unsigned int next_id = 1;
+            if (!watches) watches.reset(new vector<Watchpoint>());
+            w.id = next_id++;
+            watches->push_back(w);
+            return w.id;
+        }
+        bool removeWatch(unsigned int id) {
+            if (!watches) return false;
+            auto it = std::find_if(watches->begin(), watches->end(), [id](const Watchpoint& w) { return w.id == id; });
+            if (it == watches->end()) return false;
+            watches->erase(it);
+            if (watches->empty()) watches.reset();
+            return true;
+        }
+        Watchpoint* getWatch(unsigned int id) {
+            if (!watches) return nullptr;
+            for (auto& w : *watches) {
+                if (w.id == id) return &w;
+            }
+            return nullptr;
+        }
+        bool hasWatches() {
+            return (bool)watches;
+        }
+        WireResolver* getResolver() {
+            return resolver;
+        }
+        // a resolver takes over state 0 only
+        void setResolver(WireResolver* r) {
+            resolver = r;
+            getWireState(0)->setExternal(r != nullptr);
+        }
+        // hands state 0 back from a resolver without throwing: a conflict
+        // between the remaining drivers is only reported and reads as None
+        void releaseResolver() {
+            resolver = nullptr;
+            getWireState(0)->setExternal(false, false);
+        }
+        WireState* getWireState(unsigned short index) {
+            while (state.size() <= index) state.push_back(WireState(this));
+            return &state[index];
+        }
+        // owned by whichever activity collector is running; 0 when untracked
+        unsigned long long getActivityTag() {
+            return activity_tag;
+        }
+        void setActivityTag(unsigned long long tag) {
+            activity_tag = tag;
+        }
+
+        // runs the change hook and the watchpoints if state index no longer
+        // has the given type and bits; resolvers call it for the nets they
+        // rewrite outside Pin::drive
+        void reportChange(unsigned short index, WireStateValueType type, unsigned long long before) {
+            const WireStateValue& cur = getWireState(index)->peekState();
+            unsigned long long after = wire_value_bits(cur);
+            if (cur.type == type && after == before) return;
+            if (wire_change_hook != nullptr) wire_change_hook(this, index, before, after);
+            if (watches) checkWatches(index, before, after);
+        }
 
         void mark_for_update() {
             for (auto pin : pins) {
                 if (pin->getMark() != PinMark::OUTPUT) pin->getRoot()->markForUpdate();
             }
         }
+        // queues the readers for the next settle instead of settling now, so
+        // it never runs gate code; for destructors
+        void defer_update() {
+            bool was = update_settling;
+            update_settling = true;
+            mark_for_update();
+            update_settling = was;
+        }
     };
+    void Pin::setWire(Wire* wire) {
+        this->wire = wire;
+    }
+    Pin::~Pin() {
+        if (wire != nullptr) {
+            auto& v = wire->pins;
+            v.erase(std::remove(v.begin(), v.end(), this), v.end());
+        }
+        if (named) {
+            std::lock_guard<std::mutex> lck(pin_names_mtx);
+            pin_names.erase(this);
+        }
+    }
+    // a wire holds exactly the values of the pins on it: the value a pin
+    // drives goes on with it and comes off with it
     void connect(Pin* p,Wire* w) {
         p->setWire(w);
         w->pins.push_back(p);
+        p->place(w, true);
     };
+    // the pin is off the wire before the readers settle, so a loop through
+    // its own gate cannot drive it again
     void disconnect(Pin* p, Wire* w) {
+        bool was = p->wire == w;
         p->setWire(nullptr);
         w->pins.erase(remove(w->pins.begin(), w->pins.end(), p), w->pins.end());
+        if (was) p->place(w, false);
     };
+    void Pin::place(Wire* w, bool on) {
+        if (state.resistance == (unsigned short)-1) return;
+        WireState& ws = *w->getWireState(index);
+        const WireStateValue& cur = ws.peekState();
+        WireStateValueType type = cur.type;
+        unsigned long long before = wire_value_bits(cur);
+        if (on) ws.pushState(state);
+        else ws.popState(state);
+        if (w->resolver != nullptr) w->resolver->netChanged(w, index);
+        w->reportChange(index, type, before);
+        w->mark_for_update();
+    }
+
+    void Pin::write(int in, WireStateValue value) {
+        for (auto& hook : pin_write_hooks) {
+            hook(this, in, value);
+        }
+        drive(in, value);
+    }
+    // an unconnected pin keeps its value for the wire it joins next
+    void Pin::drive(int in, WireStateValue value) {
+        if (wire == nullptr) {
+            index = (unsigned short)in;
+            state = value;
+            return;
+        }
+        while (wire->state.size() <= (size_t)in) {
+            wire->state.push_back(WireState(wire));
+        }
+        WireState& ws = wire->state[in];
+        index = (unsigned short)in;
+        DiagnosticValue before = DiagnosticValue::of(&ws.peekState());
+        ws.popState(state);
+        state = value;
+        ws.pushState(value);
+        if (wire->resolver != nullptr) wire->resolver->netChanged(wire, (unsigned short)in);
+        if (wire->watches || wire_change_hook != nullptr) wire->reportChange((unsigned short)in, before.type, before.bits);
+        // readers only see the resolved value, so rewriting it is no event;
+        // this is what lets a stable feedback loop settle
+        if (wire->resolver == nullptr && before.same(ws.peekState())) return;
+        wire->mark_for_update();
+    }
+    void Wire::checkWatches(unsigned short index, unsigned long long before, unsigned long long after) {
+        // copied so a callback may add or remove watchpoints
+        vector<Watchpoint> current = *watches;
+        for (auto& w : current) {
+            if (!w.enabled || w.index != index || !w.matches(before, after)) continue;
+            Watchpoint* live = getWatch(w.id);
+            if (live != nullptr) live->hits++;
+            if (w.callback != nullptr) w.callback(w.instance, this, after);
+            if (!watches) break;
+        }
+    }
+    vector<WireState> Pin::read() {
+        if (wire == nullptr) return vector<WireState>();
+        return wire->getState();
+    }
+    WireStateValue BasicGate::read_pin(unsigned short pin_num, unsigned short index) {
+        Pin& p = pins[pin_num];
+        if (p.wire == nullptr) return WireStateValue();
+        return p.wire->getState(index);
+    }
+    void BasicGate::await_for_update() {
+        update_queue.push_back(this);
+        if (!update_settling) settle();
+    }
+    // Gates are evaluated in delta cycles from a queue instead of recursively.
+    // A gate evaluated more than settle_limit times in one settle is taken to
+    // be oscillating, however long the acyclic logic in front of it is.
+    void BasicGate::settle() {
+        update_settling = true;
+        settle_pass++;
+        vector<BasicGate*> current, looping;
+        try {
+            while (!update_queue.empty()) {
+                current.swap(update_queue);
+                for (auto g : current) {
+                    g->marked_forUpdate = false;
+                    if (g->forced_x) continue;
+                    if (g->pass != settle_pass) {
+                        g->pass = settle_pass;
+                        g->repeats = 0;
+                    }
+                    if (++g->repeats > settle_limit) looping.push_back(g);
+                    else g->update();
+                }
+                current.clear();
+                if (!looping.empty()) {
+                    breakOscillation(looping);
+                    looping.clear();
+                }
+            }
+        } catch (...) {
+            for (auto g : update_queue) g->marked_forUpdate = false;
+            for (auto g : current) g->marked_forUpdate = false;
+            update_queue.clear();
+            update_settling = false;
+            throw;
+        }
+        update_settling = false;
+    }
+    // Forces the outputs of the oscillating gates to X by withdrawing them,
+    // so the loop stops and their nets resolve from the remaining drivers.
+    void BasicGate::breakOscillation(const vector<BasicGate*>& looping) {
+        for (auto g : looping) {
+            if (diagnostics.report(DiagnosticCode::OSCILLATION, g))
+                throw Exceptions::OscillationError(g, settle_limit);
+        }
+        for (auto g : looping) {
+            g->forced_x = true;
+            for (auto& p : g->pins) {
+                if (p.getMark() != PinMark::INPUT) p.drive(p.index, WireStateValue());
+            }
+        }
+    }
+    void BasicGate::write_pin(unsigned short pin_num, WireStateValue value, unsigned short index) {
+        pins[pin_num].drive(index, value);
+    }
 };
\ No newline at end of file
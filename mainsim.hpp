@@ -0,0 +1,108 @@
+#pragma once
+
+#include <queue>
+#include <vector>
+#include <functional>
+
+#include "main_init.hpp"
+#include "clockgate.hpp"
+
+namespace LogicSim {
+    using DigitalLogic::SimTime;
+    using DigitalLogic::NEVER;
+    using DigitalLogic::ClockGate;
+
+    // Discrete-event scheduler. Every clock keeps exactly one pending edge in
+    // the queue, so idle stretches are skipped by jumping straight to the
+    // earliest pending entry instead of stepping through empty time.
+    class MainSim final : public LogicSimObject {
+        struct Pending {
+            SimTime time;
+            unsigned long long seq;
+            ClockGate* clock;
+            void (*function)(void*);
+            void* instance;
+            bool operator>(const Pending& other) const {
+                if (time != other.time) return time > other.time;
+                return seq > other.seq;
+            }
+        };
+        std::priority_queue<Pending, vector<Pending>, std::greater<Pending>> queue;
+        vector<ClockGate*> clocks;
+        SimTime now = 0;
+        unsigned long long seq = 0;
+        unsigned long long processed = 0;
+        bool paused = false;
+
+        void push(SimTime t, ClockGate* clock, void (*f)(void*), void* instance) {
+            queue.push({t, seq++, clock, f, instance});
+        }
+    public:
+        virtual const char* getObjectType() {
+            return "MainSim";
+        }
+        MainSim() = default;
+        void addGate(BasicGate* gate) {
+            gate->init();
+        }
+        void addClock(ClockGate* clock) {
+            ((BasicGate*)clock)->init();
+            clocks.push_back(clock);
+            clock->setLevel(clock->levelAt(now));
+            SimTime t = clock->nextEdge(now);
+            if (t != NEVER) push(t, clock, nullptr, nullptr);
+        }
+        void schedule(SimTime time, void (*f)(void*), void* instance) {
+            if (time < now) time = now;
+            push(time, nullptr, f, instance);
+        }
+        void scheduleAfter(SimTime delay, void (*f)(void*), void* instance) {
+            schedule(now + delay, f, instance);
+        }
+        SimTime getTime() {
+            return now;
+        }
+        SimTime nextEventTime() {
+            return queue.empty() ? NEVER : queue.top().time;
+        }
+        unsigned long long getProcessed() {
+            return processed;
+        }
+        // processes everything pending at the earliest time; false once the queue is empty
+        bool step() {
+            if (queue.empty()) return false;
+            now = queue.top().time;
+            while (!queue.empty() && queue.top().time == now) {
+                Pending p = queue.top();
+                queue.pop();
+                processed++;
+                if (p.clock != nullptr) {
+                    p.clock->setLevel(p.clock->levelAt(now));
+                    SimTime t = p.clock->nextEdge(now);
+                    if (t != NEVER) push(t, p.clock, nullptr, nullptr);
+                } else {
+                    p.function(p.instance);
+                }
+            }
+            return true;
+        }
+        // a pause requested while a time step is running takes effect once that step is complete
+        void pause() {
+            paused = true;
+        }
+        bool isPaused() {
+            return paused;
+        }
+        // false if a pause stopped the run before it reached time
+        bool runUntil(SimTime time) {
+            paused = false;
+            while (!paused && !queue.empty() && queue.top().time <= time) step();
+            if (paused) return false;
+            if (time > now) now = time;
+            return true;
+        }
+        bool runFor(SimTime duration) {
+            return runUntil(now + duration);
+        }
+    };
+};
@@ -0,0 +1,316 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <cstring>
+#include <cstdio>
+#include <algorithm>
+
+#ifdef WIN32
+#include <fstream>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include "main_init.hpp"
+
+namespace LogicSim {
+    namespace Exceptions {
+        class MemoryImageError : public LogicSimException {
+        public:
+            MemoryImageError(const string& path, LogicSimObject* obj) :
+                LogicSimException("Unable to map memory image '" + path + "'", obj) {};
+        };
+    };
+
+    // read-only, privately mapped so every instance shares the same physical pages
+    class MemoryImage final : public LogicSimObject {
+        const unsigned char* data = nullptr;
+        size_t length = 0;
+        string path;
+#ifdef WIN32
+        vector<unsigned char> buffer;
+#endif
+    public:
+        virtual const char* getObjectType() {
+            return "MemoryImage";
+        }
+        MemoryImage(const string& path) : path(path) {
+#ifdef WIN32
+            std::ifstream f(path, std::ios::binary);
+            if (!f) throw Exceptions::MemoryImageError(path, this);
+            buffer.assign(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
+            data = buffer.data();
+            length = buffer.size();
+#else
+            int fd = open(path.c_str(), O_RDONLY);
+            if (fd < 0) throw Exceptions::MemoryImageError(path, this);
+            struct stat st;
+            if (fstat(fd, &st) != 0) {
+                close(fd);
+                throw Exceptions::MemoryImageError(path, this);
+            }
+            length = (size_t)st.st_size;
+            if (length > 0) {
+                void* m = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (m == MAP_FAILED) {
+                    close(fd);
+                    throw Exceptions::MemoryImageError(path, this);
+                }
+                data = (const unsigned char*)m;
+            }
+            close(fd);
+#endif
+        }
+        MemoryImage(const MemoryImage&) = delete;
+        MemoryImage& operator=(const MemoryImage&) = delete;
+        ~MemoryImage() {
+#ifndef WIN32
+            if (data != nullptr) munmap((void*)data, length);
+#endif
+        }
+        size_t size() {
+            return length;
+        }
+        const unsigned char* bytes() {
+            return data;
+        }
+        string getPath() {
+            return path;
+        }
+    };
+
+    struct MemoryPage {
+        static constexpr size_t size = 4096;
+        unsigned char data[size] = {};
+    };
+
+    // pages are allocated on first write and copied on first write after fork()
+    class PagedMemory final : public LogicSimObject {
+        unordered_map<unsigned long long, shared_ptr<MemoryPage>> pages;
+        shared_ptr<MemoryImage> image;
+        unsigned long long length = 0;
+
+        unsigned char imageByte(unsigned long long address) {
+            if (image == nullptr || address >= image->size()) return 0;
+            return image->bytes()[address];
+        }
+        MemoryPage* writablePage(unsigned long long page_n) {
+            auto it = pages.find(page_n);
+            if (it == pages.end()) {
+                auto page = make_shared<MemoryPage>();
+                unsigned long long base = page_n * MemoryPage::size;
+                if (image != nullptr && base < image->size()) {
+                    size_t n = std::min<size_t>(MemoryPage::size, image->size() - base);
+                    std::memcpy(page->data, image->bytes() + base, n);
+                }
+                pages[page_n] = page;
+                return page.get();
+            }
+            if (it->second.use_count() > 1) {
+                it->second = make_shared<MemoryPage>(*it->second);
+            }
+            return it->second.get();
+        }
+    public:
+        virtual const char* getObjectType() {
+            return "PagedMemory";
+        }
+        PagedMemory(unsigned long long length) : length(length) {};
+        PagedMemory(unsigned long long length, shared_ptr<MemoryImage> image) : image(image), length(length) {};
+        PagedMemory(const PagedMemory& other) : pages(other.pages), image(other.image), length(other.length) {};
+
+        shared_ptr<PagedMemory> fork() {
+            return make_shared<PagedMemory>(*this);
+        }
+        unsigned long long size() {
+            return length;
+        }
+        size_t residentPages() {
+            return pages.size();
+        }
+        unsigned char readByte(unsigned long long address) {
+            if (address >= length) return 0;
+            auto it = pages.find(address / MemoryPage::size);
+            if (it == pages.end()) return imageByte(address);
+            return it->second->data[address % MemoryPage::size];
+        }
+        void writeByte(unsigned long long address, unsigned char value) {
+            if (address >= length) return;
+            writablePage(address / MemoryPage::size)->data[address % MemoryPage::size] = value;
+        }
+        // one page lookup per page touched; little-endian byte order
+        unsigned long long readWord(unsigned long long address, unsigned short bytes) {
+            unsigned long long ret = 0;
+            unsigned short i = 0;
+            while (i < bytes && address < length && i < length - address) {
+                unsigned long long a = address + i;
+                unsigned long long offset = a % MemoryPage::size;
+                unsigned short chunk = (unsigned short)std::min<unsigned long long>({(unsigned long long)(bytes - i), MemoryPage::size - offset, length - a});
+                auto it = pages.find(a / MemoryPage::size);
+                if (it != pages.end()) {
+                    const unsigned char* src = it->second->data + offset;
+                    for (unsigned short k = 0; k < chunk; k++) ret |= (unsigned long long)src[k] << (8 * (i + k));
+                } else {
+                    for (unsigned short k = 0; k < chunk; k++) ret |= (unsigned long long)imageByte(a + k) << (8 * (i + k));
+                }
+                i += chunk;
+            }
+            return ret;
+        }
+        void writeWord(unsigned long long address, unsigned short bytes, unsigned long long value) {
+            unsigned short i = 0;
+            while (i < bytes && address < length && i < length - address) {
+                unsigned long long a = address + i;
+                unsigned long long offset = a % MemoryPage::size;
+                unsigned short chunk = (unsigned short)std::min<unsigned long long>({(unsigned long long)(bytes - i), MemoryPage::size - offset, length - a});
+                unsigned char* dst = writablePage(a / MemoryPage::size)->data + offset;
+                for (unsigned short k = 0; k < chunk; k++) dst[k] = (unsigned char)(value >> (8 * (i + k)));
+                i += chunk;
+            }
+        }
+        void load(unsigned long long address, const void* src, size_t n) {
+            const unsigned char* p = (const unsigned char*)src;
+            while (n > 0 && address < length) {
+                unsigned long long offset = address % MemoryPage::size;
+                size_t chunk = std::min<size_t>(n, MemoryPage::size - offset);
+                std::memcpy(writablePage(address / MemoryPage::size)->data + offset, p, chunk);
+                address += chunk;
+                p += chunk;
+                n -= chunk;
+            }
+        }
+        void clear() {
+            pages.clear();
+        }
+    };
+};
+
+namespace DigitalLogic {
+    using std::string;
+    using std::shared_ptr;
+    using std::make_shared;
+    using LogicSim::ConfigurableBasicGate;
+    using LogicSim::WireStateValue;
+    using LogicSim::WireStateValueType;
+    using LogicSim::PagedMemory;
+    using LogicSim::MemoryImage;
+    using LogicSim::LogicSimException;
+
+    class MemoryGate : public ConfigurableBasicGate {
+    protected:
+        shared_ptr<PagedMemory> memory;
+        unsigned short bits = 0;
+        unsigned short word_bytes = 0;
+        unsigned long long words = 0;
+
+        unsigned long long mask() {
+            return bits >= 64 ? ~0ULL : ((1ULL << bits) - 1);
+        }
+        PagedMemory& assert_memory() {
+            if (memory == nullptr)
+                throw LogicSimException("Memory used before init()", this);
+            return *memory;
+        }
+        // address < words, and load_config() keeps words * word_bytes in range
+        unsigned long long readAt(unsigned long long address) {
+            PagedMemory& m = assert_memory();
+            if (address >= words) return 0;
+            return m.readWord(address * word_bytes, word_bytes) & mask();
+        }
+        void writeAt(unsigned long long address, unsigned long long value) {
+            PagedMemory& m = assert_memory();
+            if (address >= words) return;
+            m.writeWord(address * word_bytes, word_bytes, value & mask());
+        }
+        void load_config() {
+            bits = assert_config_bits();
+            if (bits == 0 || bits > 64)
+                throw LogicSimException("'Bits' must be between 1 and 64", this);
+            word_bytes = (bits + 7) / 8;
+            auto a = config_table.find(LogicSim::ConfigKeys::Size);
+            if (a == config_table.end())
+                throw LogicSimException("Missing 'Size' in config table", this);
+            words = a->second.get()->get_t<unsigned long long>();
+            if (words > ~0ULL / word_bytes)
+                throw LogicSimException("'Size' in bytes does not fit in 64 bits", this);
+        }
+        shared_ptr<MemoryImage> load_image() {
+            auto a = config_table.find(LogicSim::ConfigKeys::Image);
+            if (a == config_table.end()) return nullptr;
+            return make_shared<MemoryImage>(a->second.get()->get_t<string>());
+        }
+    public:
+        MemoryGate(unsigned short input_pins, unsigned short output_pins) : ConfigurableBasicGate(input_pins, output_pins) {};
+        virtual const char* getObjectType() override {
+            return "MemoryGate";
+        }
+        shared_ptr<PagedMemory> getMemory() {
+            return memory;
+        }
+        void shareMemory(MemoryGate& other) {
+            if (other.memory == nullptr)
+                throw LogicSimException("Cannot share the memory of a gate that has not been initialized", &other);
+            memory = other.memory->fork();
+        }
+        unsigned long long peek(unsigned long long address) {
+            return readAt(address);
+        }
+    };
+
+    // Pins: address, data in, write enable, data out.
+    // Config: "Bits" (ushort), "Size" (ulonglong words), optional "Image" (string).
+    class RAMGate : public MemoryGate {
+    protected:
+        virtual void init() override {
+            load_config();
+            if (memory == nullptr) memory = make_shared<PagedMemory>(words * word_bytes, load_image());
+        }
+        // inputs can change while the gate is wired up, before init()
+        virtual void update() override {
+            if (memory == nullptr) return;
+            unsigned long long address = LogicSim::wire_value_bits(read_pin(0));
+            WireStateValue we = read_pin(2);
+            if (we.type == WireStateValueType::BIT && we.b) {
+                writeAt(address, LogicSim::wire_value_bits(read_pin(1)));
+            }
+            write_pin(3, WireStateValue(readAt(address)));
+        }
+    public:
+        RAMGate() : MemoryGate(3, 1) {};
+        virtual const char* getObjectType() override {
+            return "RAMGate";
+        }
+        void poke(unsigned long long address, unsigned long long value) {
+            writeAt(address, value);
+        }
+    };
+
+    // Pins: address, data out.
+    // Config: "Bits" (ushort), "Size" (ulonglong words), "Image" (string).
+    class ROMGate : public MemoryGate {
+    protected:
+        virtual void init() override {
+            load_config();
+            if (memory != nullptr) return;
+            auto image = load_image();
+            if (image == nullptr)
+                throw LogicSimException("Missing 'Image' in config table", this);
+            memory = make_shared<PagedMemory>(words * word_bytes, image);
+        }
+        virtual void update() override {
+            if (memory == nullptr) return;
+            write_pin(1, WireStateValue(readAt(LogicSim::wire_value_bits(read_pin(0)))));
+        }
+    public:
+        ROMGate() : MemoryGate(1, 1) {};
+        virtual const char* getObjectType() override {
+            return "ROMGate";
+        }
+    };
+};
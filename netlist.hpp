@@ -0,0 +1,449 @@
+#pragma once
+
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+#include <algorithm>
+#include <tuple>
+
+#include "main_init.hpp"
+
+namespace LogicSim {
+    const unsigned int NO_INDEX = 0xFFFFFFFF;
+
+    struct NetlistGate {
+        BasicGate* gate = nullptr;
+        LogicFunction function = LogicFunction::NONE;
+        vector<unsigned int> inputs;
+        vector<unsigned int> outputs;
+        vector<Pin*> input_pins;
+        vector<Pin*> output_pins;
+        unsigned int level = 0;
+    };
+
+    // flat, index-based view of the BasicGate/Wire graph with a topological order
+    class Netlist final : public LogicSimObject {
+        vector<Wire*> wires;
+        unordered_map<Wire*, unsigned int> wire_ids;
+        vector<NetlistGate> gates;
+        unordered_map<BasicGate*, unsigned int> gate_ids;
+        vector<vector<unsigned int>> fanout;
+        vector<vector<unsigned int>> drivers;
+        vector<unsigned int> order;
+        vector<unsigned int> cyclic;
+        vector<unsigned int> free_gates;
+        vector<std::tuple<void (*)(void*, const vector<unsigned int>&), void*>> listeners;
+        unsigned int max_level = 0;
+        bool levelized = false;
+        bool order_dirty = false;
+
+        static void eraseOne(vector<unsigned int>& v, unsigned int x) {
+            auto it = std::find(v.begin(), v.end(), x);
+            if (it != v.end()) v.erase(it);
+        }
+        unsigned int levelOf(unsigned int g) {
+            unsigned int l = 0;
+            for (auto w : gates[g].inputs) {
+                if (w == NO_INDEX) continue;
+                for (auto d : drivers[w]) {
+                    if (d != g) l = std::max(l, gates[d].level + 1);
+                }
+            }
+            return l;
+        }
+        vector<unsigned int> liveGates() {
+            vector<unsigned int> ret;
+            for (unsigned int g = 0; g < gates.size(); g++) {
+                if (gates[g].gate != nullptr) ret.push_back(g);
+            }
+            return ret;
+        }
+        // Recomputes levels of the seeds and walks forward only while levels
+        // keep changing. Falls back to a full levelize() around feedback
+        // loops, which may move any gate, so then every gate is affected.
+        vector<unsigned int> relevel(const vector<unsigned int>& seeds) {
+            vector<unsigned int> affected;
+            if (!cyclic.empty()) {
+                levelize();
+                return liveGates();
+            }
+            vector<unsigned int> work(seeds);
+            std::unordered_set<unsigned int> seen;
+            while (!work.empty()) {
+                unsigned int g = work.back();
+                work.pop_back();
+                if (gates[g].gate == nullptr) continue;
+                if (seen.insert(g).second) affected.push_back(g);
+                unsigned int l = levelOf(g);
+                if (l > gates.size()) {
+                    levelize();
+                    return liveGates();
+                }
+                if (l == gates[g].level) continue;
+                gates[g].level = l;
+                max_level = std::max(max_level, l);
+                for (auto w : gates[g].outputs) {
+                    if (w == NO_INDEX) continue;
+                    for (auto r : fanout[w]) {
+                        if (r != g) work.push_back(r);
+                    }
+                }
+            }
+            order_dirty = true;
+            return affected;
+        }
+        void notify(const vector<unsigned int>& affected) {
+            for (auto& l : listeners) std::get<0>(l)(std::get<1>(l), affected);
+        }
+        void locate(Pin* p, unsigned int& g, bool& output, size_t& slot) {
+            g = gateIndex(p->getRoot());
+            if (g == NO_INDEX) throw LogicSimException("Pin's gate is not part of the netlist", p);
+            for (slot = 0; slot < gates[g].input_pins.size(); slot++) {
+                if (gates[g].input_pins[slot] == p) {
+                    output = false;
+                    return;
+                }
+            }
+            for (slot = 0; slot < gates[g].output_pins.size(); slot++) {
+                if (gates[g].output_pins[slot] == p) {
+                    output = true;
+                    return;
+                }
+            }
+            throw LogicSimException("Pin not found on its gate", p);
+        }
+
+        unsigned int wireId(Wire* w) {
+            auto it = wire_ids.find(w);
+            if (it != wire_ids.end()) return it->second;
+            unsigned int id = (unsigned int)wires.size();
+            wires.push_back(w);
+            wire_ids[w] = id;
+            fanout.emplace_back();
+            drivers.emplace_back();
+            return id;
+        }
+    public:
+        virtual const char* getObjectType() {
+            return "Netlist";
+        }
+        Netlist() = default;
+        Netlist(const vector<BasicGate*>& gs) {
+            for (auto g : gs) addGate(g);
+            levelize();
+        }
+        Netlist(const Netlist&) = delete;
+        Netlist& operator=(const Netlist&) = delete;
+
+        unsigned int addGate(BasicGate* g) {
+            auto it = gate_ids.find(g);
+            if (it != gate_ids.end()) return it->second;
+            unsigned int id = (unsigned int)gates.size();
+            if (!free_gates.empty()) {
+                id = free_gates.back();
+                free_gates.pop_back();
+            }
+            gate_ids[g] = id;
+            NetlistGate ng;
+            ng.gate = g;
+            ng.function = g->getLogicFunction();
+            for (size_t i = 0; i < g->getPinCount(); i++) {
+                Pin* p = g->getPin((unsigned short)i);
+                unsigned int w = p->hasWire() ? wireId(p->getWire()) : NO_INDEX;
+                if (p->getMark() != PinMark::OUTPUT) {
+                    ng.inputs.push_back(w);
+                    ng.input_pins.push_back(p);
+                    if (w != NO_INDEX) fanout[w].push_back(id);
+                }
+                if (p->getMark() != PinMark::INPUT) {
+                    ng.outputs.push_back(w);
+                    ng.output_pins.push_back(p);
+                    if (w != NO_INDEX) drivers[w].push_back(id);
+                }
+            }
+            if (id == gates.size()) gates.push_back(std::move(ng));
+            else gates[id] = std::move(ng);
+            if (levelized) {
+                vector<unsigned int> seeds{id};
+                for (auto w : gates[id].outputs) {
+                    if (w == NO_INDEX) continue;
+                    for (auto r : fanout[w]) seeds.push_back(r);
+                }
+                notify(relevel(seeds));
+            }
+            return id;
+        }
+        // also takes the gate's pins off their wires
+        void removeGate(BasicGate* g) {
+            unsigned int id = gateIndex(g);
+            if (id == NO_INDEX) return;
+            for (auto pins : {&gates[id].input_pins, &gates[id].output_pins}) {
+                for (auto p : *pins) {
+                    if (p->hasWire()) disconnect(p, p->getWire());
+                }
+            }
+            // the drivers it read from lose a reader, so their timing changes
+            vector<unsigned int> seeds, upstream;
+            for (auto w : gates[id].inputs) {
+                if (w == NO_INDEX) continue;
+                eraseOne(fanout[w], id);
+                for (auto d : drivers[w]) {
+                    if (d != id) upstream.push_back(d);
+                }
+            }
+            for (auto w : gates[id].outputs) {
+                if (w == NO_INDEX) continue;
+                eraseOne(drivers[w], id);
+                for (auto r : fanout[w]) seeds.push_back(r);
+            }
+            gate_ids.erase(g);
+            gates[id] = NetlistGate();
+            free_gates.push_back(id);
+            eraseOne(cyclic, id);
+            order_dirty = true;
+            if (!levelized) return;
+            auto affected = relevel(seeds);
+            affected.insert(affected.end(), upstream.begin(), upstream.end());
+            affected.push_back(id);
+            notify(affected);
+        }
+        // rewires p onto w (or off its wire when w is null) in both the object graph and the netlist
+        void connectPin(Pin* p, Wire* w) {
+            unsigned int g;
+            bool output;
+            size_t slot;
+            locate(p, g, output, slot);
+            unsigned int old = output ? gates[g].outputs[slot] : gates[g].inputs[slot];
+            vector<unsigned int> seeds{g}, upstream;
+            if (old != NO_INDEX) {
+                disconnect(p, wires[old]);
+                if (output) {
+                    eraseOne(drivers[old], g);
+                    for (auto r : fanout[old]) seeds.push_back(r);
+                } else {
+                    eraseOne(fanout[old], g);
+                    // the old wire's drivers lose a reader
+                    for (auto d : drivers[old]) {
+                        if (d != g) upstream.push_back(d);
+                    }
+                }
+            }
+            unsigned int id = NO_INDEX;
+            if (w != nullptr) {
+                connect(p, w);
+                id = wireId(w);
+                if (output) {
+                    drivers[id].push_back(g);
+                    for (auto r : fanout[id]) seeds.push_back(r);
+                } else {
+                    fanout[id].push_back(g);
+                }
+            }
+            (output ? gates[g].outputs : gates[g].inputs)[slot] = id;
+            if (!levelized) return;
+            auto affected = relevel(seeds);
+            affected.insert(affected.end(), upstream.begin(), upstream.end());
+            notify(affected);
+        }
+        void disconnectPin(Pin* p) {
+            connectPin(p, nullptr);
+        }
+        // a gate's function or config changed; compiled forms of it and its readers are stale
+        void gateChanged(BasicGate* g) {
+            unsigned int id = gateIndex(g);
+            if (id == NO_INDEX) return;
+            gates[id].function = g->getLogicFunction();
+            vector<unsigned int> affected{id};
+            for (auto w : gates[id].outputs) {
+                if (w == NO_INDEX) continue;
+                for (auto r : fanout[w]) affected.push_back(r);
+            }
+            notify(affected);
+        }
+        // f(instance, affected gate indices) runs after every edit
+        void onChange(void (*f)(void*, const vector<unsigned int>&), void* instance) {
+            listeners.push_back(std::make_tuple(f, instance));
+        }
+        void removeListener(void* instance) {
+            listeners.erase(std::remove_if(listeners.begin(), listeners.end(),
+                [instance](const std::tuple<void (*)(void*, const vector<unsigned int>&), void*>& l) { return std::get<1>(l) == instance; }),
+                listeners.end());
+        }
+        void addObjects() {
+            for (auto obj : live_objects()) {
+                auto g = dynamic_cast<BasicGate*>(obj);
+                if (g != nullptr) addGate(g);
+            }
+        }
+        // Kahn's algorithm; gates on a feedback loop end up in getCyclic()
+        void levelize() {
+            order.clear();
+            cyclic.clear();
+            max_level = 0;
+            levelized = true;
+            order_dirty = false;
+            vector<unsigned int> pending(gates.size(), 0);
+            for (unsigned int g = 0; g < gates.size(); g++) {
+                gates[g].level = 0;
+                if (gates[g].gate == nullptr) continue;
+                for (auto w : gates[g].inputs) {
+                    if (w == NO_INDEX) continue;
+                    for (auto d : drivers[w]) {
+                        if (d != g) pending[g]++;
+                    }
+                }
+                if (pending[g] == 0) order.push_back(g);
+            }
+            for (size_t i = 0; i < order.size(); i++) {
+                unsigned int g = order[i];
+                for (auto w : gates[g].outputs) {
+                    if (w == NO_INDEX) continue;
+                    for (auto r : fanout[w]) {
+                        if (r == g) continue;
+                        gates[r].level = std::max(gates[r].level, gates[g].level + 1);
+                        max_level = std::max(max_level, gates[r].level);
+                        if (--pending[r] == 0) order.push_back(r);
+                    }
+                }
+            }
+            for (unsigned int g = 0; g < gates.size(); g++) {
+                if (pending[g] != 0) cyclic.push_back(g);
+            }
+        }
+        // counting sort by level; only needed after incremental edits
+        void rebuildOrder() {
+            vector<unsigned int> count(max_level + 2, 0);
+            for (unsigned int g = 0; g < gates.size(); g++) {
+                if (gates[g].gate != nullptr) count[gates[g].level + 1]++;
+            }
+            for (size_t l = 1; l < count.size(); l++) count[l] += count[l - 1];
+            order.assign(count.back(), 0);
+            for (unsigned int g = 0; g < gates.size(); g++) {
+                if (gates[g].gate != nullptr) order[count[gates[g].level]++] = g;
+            }
+            for (auto g : cyclic) {
+                order.erase(std::remove(order.begin(), order.end(), g), order.end());
+            }
+            order_dirty = false;
+        }
+        // Tarjan's SCC over combinational gates (sequential gates break loops).
+        // Returns every component of two or more gates, or a gate feeding itself.
+        vector<vector<unsigned int>> combinationalLoops() {
+            unsigned int n = (unsigned int)gates.size();
+            auto live = [this](unsigned int g) {
+                return gates[g].gate != nullptr && !gates[g].gate->isSequential();
+            };
+            vector<vector<unsigned int>> succ(n);
+            vector<bool> self(n, false);
+            for (unsigned int g = 0; g < n; g++) {
+                if (!live(g)) continue;
+                for (auto w : gates[g].outputs) {
+                    if (w == NO_INDEX) continue;
+                    for (auto r : fanout[w]) {
+                        if (!live(r)) continue;
+                        if (r == g) self[g] = true;
+                        else succ[g].push_back(r);
+                    }
+                }
+            }
+            vector<unsigned int> index(n, NO_INDEX), low(n, 0);
+            vector<bool> on_stack(n, false);
+            vector<unsigned int> stack;
+            vector<std::pair<unsigned int, size_t>> dfs;
+            vector<vector<unsigned int>> ret;
+            unsigned int counter = 0;
+            for (unsigned int s = 0; s < n; s++) {
+                if (!live(s) || index[s] != NO_INDEX) continue;
+                dfs.push_back({s, 0});
+                index[s] = low[s] = counter++;
+                stack.push_back(s);
+                on_stack[s] = true;
+                while (!dfs.empty()) {
+                    unsigned int u = dfs.back().first;
+                    size_t& e = dfs.back().second;
+                    if (e < succ[u].size()) {
+                        unsigned int v = succ[u][e++];
+                        if (index[v] == NO_INDEX) {
+                            index[v] = low[v] = counter++;
+                            stack.push_back(v);
+                            on_stack[v] = true;
+                            dfs.push_back({v, 0});
+                        } else if (on_stack[v]) {
+                            low[u] = std::min(low[u], index[v]);
+                        }
+                        continue;
+                    }
+                    dfs.pop_back();
+                    if (!dfs.empty()) {
+                        unsigned int p = dfs.back().first;
+                        low[p] = std::min(low[p], low[u]);
+                    }
+                    if (low[u] != index[u]) continue;
+                    vector<unsigned int> comp;
+                    unsigned int v;
+                    do {
+                        v = stack.back();
+                        stack.pop_back();
+                        on_stack[v] = false;
+                        comp.push_back(v);
+                    } while (v != u);
+                    if (comp.size() > 1 || self[u]) ret.push_back(std::move(comp));
+                }
+            }
+            return ret;
+        }
+        // records one COMBINATIONAL_LOOP diagnostic per component, against its first gate
+        vector<vector<unsigned int>> reportLoops() {
+            auto loops = combinationalLoops();
+            for (auto& comp : loops) {
+                if (diagnostics.report(DiagnosticCode::COMBINATIONAL_LOOP, gates[comp[0]].gate))
+                    throw LogicSimException("Combinational loop of " + to_string((unsigned long long)comp.size()) + " gates", gates[comp[0]].gate);
+            }
+            return loops;
+        }
+        vector<Wire*>& getWires() {
+            return wires;
+        }
+        vector<NetlistGate>& getGates() {
+            return gates;
+        }
+        const vector<unsigned int>& getOrder() {
+            if (order_dirty) rebuildOrder();
+            return order;
+        }
+        const vector<unsigned int>& getCyclic() {
+            return cyclic;
+        }
+        const vector<unsigned int>& getFanout(unsigned int wire) {
+            return fanout[wire];
+        }
+        const vector<unsigned int>& getDrivers(unsigned int wire) {
+            return drivers[wire];
+        }
+        unsigned int getMaxLevel() {
+            return max_level;
+        }
+        unsigned int wireIndex(Wire* w) {
+            auto it = wire_ids.find(w);
+            return it == wire_ids.end() ? NO_INDEX : it->second;
+        }
+        unsigned int gateIndex(BasicGate* g) {
+            auto it = gate_ids.find(g);
+            return it == gate_ids.end() ? NO_INDEX : it->second;
+        }
+        vector<unsigned int> primaryInputs() {
+            vector<unsigned int> ret;
+            for (unsigned int w = 0; w < wires.size(); w++) {
+                if (drivers[w].empty()) ret.push_back(w);
+            }
+            return ret;
+        }
+        vector<unsigned int> primaryOutputs() {
+            vector<unsigned int> ret;
+            for (unsigned int w = 0; w < wires.size(); w++) {
+                if (fanout[w].empty() && !drivers[w].empty()) ret.push_back(w);
+            }
+            return ret;
+        }
+    };
+};
@@ -0,0 +1,330 @@
+#pragma once
+
+#include <vector>
+#include <tuple>
+#include <algorithm>
+
+#include "main_init.hpp"
+#include "netlist.hpp"
+
+namespace LogicSim {
+    // undirected weighted graph in CSR form
+    struct PartitionGraph {
+        vector<unsigned int> xadj;
+        vector<unsigned int> adjncy;
+        vector<unsigned int> adjwgt;
+        vector<unsigned int> vwgt;
+        unsigned int size() const {
+            return (unsigned int)vwgt.size();
+        }
+        unsigned long long totalWeight() const {
+            unsigned long long t = 0;
+            for (auto w : vwgt) t += w;
+            return t;
+        }
+    };
+
+    // Multilevel recursive bisection: heavy-edge matching to coarsen, greedy
+    // graph growing for the initial cut, boundary refinement on the way back up.
+    class GraphPartitioner final {
+        static constexpr unsigned int coarsen_to = 64;
+        static constexpr unsigned int refine_passes = 8;
+        double imbalance = 0.03;
+        unsigned long long seed = 0x9E3779B97F4A7C15ULL;
+
+        unsigned long long nextRandom() {
+            seed ^= seed << 13;
+            seed ^= seed >> 7;
+            seed ^= seed << 17;
+            return seed;
+        }
+        static PartitionGraph fromEdges(unsigned int n, vector<std::tuple<unsigned int, unsigned int, unsigned int>>& edges, vector<unsigned int> vwgt) {
+            std::sort(edges.begin(), edges.end());
+            PartitionGraph g;
+            g.vwgt = std::move(vwgt);
+            g.xadj.assign(n + 1, 0);
+            for (size_t i = 0; i < edges.size(); i++) {
+                auto [u, v, w] = edges[i];
+                if (!g.adjncy.empty() && i > 0 && std::get<0>(edges[i - 1]) == u && std::get<1>(edges[i - 1]) == v) {
+                    g.adjwgt.back() += w;
+                    continue;
+                }
+                g.adjncy.push_back(v);
+                g.adjwgt.push_back(w);
+                g.xadj[u + 1]++;
+            }
+            for (unsigned int i = 0; i < n; i++) g.xadj[i + 1] += g.xadj[i];
+            return g;
+        }
+        PartitionGraph coarsen(const PartitionGraph& g, vector<unsigned int>& cmap) {
+            unsigned int n = g.size();
+            vector<unsigned int> perm(n);
+            for (unsigned int i = 0; i < n; i++) perm[i] = i;
+            for (unsigned int i = n; i > 1; i--) std::swap(perm[i - 1], perm[nextRandom() % i]);
+            vector<unsigned int> match(n, NO_INDEX);
+            for (auto u : perm) {
+                if (match[u] != NO_INDEX) continue;
+                unsigned int best = u, best_w = 0;
+                for (unsigned int e = g.xadj[u]; e < g.xadj[u + 1]; e++) {
+                    unsigned int v = g.adjncy[e];
+                    if (match[v] == NO_INDEX && v != u && g.adjwgt[e] > best_w) {
+                        best = v;
+                        best_w = g.adjwgt[e];
+                    }
+                }
+                match[u] = best;
+                match[best] = u;
+            }
+            cmap.assign(n, NO_INDEX);
+            unsigned int cn = 0;
+            for (unsigned int u = 0; u < n; u++) {
+                if (cmap[u] != NO_INDEX) continue;
+                cmap[u] = cn;
+                cmap[match[u]] = cn;
+                cn++;
+            }
+            vector<unsigned int> cvwgt(cn, 0);
+            for (unsigned int u = 0; u < n; u++) cvwgt[cmap[u]] += g.vwgt[u];
+            vector<std::tuple<unsigned int, unsigned int, unsigned int>> edges;
+            edges.reserve(g.adjncy.size());
+            for (unsigned int u = 0; u < n; u++) {
+                for (unsigned int e = g.xadj[u]; e < g.xadj[u + 1]; e++) {
+                    unsigned int a = cmap[u], b = cmap[g.adjncy[e]];
+                    if (a != b) edges.emplace_back(a, b, g.adjwgt[e]);
+                }
+            }
+            return fromEdges(cn, edges, std::move(cvwgt));
+        }
+        static unsigned long long cut(const PartitionGraph& g, const vector<unsigned char>& side) {
+            unsigned long long c = 0;
+            for (unsigned int u = 0; u < g.size(); u++) {
+                for (unsigned int e = g.xadj[u]; e < g.xadj[u + 1]; e++) {
+                    if (side[u] != side[g.adjncy[e]]) c += g.adjwgt[e];
+                }
+            }
+            return c / 2;
+        }
+        vector<unsigned char> grow(const PartitionGraph& g, unsigned long long target0, unsigned int start) {
+            unsigned int n = g.size();
+            vector<unsigned char> side(n, 1);
+            vector<long long> gain(n, 0);
+            vector<unsigned char> queued(n, 0);
+            vector<unsigned int> frontier;
+            unsigned long long w0 = 0;
+            frontier.push_back(start);
+            queued[start] = 1;
+            while (w0 < target0) {
+                if (frontier.empty()) {
+                    unsigned int next = NO_INDEX;
+                    for (unsigned int u = 0; u < n; u++) {
+                        if (side[u] == 1) {
+                            next = u;
+                            break;
+                        }
+                    }
+                    if (next == NO_INDEX) break;
+                    frontier.push_back(next);
+                    queued[next] = 1;
+                }
+                size_t best = 0;
+                for (size_t i = 1; i < frontier.size(); i++) {
+                    if (gain[frontier[i]] > gain[frontier[best]]) best = i;
+                }
+                unsigned int u = frontier[best];
+                frontier[best] = frontier.back();
+                frontier.pop_back();
+                side[u] = 0;
+                w0 += g.vwgt[u];
+                for (unsigned int e = g.xadj[u]; e < g.xadj[u + 1]; e++) {
+                    unsigned int v = g.adjncy[e];
+                    if (side[v] == 0) continue;
+                    gain[v] += 2 * (long long)g.adjwgt[e];
+                    if (!queued[v]) {
+                        queued[v] = 1;
+                        frontier.push_back(v);
+                    }
+                }
+            }
+            return side;
+        }
+        void refine(const PartitionGraph& g, vector<unsigned char>& side, unsigned long long target0) {
+            unsigned int n = g.size();
+            unsigned long long total = g.totalWeight();
+            unsigned long long slack = (unsigned long long)(imbalance * (double)total) + 1;
+            unsigned long long w0 = 0;
+            for (unsigned int u = 0; u < n; u++) if (side[u] == 0) w0 += g.vwgt[u];
+            for (unsigned int pass = 0; pass < refine_passes; pass++) {
+                bool moved = false;
+                for (unsigned int u = 0; u < n; u++) {
+                    long long ext = 0, in = 0;
+                    for (unsigned int e = g.xadj[u]; e < g.xadj[u + 1]; e++) {
+                        if (side[g.adjncy[e]] == side[u]) in += g.adjwgt[e];
+                        else ext += g.adjwgt[e];
+                    }
+                    if (ext <= in) continue;
+                    unsigned long long nw0 = side[u] == 0 ? w0 - g.vwgt[u] : w0 + g.vwgt[u];
+                    unsigned long long dist = nw0 > target0 ? nw0 - target0 : target0 - nw0;
+                    if (dist > slack) continue;
+                    side[u] ^= 1;
+                    w0 = nw0;
+                    moved = true;
+                }
+                if (!moved) break;
+            }
+        }
+        vector<unsigned char> bisect(const PartitionGraph& g, unsigned long long target0) {
+            if (g.size() <= coarsen_to) {
+                vector<unsigned char> best;
+                unsigned long long best_cut = ~0ULL;
+                for (unsigned int t = 0; t < 4 && t < g.size(); t++) {
+                    auto side = grow(g, target0, (unsigned int)(nextRandom() % g.size()));
+                    refine(g, side, target0);
+                    unsigned long long c = cut(g, side);
+                    if (c < best_cut) {
+                        best_cut = c;
+                        best = side;
+                    }
+                }
+                return best;
+            }
+            vector<unsigned int> cmap;
+            PartitionGraph coarse = coarsen(g, cmap);
+            vector<unsigned char> side(g.size());
+            if (coarse.size() * 10 > g.size() * 9) {
+                side = grow(g, target0, (unsigned int)(nextRandom() % g.size()));
+            } else {
+                auto cside = bisect(coarse, target0);
+                for (unsigned int u = 0; u < g.size(); u++) side[u] = cside[cmap[u]];
+            }
+            refine(g, side, target0);
+            return side;
+        }
+        static PartitionGraph subgraph(const PartitionGraph& g, const vector<unsigned int>& nodes, vector<unsigned int>& local) {
+            for (unsigned int i = 0; i < nodes.size(); i++) local[nodes[i]] = i;
+            vector<unsigned int> vw;
+            vector<std::tuple<unsigned int, unsigned int, unsigned int>> edges;
+            for (unsigned int i = 0; i < nodes.size(); i++) {
+                unsigned int u = nodes[i];
+                vw.push_back(g.vwgt[u]);
+                for (unsigned int e = g.xadj[u]; e < g.xadj[u + 1]; e++) {
+                    unsigned int v = local[g.adjncy[e]];
+                    if (v != NO_INDEX) edges.emplace_back(i, v, g.adjwgt[e]);
+                }
+            }
+            for (auto u : nodes) local[u] = NO_INDEX;
+            return fromEdges((unsigned int)nodes.size(), edges, std::move(vw));
+        }
+        void split(const PartitionGraph& g, const vector<unsigned int>& nodes, unsigned int k, unsigned int first,
+                   vector<unsigned int>& part, vector<unsigned int>& local) {
+            if (k <= 1 || nodes.size() <= 1) {
+                for (auto u : nodes) part[u] = first;
+                return;
+            }
+            PartitionGraph sub = subgraph(g, nodes, local);
+            unsigned int k0 = k / 2;
+            auto side = bisect(sub, sub.totalWeight() * k0 / k);
+            vector<unsigned int> a, b;
+            for (unsigned int i = 0; i < nodes.size(); i++) (side[i] == 0 ? a : b).push_back(nodes[i]);
+            split(g, a, k0, first, part, local);
+            split(g, b, k - k0, first + k0, part, local);
+        }
+    public:
+        void setImbalance(double v) {
+            imbalance = v;
+        }
+        void setSeed(unsigned long long s) {
+            seed = s != 0 ? s : 1;
+        }
+        // gates become vertices; a wire links its drivers to each of its readers
+        static PartitionGraph fromNetlist(Netlist& netlist) {
+            unsigned int n = (unsigned int)netlist.getGates().size();
+            vector<std::tuple<unsigned int, unsigned int, unsigned int>> edges;
+            for (unsigned int w = 0; w < netlist.getWires().size(); w++) {
+                auto& readers = netlist.getFanout(w);
+                auto& drivers = netlist.getDrivers(w);
+                if (drivers.empty()) {
+                    for (size_t i = 1; i < readers.size(); i++) {
+                        edges.emplace_back(readers[i - 1], readers[i], 1);
+                        edges.emplace_back(readers[i], readers[i - 1], 1);
+                    }
+                    continue;
+                }
+                for (auto d : drivers) {
+                    for (auto r : readers) {
+                        if (r == d) continue;
+                        edges.emplace_back(d, r, 1);
+                        edges.emplace_back(r, d, 1);
+                    }
+                }
+            }
+            return fromEdges(n, edges, vector<unsigned int>(n, 1));
+        }
+        vector<unsigned int> partition(const PartitionGraph& g, unsigned int k) {
+            vector<unsigned int> part(g.size(), 0);
+            vector<unsigned int> nodes(g.size());
+            for (unsigned int i = 0; i < g.size(); i++) nodes[i] = i;
+            vector<unsigned int> local(g.size(), NO_INDEX);
+            split(g, nodes, k, 0, part, local);
+            return part;
+        }
+    };
+
+    // Gate and wire assignment for k shards from a min-cut partition. A wire
+    // belongs to the shard of its first driver (or first reader) and is cut
+    // when a reader sits in another shard; those are the values that have to
+    // move between shards each step.
+    class ShardPlan final : public LogicSimObject {
+        unsigned int count;
+        vector<unsigned int> gate_shard;
+        vector<unsigned int> wire_shard;
+        vector<unsigned int> cut_wires;
+        vector<vector<unsigned int>> shard_gates;
+        vector<vector<unsigned int>> shard_wires;
+    public:
+        virtual const char* getObjectType() {
+            return "ShardPlan";
+        }
+        ShardPlan(Netlist& netlist, unsigned int count, GraphPartitioner partitioner = GraphPartitioner()) : count(count == 0 ? 1 : count) {
+            gate_shard = partitioner.partition(GraphPartitioner::fromNetlist(netlist), this->count);
+            shard_gates.resize(this->count);
+            shard_wires.resize(this->count);
+            auto& gates = netlist.getGates();
+            for (unsigned int g = 0; g < gate_shard.size(); g++) {
+                if (gates[g].gate != nullptr) shard_gates[gate_shard[g]].push_back(g);
+            }
+            unsigned int nw = (unsigned int)netlist.getWires().size();
+            wire_shard.assign(nw, 0);
+            for (unsigned int w = 0; w < nw; w++) {
+                auto& drivers = netlist.getDrivers(w);
+                auto& readers = netlist.getFanout(w);
+                unsigned int owner = !drivers.empty() ? gate_shard[drivers[0]] : (!readers.empty() ? gate_shard[readers[0]] : 0);
+                wire_shard[w] = owner;
+                shard_wires[owner].push_back(w);
+                for (auto r : readers) {
+                    if (gate_shard[r] != owner) {
+                        cut_wires.push_back(w);
+                        break;
+                    }
+                }
+            }
+        }
+        unsigned int getShardCount() {
+            return count;
+        }
+        unsigned int shardOfGate(unsigned int gate) {
+            return gate_shard[gate];
+        }
+        unsigned int shardOfWire(unsigned int wire) {
+            return wire_shard[wire];
+        }
+        const vector<unsigned int>& getCutWires() {
+            return cut_wires;
+        }
+        const vector<unsigned int>& getGates(unsigned int shard) {
+            return shard_gates[shard];
+        }
+        const vector<unsigned int>& getWires(unsigned int shard) {
+            return shard_wires[shard];
+        }
+    };
+};
@@ -0,0 +1,360 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "main_init.hpp"
+
+namespace LogicSim {
+    inline unsigned long long splitmix64(unsigned long long& x) {
+        unsigned long long z = (x += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+    // high and low words of the 128-bit product a * b
+    inline unsigned long long mulhi64_portable(unsigned long long a, unsigned long long b, unsigned long long& low) {
+        unsigned long long al = a & 0xFFFFFFFFULL, ah = a >> 32;
+        unsigned long long bl = b & 0xFFFFFFFFULL, bh = b >> 32;
+        unsigned long long ll = al * bl, lh = al * bh, hl = ah * bl, hh = ah * bh;
+        unsigned long long mid = (ll >> 32) + (lh & 0xFFFFFFFFULL) + (hl & 0xFFFFFFFFULL);
+        low = (mid << 32) | (ll & 0xFFFFFFFFULL);
+        return hh + (lh >> 32) + (hl >> 32) + (mid >> 32);
+    }
+    inline unsigned long long mulhi64(unsigned long long a, unsigned long long b, unsigned long long& low) {
+#ifdef __SIZEOF_INT128__
+        unsigned __int128 m = (unsigned __int128)a * b;
+        low = (unsigned long long)m;
+        return (unsigned long long)(m >> 64);
+#else
+        return mulhi64_portable(a, b, low);
+#endif
+    }
+
+    // xoshiro256++ run as LANES independent generators kept structure-of-
+    // arrays, so one block is a plain loop of adds, shifts, rotates and xors
+    // that the compiler turns into SIMD. Each lane is seeded through
+    // splitmix64 from (seed, stream, lane); equal seeds and stream numbers
+    // always give the same sequence regardless of thread or timing.
+    //
+    // Not a LogicSimObject: streams are created lazily on worker threads,
+    // where registering in the global object list would race.
+    class RandomStream final {
+    public:
+        static constexpr unsigned int LANES = 8;
+    private:
+        alignas(64) unsigned long long s0[LANES];
+        alignas(64) unsigned long long s1[LANES];
+        alignas(64) unsigned long long s2[LANES];
+        alignas(64) unsigned long long s3[LANES];
+        alignas(64) unsigned long long block[LANES];
+        unsigned int used = LANES;
+        unsigned long long seed = 0;
+        unsigned long long stream = 0;
+
+        static inline unsigned long long rotl(unsigned long long x, int k) {
+            return (x << k) | (x >> (64 - k));
+        }
+        void generate(unsigned long long* out) {
+            for (unsigned int l = 0; l < LANES; l++) {
+                out[l] = rotl(s0[l] + s3[l], 23) + s0[l];
+                unsigned long long t = s1[l] << 17;
+                s2[l] ^= s0[l];
+                s3[l] ^= s1[l];
+                s1[l] ^= s2[l];
+                s0[l] ^= s3[l];
+                s2[l] ^= t;
+                s3[l] = rotl(s3[l], 45);
+            }
+        }
+    public:
+        RandomStream(unsigned long long seed = 0, unsigned long long stream = 0) {
+            reseed(seed, stream);
+        }
+        void reseed(unsigned long long seed, unsigned long long stream = 0) {
+            this->seed = seed;
+            this->stream = stream;
+            unsigned long long base = seed;
+            unsigned long long salt = splitmix64(base) ^ (stream * 0xD1B54A32D192ED03ULL);
+            for (unsigned int l = 0; l < LANES; l++) {
+                unsigned long long x = salt + l * 0x632BE59BD9B4E019ULL;
+                s0[l] = splitmix64(x);
+                s1[l] = splitmix64(x);
+                s2[l] = splitmix64(x);
+                s3[l] = splitmix64(x);
+            }
+            used = LANES;
+        }
+        unsigned long long getSeed() {
+            return seed;
+        }
+        unsigned long long getStream() {
+            return stream;
+        }
+        unsigned long long next() {
+            if (used == LANES) {
+                generate(block);
+                used = 0;
+            }
+            return block[used++];
+        }
+        // bulk output; whole blocks are written straight into out
+        void fill(unsigned long long* out, size_t n) {
+            size_t i = 0;
+            while (i < n && used != LANES) out[i++] = block[used++];
+            for (; i + LANES <= n; i += LANES) generate(out + i);
+            while (i < n) out[i++] = next();
+        }
+
+        // constrained helpers
+        unsigned long long bits(unsigned short width) {
+            unsigned long long v = next();
+            return width >= 64 ? v : v & ((1ULL << width) - 1);
+        }
+        bool bit() {
+            return next() >> 63;
+        }
+        // unbiased value in [0, bound)
+        unsigned long long below(unsigned long long bound) {
+            if (bound == 0) return next();
+            unsigned long long low;
+            unsigned long long high = mulhi64(next(), bound, low);
+            if (low < bound) {
+                unsigned long long threshold = (0 - bound) % bound;
+                while (low < threshold) high = mulhi64(next(), bound, low);
+            }
+            return high;
+        }
+        // inclusive
+        unsigned long long range(unsigned long long low, unsigned long long high) {
+            if (high - low == ~0ULL) return next();
+            return low + below(high - low + 1);
+        }
+        double uniform() {
+            return (double)(next() >> 11) * 0x1.0p-53;
+        }
+        bool chance(double p) {
+            return uniform() < p;
+        }
+        // free bits where mask is set, the rest from fixed
+        unsigned long long masked(unsigned long long mask, unsigned long long fixed) {
+            return (next() & mask) | (fixed & ~mask);
+        }
+        // widths past one word pick a bit of the word
+        unsigned long long onehot(unsigned short width) {
+            if (width > 64) width = 64;
+            return width == 0 ? 0 : 1ULL << below(width);
+        }
+        // every bit is 1 with probability p, in steps of 1/65536: one word
+        // per bit of p, combined from the least significant bit up
+        unsigned long long biased(double p) {
+            if (p <= 0) return 0;
+            if (p >= 1) return ~0ULL;
+            unsigned int q = (unsigned int)(p * 65536.0 + 0.5);
+            if (q == 0) return 0;
+            if (q >= 65536) return ~0ULL;
+            unsigned int low = count_trailing_zeros(q);
+            unsigned long long v = next();
+            for (unsigned int b = low + 1; b < 16; b++) {
+                v = (q >> b) & 1 ? v | next() : v & next();
+            }
+            return v;
+        }
+        // index picked with probability weights[i] / sum
+        size_t weighted(const vector<unsigned long long>& weights) {
+            unsigned long long total = 0;
+            for (auto w : weights) total += w;
+            if (total == 0) return 0;
+            unsigned long long r = below(total);
+            for (size_t i = 0; i < weights.size(); i++) {
+                if (r < weights[i]) return i;
+                r -= weights[i];
+            }
+            return weights.size() - 1;
+        }
+    };
+
+    // Streams for worker threads. Every thread gets stream number
+    // thread_index of the global seed; threads that call local() without
+    // an index are numbered in first-use order, which is only reproducible
+    // when the thread start order is. setSeed() restarts every thread's
+    // stream on its next use. The seed and its generation change together
+    // under seed_mtx, so a reseed never pairs a new generation with the
+    // previous seed.
+    namespace Random {
+        inline std::mutex seed_mtx;
+        inline unsigned long long global_seed = 0x5EED;
+        inline std::atomic<unsigned long long> generation{1};
+        inline std::atomic<unsigned int> next_thread{0};
+        inline thread_local unique_ptr<RandomStream> thread_stream;
+        inline thread_local unsigned long long thread_generation = 0;
+        inline thread_local unsigned int thread_number = 0;
+
+        inline void setSeed(unsigned long long seed) {
+            std::lock_guard<std::mutex> lock(seed_mtx);
+            global_seed = seed;
+            generation++;
+        }
+        inline unsigned long long getSeed() {
+            std::lock_guard<std::mutex> lock(seed_mtx);
+            return global_seed;
+        }
+        inline void restart(RandomStream& stream, unsigned int index) {
+            std::lock_guard<std::mutex> lock(seed_mtx);
+            thread_generation = generation;
+            stream.reseed(global_seed, index);
+        }
+        // restarts the stream only when the index or the seed changed
+        inline RandomStream& local(unsigned int thread_index) {
+            if (thread_stream && thread_number == thread_index && thread_generation == generation) return *thread_stream;
+            if (!thread_stream) thread_stream.reset(new RandomStream());
+            thread_number = thread_index;
+            restart(*thread_stream, thread_index);
+            return *thread_stream;
+        }
+        inline RandomStream& local() {
+            if (thread_generation == generation) return *thread_stream;
+            if (!thread_stream) {
+                thread_stream.reset(new RandomStream());
+                thread_number = next_thread++;
+            }
+            restart(*thread_stream, thread_number);
+            return *thread_stream;
+        }
+    };
+
+    enum class RandomKind {
+        UNIFORM,
+        RANGE,
+        MASKED,
+        ONEHOT,
+        BIASED
+    };
+    struct RandomConstraint {
+        RandomKind kind = RandomKind::UNIFORM;
+        unsigned long long low = 0;
+        unsigned long long high = 0;
+        unsigned long long mask = ~0ULL;
+        unsigned long long fixed = 0;
+        double p = 0.5;
+
+        static RandomConstraint uniform() {
+            return RandomConstraint();
+        }
+        static RandomConstraint range(unsigned long long low, unsigned long long high) {
+            RandomConstraint c;
+            c.kind = RandomKind::RANGE;
+            c.low = low;
+            c.high = high;
+            return c;
+        }
+        static RandomConstraint masked(unsigned long long mask, unsigned long long fixed) {
+            RandomConstraint c;
+            c.kind = RandomKind::MASKED;
+            c.mask = mask;
+            c.fixed = fixed;
+            return c;
+        }
+        static RandomConstraint onehot() {
+            RandomConstraint c;
+            c.kind = RandomKind::ONEHOT;
+            return c;
+        }
+        // each bit 1 with probability p
+        static RandomConstraint biased(double p) {
+            RandomConstraint c;
+            c.kind = RandomKind::BIASED;
+            c.p = p;
+            return c;
+        }
+    };
+
+    // Drives random values onto a set of wires, one constrained bus per
+    // wire. apply() draws one bulk block for every bus and settles all of
+    // the writes together; the stream is owned, so a given seed and stream
+    // number reproduce the same stimulus sequence.
+    class RandomStimulus final : public LogicSimObject {
+        class BusDriver final : public BasicGate {
+        protected:
+            virtual void update() override {};
+        public:
+            BusDriver() : BasicGate(0, 1) {};
+            virtual const char* getObjectType() override {
+                return "RandomStimulus::BusDriver";
+            }
+            void drive(WireStateValue v) {
+                write_pin(0, v);
+            }
+        };
+        struct Bus {
+            unsigned short bits;
+            RandomConstraint constraint;
+        };
+        RandomStream stream;
+        vector<unique_ptr<BusDriver>> drivers;
+        vector<Bus> buses;
+        vector<unsigned long long> raw;
+        vector<unsigned long long> values;
+        unsigned long long applied = 0;
+
+        unsigned long long shape(const Bus& b, unsigned long long r) {
+            unsigned long long mask = b.bits >= 64 ? ~0ULL : (1ULL << b.bits) - 1;
+            switch (b.constraint.kind) {
+            case RandomKind::UNIFORM:
+                return r & mask;
+            case RandomKind::RANGE:
+                return stream.range(b.constraint.low, b.constraint.high) & mask;
+            case RandomKind::MASKED:
+                return ((r & b.constraint.mask) | (b.constraint.fixed & ~b.constraint.mask)) & mask;
+            case RandomKind::ONEHOT:
+                return stream.onehot(b.bits);
+            case RandomKind::BIASED:
+                return stream.biased(b.constraint.p) & mask;
+            }
+            return r & mask;
+        }
+    public:
+        virtual const char* getObjectType() {
+            return "RandomStimulus";
+        }
+        RandomStimulus(unsigned long long seed, unsigned long long stream_id = 0) : stream(seed, stream_id) {};
+        RandomStimulus(const RandomStimulus&) = delete;
+        RandomStimulus& operator=(const RandomStimulus&) = delete;
+        // the stimulus becomes the driver of w; 1-bit buses are driven as BIT
+        unsigned int addBus(Wire* w, unsigned short bits = 1, RandomConstraint c = RandomConstraint()) {
+            drivers.emplace_back(new BusDriver());
+            connect(drivers.back()->getPin(0), w);
+            buses.push_back({bits, c});
+            values.push_back(0);
+            return (unsigned int)(buses.size() - 1);
+        }
+        void setConstraint(unsigned int bus, RandomConstraint c) {
+            buses[bus].constraint = c;
+        }
+        void apply() {
+            size_t n = buses.size();
+            raw.resize(n);
+            stream.fill(raw.data(), n);
+            for (size_t i = 0; i < n; i++) values[i] = shape(buses[i], raw[i]);
+            bool was = BasicGate::beginUpdate();
+            for (size_t i = 0; i < n; i++) {
+                if (buses[i].bits == 1) drivers[i]->drive(WireStateValue((bool)(values[i] & 1)));
+                else drivers[i]->drive(WireStateValue(values[i]));
+            }
+            BasicGate::endUpdate(was);
+            applied++;
+        }
+        // the value last driven onto a bus
+        unsigned long long getValue(unsigned int bus) {
+            return values[bus];
+        }
+        unsigned long long getApplied() {
+            return applied;
+        }
+        RandomStream& getStream() {
+            return stream;
+        }
+    };
+};
@@ -0,0 +1,294 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <vector>
+
+#include "main_init.hpp"
+#include "mainsim.hpp"
+#include "watchpoints.hpp"
+#include "Thread.hpp"
+
+namespace LogicSim {
+    struct RealtimeMessage {
+        unsigned int port;
+        unsigned long long value;
+        // steady clock nanoseconds when the stimulus was posted
+        unsigned long long stamp;
+    };
+
+    // Single-producer single-consumer ring; head and tail sit on their own
+    // cache lines so the two sides never share a line.
+    template <typename T>
+    class SpscRing final {
+        alignas(64) std::atomic<unsigned long long> head{0};
+        alignas(64) std::atomic<unsigned long long> tail{0};
+        alignas(64) unsigned long long mask;
+        vector<T> ring;
+    public:
+        SpscRing(size_t capacity) {
+            size_t n = 1;
+            while (n < capacity) n <<= 1;
+            mask = n - 1;
+            ring.resize(n);
+        }
+        bool push(const T& v) {
+            unsigned long long t = tail.load(std::memory_order_relaxed);
+            if (t - head.load(std::memory_order_acquire) > mask) return false;
+            ring[t & mask] = v;
+            tail.store(t + 1, std::memory_order_release);
+            return true;
+        }
+        bool pop(T& v) {
+            unsigned long long h = head.load(std::memory_order_relaxed);
+            if (h == tail.load(std::memory_order_acquire)) return false;
+            v = ring[h & mask];
+            head.store(h + 1, std::memory_order_release);
+            return true;
+        }
+        bool empty() {
+            return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+        }
+    };
+
+    // Log-linear histogram of nanosecond latencies: exact below 16, then 16
+    // sub-buckets per power of two (about 6% resolution). One writer; other
+    // threads may read while it records.
+    class LatencyHistogram final : public LogicSimObject {
+        static constexpr unsigned int SUB_BITS = 4;
+        static constexpr unsigned int SUB = 1 << SUB_BITS;
+        static constexpr unsigned int BUCKETS = (64 - SUB_BITS + 1) * SUB;
+        std::atomic<unsigned long long> counts[BUCKETS];
+        std::atomic<unsigned long long> total{0};
+        std::atomic<unsigned long long> min_value{~0ULL};
+        std::atomic<unsigned long long> max_value{0};
+
+        static unsigned int bucketOf(unsigned long long v) {
+            if (v < SUB) return (unsigned int)v;
+            unsigned int e = 63 - count_leading_zeros(v);
+            return (e - SUB_BITS + 1) * SUB + (unsigned int)((v >> (e - SUB_BITS)) & (SUB - 1));
+        }
+        static unsigned long long upperOf(unsigned int b) {
+            if (b < SUB) return b;
+            unsigned int e = b / SUB + SUB_BITS - 1;
+            unsigned long long low = (unsigned long long)(SUB + b % SUB) << (e - SUB_BITS);
+            return low + (1ULL << (e - SUB_BITS)) - 1;
+        }
+        static void bump(std::atomic<unsigned long long>& a, unsigned long long by) {
+            a.store(a.load(std::memory_order_relaxed) + by, std::memory_order_relaxed);
+        }
+    public:
+        virtual const char* getObjectType() {
+            return "LatencyHistogram";
+        }
+        LatencyHistogram() {
+            reset();
+        }
+        void record(unsigned long long ns) {
+            bump(counts[bucketOf(ns)], 1);
+            bump(total, 1);
+            if (ns < min_value.load(std::memory_order_relaxed)) min_value.store(ns, std::memory_order_relaxed);
+            if (ns > max_value.load(std::memory_order_relaxed)) max_value.store(ns, std::memory_order_relaxed);
+        }
+        void reset() {
+            for (auto& c : counts) c.store(0, std::memory_order_relaxed);
+            total.store(0, std::memory_order_relaxed);
+            min_value.store(~0ULL, std::memory_order_relaxed);
+            max_value.store(0, std::memory_order_relaxed);
+        }
+        // upper bound of the bucket holding the p-th percentile (0..100)
+        unsigned long long percentile(double p) {
+            unsigned long long n = total.load(std::memory_order_relaxed);
+            if (n == 0) return 0;
+            unsigned long long rank = (unsigned long long)(p / 100.0 * (double)n + 0.5);
+            if (rank < 1) rank = 1;
+            if (rank > n) rank = n;
+            unsigned long long seen = 0;
+            for (unsigned int b = 0; b < BUCKETS; b++) {
+                seen += counts[b].load(std::memory_order_relaxed);
+                if (seen >= rank) {
+                    unsigned long long u = upperOf(b), m = max_value.load(std::memory_order_relaxed);
+                    return u < m ? u : m;
+                }
+            }
+            return max_value.load(std::memory_order_relaxed);
+        }
+        unsigned long long count() {
+            return total.load(std::memory_order_relaxed);
+        }
+        unsigned long long min() {
+            return count() == 0 ? 0 : min_value.load(std::memory_order_relaxed);
+        }
+        unsigned long long max() {
+            return max_value.load(std::memory_order_relaxed);
+        }
+    };
+
+    // Hardware-in-the-loop runner. The simulation lives on one thread that
+    // spins on a lock-free stimulus ring instead of sleeping: stimuli posted
+    // to input ports are applied as one settled batch, the MainSim is then
+    // advanced by the configured step (if any), and changes on output ports
+    // are pushed to a response ring stamped with the oldest stimulus of the
+    // batch. poll() records the stimulus-to-response round trip.
+    //
+    // Ports are bound before start(); while running the MainSim and the
+    // bound wires belong to the runner thread. post() must come from a
+    // single producer thread and poll() from a single consumer thread.
+    class RealtimeRunner final : public LogicSimObject {
+        class InputPort final : public BasicGate {
+            unsigned short bits;
+        protected:
+            virtual void update() override {};
+        public:
+            InputPort(unsigned short bits) : BasicGate(0, 1), bits(bits) {};
+            virtual const char* getObjectType() override {
+                return "RealtimeRunner::InputPort";
+            }
+            void drive(unsigned long long v) {
+                if (bits == 1) write_pin(0, WireStateValue((bool)(v & 1)));
+                else write_pin(0, WireStateValue(v));
+            }
+        };
+        struct OutputPort {
+            RealtimeRunner* runner;
+            unsigned int port;
+            Wire* wire;
+            unsigned int watch;
+        };
+
+        MainSim& sim;
+        SpscRing<RealtimeMessage> stimuli;
+        SpscRing<RealtimeMessage> responses;
+        vector<unique_ptr<InputPort>> input_ports;
+        vector<unique_ptr<OutputPort>> output_ports;
+        Thread thread;
+        std::atomic<bool> running{false};
+        bool pinned = false;
+        SimTime step = 0;
+        unsigned long long batch_stamp = 0;
+        std::atomic<unsigned long long> applied{0};
+        std::atomic<unsigned long long> dropped{0};
+        LatencyHistogram latency;
+
+        static void relax() {
+#if defined(__x86_64__) || defined(__i386__)
+            __builtin_ia32_pause();
+#elif defined(__aarch64__)
+            asm volatile("yield");
+#endif
+        }
+        static void onOutput(void* instance, Wire*, unsigned long long value) {
+            OutputPort* o = (OutputPort*)instance;
+            RealtimeRunner* r = o->runner;
+            if (!r->responses.push({o->port, value, r->batch_stamp}))
+                r->dropped.store(r->dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        }
+        static void loop(void* instance) {
+            ((RealtimeRunner*)instance)->run();
+        }
+        void run() {
+            RealtimeMessage m;
+            unsigned long long n = 0;
+            while (running.load(std::memory_order_relaxed)) {
+                if (!stimuli.pop(m)) {
+                    relax();
+                    continue;
+                }
+                batch_stamp = m.stamp;
+                bool was = BasicGate::beginUpdate();
+                do {
+                    input_ports[m.port]->drive(m.value);
+                    n++;
+                } while (stimuli.pop(m));
+                BasicGate::endUpdate(was);
+                if (step != 0) sim.runFor(step);
+                applied.store(n, std::memory_order_relaxed);
+            }
+        }
+    public:
+        virtual const char* getObjectType() {
+            return "RealtimeRunner";
+        }
+        RealtimeRunner(MainSim& sim, size_t capacity = 4096) : sim(sim), stimuli(capacity), responses(capacity) {};
+        RealtimeRunner(const RealtimeRunner&) = delete;
+        RealtimeRunner& operator=(const RealtimeRunner&) = delete;
+        ~RealtimeRunner() {
+            stop();
+            for (auto& o : output_ports) o->wire->removeWatch(o->watch);
+        }
+        static unsigned long long now() {
+            return (unsigned long long)std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+        }
+        // the runner becomes the driver of w
+        unsigned int bindInput(Wire* w, unsigned short bits = 1) {
+            if (running) throw LogicSimException("Cannot bind ports while the runner is running", this);
+            input_ports.emplace_back(new InputPort(bits));
+            connect(input_ports.back()->getPin(0), w);
+            return (unsigned int)(input_ports.size() - 1);
+        }
+        unsigned int bindOutput(Wire* w) {
+            if (running) throw LogicSimException("Cannot bind ports while the runner is running", this);
+            unsigned int port = (unsigned int)output_ports.size();
+            output_ports.emplace_back(new OutputPort{this, port, w, 0});
+            output_ports.back()->watch = watch_change(w, onOutput, output_ports.back().get());
+            return port;
+        }
+        // simulated time to advance after each applied batch; 0 only settles
+        void setStep(SimTime s) {
+            step = s;
+        }
+        // cpu < 0 leaves placement to the scheduler
+        void start(int cpu = -1) {
+            if (running) return;
+            pinned = false;
+            running = true;
+            if (cpu >= 0) pinned = thread.create(loop, this, cpu);
+            else thread.create(loop, this);
+        }
+        void stop() {
+            if (!running) return;
+            running = false;
+            thread.join();
+        }
+        bool isRunning() {
+            return running;
+        }
+        bool isPinned() {
+            return pinned;
+        }
+        // false if the stimulus ring is full
+        bool post(unsigned int port, unsigned long long value) {
+            if (port >= input_ports.size()) throw LogicSimException("No input port " + to_string(port), this);
+            return stimuli.push({port, value, now()});
+        }
+        bool poll(RealtimeMessage& out) {
+            if (!responses.pop(out)) return false;
+            latency.record(now() - out.stamp);
+            return true;
+        }
+        // spins until a response arrives or timeout_ns passes
+        bool pollWait(RealtimeMessage& out, unsigned long long timeout_ns) {
+            unsigned long long end = now() + timeout_ns;
+            while (!poll(out)) {
+                if (now() >= end) return false;
+                relax();
+            }
+            return true;
+        }
+        unsigned long long latencyPercentile(double p) {
+            return latency.percentile(p);
+        }
+        LatencyHistogram& getLatency() {
+            return latency;
+        }
+        unsigned long long getApplied() {
+            return applied.load(std::memory_order_relaxed);
+        }
+        // responses lost to a full response ring
+        unsigned long long getDropped() {
+            return dropped.load(std::memory_order_relaxed);
+        }
+    };
+};
@@ -0,0 +1,492 @@
+#pragma once
+
+#include <vector>
+#include <queue>
+#include <unordered_map>
+#include <algorithm>
+#include <cmath>
+
+#include "main_init.hpp"
+#include "netlist.hpp"
+
+namespace LogicSim {
+    namespace Exceptions {
+        class SingularNetworkError : public LogicSimException {
+        public:
+            SingularNetworkError(LogicSimObject* obj) :
+                LogicSimException("Resistive network has no unique solution", obj) {};
+        };
+    };
+
+    // Row-wise sparse LU without pivoting. Nodal conductance matrices with a
+    // leak on every diagonal are diagonally dominant, so no pivoting is needed;
+    // fill-in is whatever the given node order produces.
+    class SparseLU final : public LogicSimObject {
+    public:
+        using Row = vector<std::pair<unsigned int, double>>;
+    private:
+        // unit diagonal implied
+        vector<Row> lower;
+        // diagonal entry first
+        vector<Row> upper;
+        vector<double> work;
+        vector<bool> mark;
+        vector<unsigned int> touched;
+    public:
+        virtual const char* getObjectType() {
+            return "SparseLU";
+        }
+        size_t size() {
+            return upper.size();
+        }
+        // repeated columns in a row are summed
+        void factor(const vector<Row>& rows) {
+            size_t n = rows.size();
+            lower.assign(n, Row());
+            upper.assign(n, Row());
+            work.assign(n, 0.0);
+            mark.assign(n, false);
+            for (unsigned int i = 0; i < n; i++) {
+                std::priority_queue<unsigned int, vector<unsigned int>, std::greater<unsigned int>> pending;
+                touched.clear();
+                auto touch = [&](unsigned int j) {
+                    if (mark[j]) return;
+                    mark[j] = true;
+                    touched.push_back(j);
+                    if (j < i) pending.push(j);
+                };
+                touch(i);
+                for (auto& e : rows[i]) {
+                    touch(e.first);
+                    work[e.first] += e.second;
+                }
+                while (!pending.empty()) {
+                    unsigned int k = pending.top();
+                    pending.pop();
+                    double l = work[k] / upper[k][0].second;
+                    lower[i].push_back({k, l});
+                    for (size_t m = 1; m < upper[k].size(); m++) {
+                        touch(upper[k][m].first);
+                        work[upper[k][m].first] -= l * upper[k][m].second;
+                    }
+                }
+                if (std::fabs(work[i]) < 1e-300) throw Exceptions::SingularNetworkError(this);
+                std::sort(touched.begin(), touched.end());
+                upper[i].push_back({i, work[i]});
+                for (auto j : touched) {
+                    if (j > i && work[j] != 0.0) upper[i].push_back({j, work[j]});
+                    work[j] = 0.0;
+                    mark[j] = false;
+                }
+            }
+        }
+        // b is overwritten with the solution
+        void solve(vector<double>& b) {
+            size_t n = upper.size();
+            for (size_t i = 0; i < n; i++) {
+                for (auto& e : lower[i]) b[i] -= e.second * b[e.first];
+            }
+            for (size_t i = n; i-- > 0;) {
+                for (size_t m = 1; m < upper[i].size(); m++) b[i] -= upper[i][m].second * b[upper[i][m].first];
+                b[i] /= upper[i][0].second;
+            }
+        }
+        size_t nonZeros() {
+            size_t n = 0;
+            for (size_t i = 0; i < upper.size(); i++) n += lower[i].size() + upper[i].size();
+            return n;
+        }
+    };
+
+    class ResistiveNetwork;
+
+    // Pins: control, then the two channel terminals. The channel conducts
+    // with the given resistance while control is 1 (0 when active_low); it
+    // drives nothing itself and only couples the two nets in the network.
+    class ResistiveSwitch final : public BasicGate {
+        ResistiveNetwork* network = nullptr;
+        unsigned int id = NO_INDEX;
+        unsigned short resistance;
+        bool active_low;
+        bool conducting = false;
+        friend class ResistiveNetwork;
+    protected:
+        virtual void update() override;
+    public:
+        virtual const char* getObjectType() override {
+            return "ResistiveSwitch";
+        }
+        ResistiveSwitch(unsigned short resistance, bool active_low = false) : BasicGate(1, 0, 2), resistance(resistance), active_low(active_low) {};
+        ResistiveSwitch(const ResistiveSwitch&) = delete;
+        ResistiveSwitch& operator=(const ResistiveSwitch&) = delete;
+        ~ResistiveSwitch();
+        bool isConducting() {
+            return conducting;
+        }
+        unsigned short getResistance() {
+            return resistance;
+        }
+    };
+
+    // Switch-level resolution for the wires added to it. Every driver on
+    // such a wire is a voltage source (its logic level, or the value itself
+    // for FLOAT) behind its resistance, 0 meaning a near-ideal source, and
+    // conducting ResistiveSwitches join nets into components. A change on a
+    // net re-solves only its component: the LU factorization is kept until
+    // that component's driver conductances or its switches change, and a
+    // plain level change on the same drivers is a pair of substitutions.
+    //
+    // Results replace state 0 of each wire: a BIT thresholded at half of
+    // vdd, or the node voltage as FLOAT in analog mode, with the resistance
+    // of the strongest driver in the component. A component without any
+    // driver floats and reads as None.
+    //
+    // The network owns neither its wires nor its switches. Either may be
+    // destroyed first and detaches itself, and destroying the network hands
+    // every wire back to plain resolution. Changes made on those destructor
+    // paths are not passed to hooks or watchpoints and their readers are
+    // only queued for the next settle, since a destructor must not run
+    // code that can throw; removeNet() and removeSwitch() report normally.
+    class ResistiveNetwork final : public LogicSimObject, public WireResolver {
+        struct Net {
+            Wire* wire;
+            unsigned int component;
+            unsigned int local;
+            double voltage;
+            vector<unsigned int> links;
+        };
+        struct Link {
+            ResistiveSwitch* sw;
+            unsigned int a;
+            unsigned int b;
+        };
+        struct Component {
+            vector<unsigned int> nets;
+            vector<double> conductance;
+            SparseLU lu;
+            bool factored = false;
+        };
+        static constexpr double STRONG_CONDUCTANCE = 1e3;
+        static constexpr double LEAK_CONDUCTANCE = 1e-9;
+
+        vector<Net> nets;
+        unordered_map<Wire*, unsigned int> ids;
+        vector<Link> links;
+        vector<Component> components;
+        vector<unsigned int> free_components;
+        vector<double> g;
+        vector<double> rhs;
+        vector<SparseLU::Row> rows;
+        double vdd = 1.0;
+        bool analog = false;
+        unsigned long long factorizations = 0;
+        unsigned long long solves = 0;
+
+        double level(const WireStateValue& v) {
+            switch (v.type) {
+            case WireStateValueType::FLOAT:
+                return (double)v.fp;
+            case WireStateValueType::BIT:
+                return v.b ? vdd : 0.0;
+            case WireStateValueType::NONE:
+                return 0.0;
+            default:
+                return wire_value_bits(v) != 0 ? vdd : 0.0;
+            }
+        }
+        static double conductanceOf(unsigned short resistance) {
+            return resistance == 0 ? STRONG_CONDUCTANCE : 1.0 / (double)resistance;
+        }
+        unsigned int newComponent() {
+            if (!free_components.empty()) {
+                unsigned int c = free_components.back();
+                free_components.pop_back();
+                return c;
+            }
+            components.emplace_back();
+            return (unsigned int)(components.size() - 1);
+        }
+        void releaseComponent(unsigned int c) {
+            Component& comp = components[c];
+            comp.nets.clear();
+            comp.conductance.clear();
+            comp.factored = false;
+            free_components.push_back(c);
+        }
+        // the nets reachable from net through conducting switches
+        unsigned int gather(unsigned int net) {
+            unsigned int c = newComponent();
+            Component& comp = components[c];
+            nets[net].component = c;
+            comp.nets.push_back(net);
+            for (size_t i = 0; i < comp.nets.size(); i++) {
+                Net& n = nets[comp.nets[i]];
+                n.local = (unsigned int)i;
+                for (auto l : n.links) {
+                    if (!links[l].sw->conducting) continue;
+                    unsigned int o = links[l].a == comp.nets[i] ? links[l].b : links[l].a;
+                    if (nets[o].component == c) continue;
+                    nets[o].component = c;
+                    comp.nets.push_back(o);
+                }
+            }
+            return c;
+        }
+        void factor(Component& comp) {
+            size_t n = comp.nets.size();
+            rows.assign(n, SparseLU::Row());
+            for (size_t i = 0; i < n; i++) {
+                Net& net = nets[comp.nets[i]];
+                double diag = comp.conductance[i] + LEAK_CONDUCTANCE;
+                for (auto l : net.links) {
+                    if (!links[l].sw->conducting) continue;
+                    unsigned int o = links[l].a == comp.nets[i] ? links[l].b : links[l].a;
+                    double gl = conductanceOf(links[l].sw->resistance);
+                    diag += gl;
+                    rows[i].push_back({nets[o].local, -gl});
+                }
+                rows[i].push_back({(unsigned int)i, diag});
+            }
+            comp.lu.factor(rows);
+            comp.factored = true;
+            factorizations++;
+        }
+        // every rewritten net but source (whose Pin::drive reports its own
+        // change) runs the change hook and watchpoints and wakes its readers
+        // quiet is for destructor paths: readers are queued, nothing reported
+        void solve(unsigned int c, Wire* source = nullptr, bool quiet = false) {
+            Component& comp = components[c];
+            size_t n = comp.nets.size();
+            g.assign(n, 0.0);
+            rhs.assign(n, 0.0);
+            unsigned short strongest = (unsigned short)-1;
+            for (size_t i = 0; i < n; i++) {
+                for (auto& d : nets[comp.nets[i]].wire->getWireState(0)->getDrivers()) {
+                    if (d.resistance == (unsigned short)-1) continue;
+                    double gd = conductanceOf(d.resistance);
+                    g[i] += gd;
+                    rhs[i] += gd * level(d);
+                    if (d.resistance < strongest) strongest = d.resistance;
+                }
+            }
+            if (!comp.factored || comp.conductance != g) {
+                comp.conductance = g;
+                factor(comp);
+            }
+            comp.lu.solve(rhs);
+            solves++;
+            bool floating = strongest == (unsigned short)-1;
+            for (size_t i = 0; i < n; i++) {
+                Net& net = nets[comp.nets[i]];
+                net.voltage = floating ? 0.0 : rhs[i];
+                WireStateValue r;
+                if (!floating) {
+                    r = analog ? WireStateValue((long double)rhs[i]) : WireStateValue(rhs[i] > vdd / 2);
+                    r.resistance = strongest;
+                }
+                WireState* ws = net.wire->getWireState(0);
+                const WireStateValue& cur = ws->peekState();
+                if (r.is(cur)) continue;
+                WireStateValueType type = cur.type;
+                unsigned long long before = wire_value_bits(cur);
+                ws->setResolved(r);
+                if (net.wire == source) continue;
+                if (quiet) {
+                    net.wire->defer_update();
+                    continue;
+                }
+                net.wire->reportChange(0, type, before);
+                net.wire->mark_for_update();
+            }
+        }
+        unsigned int netOf(Wire* w) {
+            auto it = ids.find(w);
+            if (it != ids.end()) return it->second;
+            addNet(w);
+            return ids[w];
+        }
+        // forgets the membership of c so its nets can be gathered again
+        void dissolve(unsigned int c) {
+            if (c == NO_INDEX) return;
+            for (auto n : components[c].nets) nets[n].component = NO_INDEX;
+            releaseComponent(c);
+        }
+        void regather(const vector<unsigned int>& seeds, bool quiet) {
+            for (auto n : seeds) {
+                if (nets[n].component == NO_INDEX) solve(gather(n), nullptr, quiet);
+            }
+        }
+        static void replaceIndex(vector<unsigned int>& v, unsigned int from, unsigned int to) {
+            for (auto& x : v) {
+                if (x == from) x = to;
+            }
+        }
+        friend class ResistiveSwitch;
+        void switchChanged(unsigned int l, bool quiet = false) {
+            unsigned int a = links[l].a, b = links[l].b;
+            unsigned int ca = nets[a].component, cb = nets[b].component;
+            // every old member is still reachable from a or b
+            dissolve(ca);
+            if (cb != ca) dissolve(cb);
+            regather({a, b}, quiet);
+        }
+        // the last link takes over index l
+        void unlink(unsigned int l) {
+            Link k = links[l];
+            k.sw->network = nullptr;
+            k.sw->id = NO_INDEX;
+            auto& la = nets[k.a].links;
+            la.erase(std::find(la.begin(), la.end(), l));
+            if (k.b != k.a) {
+                auto& lb = nets[k.b].links;
+                lb.erase(std::find(lb.begin(), lb.end(), l));
+            }
+            unsigned int last = (unsigned int)links.size() - 1;
+            if (l != last) {
+                links[l] = links[last];
+                links[l].sw->id = l;
+                replaceIndex(nets[links[l].a].links, last, l);
+                if (links[l].b != links[l].a) replaceIndex(nets[links[l].b].links, last, l);
+            }
+            links.pop_back();
+        }
+        void detachSwitch(ResistiveSwitch* sw, bool quiet) {
+            if (sw->network != this) return;
+            unsigned int a = links[sw->id].a, b = links[sw->id].b;
+            unsigned int ca = nets[a].component, cb = nets[b].component;
+            unlink(sw->id);
+            if (!sw->conducting) return;
+            dissolve(ca);
+            if (cb != ca) dissolve(cb);
+            regather({a, b}, quiet);
+        }
+        // drops the net and its links; the last net takes over index id and
+        // the nets that shared its component are solved again
+        void dropNet(unsigned int id, bool quiet) {
+            while (!nets[id].links.empty()) unlink(nets[id].links.back());
+            vector<unsigned int> seeds;
+            unsigned int c = nets[id].component;
+            if (c != NO_INDEX) {
+                for (auto n : components[c].nets) {
+                    if (n != id) seeds.push_back(n);
+                }
+            }
+            dissolve(c);
+            ids.erase(nets[id].wire);
+            unsigned int last = (unsigned int)nets.size() - 1;
+            if (id != last) {
+                nets[id] = std::move(nets[last]);
+                ids[nets[id].wire] = id;
+                for (auto l : nets[id].links) {
+                    if (links[l].a == last) links[l].a = id;
+                    if (links[l].b == last) links[l].b = id;
+                }
+                if (nets[id].component != NO_INDEX) replaceIndex(components[nets[id].component].nets, last, id);
+                replaceIndex(seeds, last, id);
+            }
+            nets.pop_back();
+            regather(seeds, quiet);
+        }
+    public:
+        virtual const char* getObjectType() {
+            return "ResistiveNetwork";
+        }
+        ResistiveNetwork() = default;
+        ResistiveNetwork(const ResistiveNetwork&) = delete;
+        ResistiveNetwork& operator=(const ResistiveNetwork&) = delete;
+        // the wires fall back to plain lowest-resistance resolution; drivers
+        // that conflict there are reported to diagnostics and read as None
+        ~ResistiveNetwork() {
+            for (auto& l : links) {
+                l.sw->network = nullptr;
+                l.sw->id = NO_INDEX;
+            }
+            for (auto& n : nets) {
+                n.wire->releaseResolver();
+                n.wire->defer_update();
+            }
+        }
+        void addNet(Wire* w) {
+            if (ids.count(w)) return;
+            unsigned int id = (unsigned int)nets.size();
+            ids[w] = id;
+            nets.push_back({w, NO_INDEX, 0, 0.0, {}});
+            w->setResolver(this);
+            solve(gather(id));
+        }
+        // w goes back to plain resolution, and its switches leave the network
+        void removeNet(Wire* w) {
+            auto it = ids.find(w);
+            if (it == ids.end()) return;
+            dropNet(it->second, false);
+            const WireStateValue& cur = w->getWireState(0)->peekState();
+            WireStateValueType type = cur.type;
+            unsigned long long before = wire_value_bits(cur);
+            w->setResolver(nullptr);
+            w->reportChange(0, type, before);
+            w->mark_for_update();
+        }
+        // the switch's nets stay in the network
+        void removeSwitch(ResistiveSwitch* sw) {
+            detachSwitch(sw, false);
+        }
+        virtual void wireDestroyed(Wire* wire) override {
+            auto it = ids.find(wire);
+            if (it != ids.end()) dropNet(it->second, true);
+        }
+        // the channel pins must already be connected; their wires are added as nets
+        void addSwitch(ResistiveSwitch* sw) {
+            if (!sw->getPin(1)->hasWire() || !sw->getPin(2)->hasWire())
+                throw LogicSimException("ResistiveSwitch channel is not connected", sw);
+            if (sw->network != nullptr) throw LogicSimException("ResistiveSwitch already belongs to a network", sw);
+            unsigned int a = netOf(sw->getPin(1)->getWire());
+            unsigned int b = netOf(sw->getPin(2)->getWire());
+            unsigned int l = (unsigned int)links.size();
+            links.push_back({sw, a, b});
+            nets[a].links.push_back(l);
+            if (b != a) nets[b].links.push_back(l);
+            sw->network = this;
+            sw->id = l;
+            sw->conducting = (wire_value_bits(sw->read_pin(0)) & 1) != sw->active_low;
+            if (sw->conducting) switchChanged(l);
+        }
+        virtual void netChanged(Wire* wire, unsigned short index) override {
+            if (index != 0) return;
+            auto it = ids.find(wire);
+            if (it != ids.end()) solve(nets[it->second].component, wire);
+        }
+        double getVoltage(Wire* w) {
+            auto it = ids.find(w);
+            return it == ids.end() ? 0.0 : nets[it->second].voltage;
+        }
+        void setSupply(double v) {
+            vdd = v;
+        }
+        double getSupply() {
+            return vdd;
+        }
+        // FLOAT node voltages instead of thresholded bits
+        void setAnalog(bool a) {
+            analog = a;
+        }
+        bool isAnalog() {
+            return analog;
+        }
+        unsigned long long getFactorizations() {
+            return factorizations;
+        }
+        unsigned long long getSolves() {
+            return solves;
+        }
+    };
+
+    ResistiveSwitch::~ResistiveSwitch() {
+        if (network != nullptr) network->detachSwitch(this, true);
+    }
+    void ResistiveSwitch::update() {
+        bool on = (wire_value_bits(read_pin(0)) & 1) != active_low;
+        if (on == conducting) return;
+        conducting = on;
+        if (network != nullptr) network->switchChanged(id);
+    }
+};
@@ -0,0 +1,320 @@
+#pragma once
+
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <vector>
+#include <string>
+#include <algorithm>
+
+#ifdef WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "main_init.hpp"
+#include "numberconfigentries.hpp"
+#include "stringconfigentry.hpp"
+
+namespace LogicSim {
+    enum class SerializerFormat {
+        JSON,
+        BINARY
+    };
+
+    // reusable output buffer; when bound to a file descriptor it is flushed
+    // whenever it fills up instead of growing
+    class StateWriter final {
+        vector<char> buffer;
+        size_t used = 0;
+        int fd = -1;
+    public:
+        StateWriter(size_t capacity = 65536) : buffer(capacity) {};
+        StateWriter(int fd, size_t capacity = 65536) : buffer(capacity), fd(fd) {};
+        StateWriter(const StateWriter&) = delete;
+        StateWriter& operator=(const StateWriter&) = delete;
+        ~StateWriter() {
+            flush();
+        }
+        void reserve(size_t n) {
+            if (used + n <= buffer.size()) return;
+            flush();
+            if (used + n > buffer.size()) buffer.resize(std::max(buffer.size() * 2, used + n));
+        }
+        void flush() {
+            if (fd < 0) return;
+            size_t off = 0;
+            while (off < used) {
+                auto n = ::write(fd, buffer.data() + off, used - off);
+                if (n <= 0) break;
+                off += (size_t)n;
+            }
+            used = 0;
+        }
+        void put(char c) {
+            reserve(1);
+            buffer[used++] = c;
+        }
+        void put(const char* s, size_t n) {
+            reserve(n);
+            std::memcpy(buffer.data() + used, s, n);
+            used += n;
+        }
+        void put(const char* s) {
+            put(s, std::strlen(s));
+        }
+        template <typename T>
+        void putInt(T v) {
+            reserve(24);
+            used = std::to_chars(buffer.data() + used, buffer.data() + buffer.size(), v).ptr - buffer.data();
+        }
+        void putFloat(long double v) {
+            reserve(64);
+            auto r = std::to_chars(buffer.data() + used, buffer.data() + buffer.size(), v);
+            used = r.ptr - buffer.data();
+        }
+        void putHex(uintptr_t v) {
+            reserve(2 + sizeof(uintptr_t) * 2);
+            used = hex_to_chars(buffer.data() + used, buffer.data() + buffer.size(), v) - buffer.data();
+        }
+        // a long double's value bytes in host order; the x87 80-bit format
+        // is 10 bytes and its padding is left out
+        static constexpr size_t LONG_DOUBLE_BYTES = std::numeric_limits<long double>::digits == 64 ? 10 : sizeof(long double);
+        void putLongDouble(long double v) {
+            reserve(LONG_DOUBLE_BYTES);
+            std::memcpy(buffer.data() + used, &v, LONG_DOUBLE_BYTES);
+            used += LONG_DOUBLE_BYTES;
+        }
+        template <typename T>
+        void putRaw(T v) {
+            reserve(sizeof(T));
+            for (size_t i = 0; i < sizeof(T); i++) {
+                buffer[used++] = (char)((unsigned long long)v >> (8 * i));
+            }
+        }
+        const char* data() {
+            return buffer.data();
+        }
+        size_t size() {
+            return used;
+        }
+        void reset() {
+            used = 0;
+        }
+    };
+
+    class StateSerializer final {
+        StateWriter& out;
+        SerializerFormat format;
+
+        void putString(const char* s, size_t n) {
+            if (format == SerializerFormat::BINARY) {
+                out.putRaw<unsigned int>((unsigned int)n);
+                out.put(s, n);
+                return;
+            }
+            static const char hex[] = "0123456789abcdef";
+            out.put('"');
+            for (size_t i = 0; i < n; i++) {
+                char c = s[i];
+                if (c == '"' || c == '\\') {
+                    out.put('\\');
+                    out.put(c);
+                } else if ((unsigned char)c < 0x20) {
+                    char esc[6] = {'\\', 'u', '0', '0', hex[(c >> 4) & 0xF], hex[c & 0xF]};
+                    out.put(esc, 6);
+                } else {
+                    out.put(c);
+                }
+            }
+            out.put('"');
+        }
+        void putString(const string& s) {
+            putString(s.data(), s.size());
+        }
+        void putKeyedHex(const char* key, void* ptr) {
+            out.put('"');
+            out.put(key);
+            out.put("\":\"", 3);
+            out.putHex((uintptr_t)ptr);
+            out.put('"');
+        }
+        void writeEntry(ConfigEntry* e) {
+            bool json = format == SerializerFormat::JSON;
+            if (e == nullptr || e->isNull()) {
+                if (json) out.put("null", 4);
+                else out.put('n');
+            } else if (auto v = dynamic_cast<UShortConfigEntry*>(e)) writeUnsigned(v->get());
+            else if (auto v = dynamic_cast<UByteConfigEntry*>(e)) writeUnsigned(v->get());
+            else if (auto v = dynamic_cast<ULongConfigEntry*>(e)) writeUnsigned(v->get());
+            else if (auto v = dynamic_cast<ULongLongConfigEntry*>(e)) writeUnsigned(v->get());
+            else if (auto v = dynamic_cast<ShortConfigEntry*>(e)) writeSigned(v->get());
+            else if (auto v = dynamic_cast<ByteConfigEntry*>(e)) writeSigned(v->get());
+            else if (auto v = dynamic_cast<LongConfigEntry*>(e)) writeSigned(v->get());
+            else if (auto v = dynamic_cast<LongLongConfigEntry*>(e)) writeSigned(v->get());
+            else if (auto v = dynamic_cast<FloatConfigEntry*>(e)) {
+                if (json) writeFloat(v->get());
+                else {
+                    out.put('f');
+                    out.putLongDouble(v->get());
+                }
+            } else if (auto v = dynamic_cast<StringConfigEntry*>(e)) {
+                if (!json) out.put('s');
+                putString(v->get());
+            } else if (json) {
+                // other entries are opaque, like OBJ wire values
+                out.put("{\"entry\":", 9);
+                putString(e->getObjectType(), std::strlen(e->getObjectType()));
+                out.put(',');
+                putKeyedHex("ptr", e->getPtr());
+                out.put('}');
+            } else {
+                out.put('o');
+                putString(e->getObjectType(), std::strlen(e->getObjectType()));
+                out.putRaw((unsigned long long)(uintptr_t)e->getPtr());
+            }
+        }
+        // JSON has no inf or NaN; those are written as strings
+        void writeFloat(long double v) {
+            if (std::isnan(v)) out.put("\"nan\"", 5);
+            else if (std::isinf(v)) {
+                if (v < 0) out.put("\"-inf\"", 6);
+                else out.put("\"inf\"", 5);
+            } else out.putFloat(v);
+        }
+        void writeUnsigned(unsigned long long v) {
+            if (format == SerializerFormat::JSON) {
+                out.putInt(v);
+            } else {
+                out.put('u');
+                out.putRaw(v);
+            }
+        }
+        void writeSigned(long long v) {
+            if (format == SerializerFormat::JSON) {
+                out.putInt(v);
+            } else {
+                out.put('i');
+                out.putRaw((unsigned long long)v);
+            }
+        }
+    public:
+        StateSerializer(StateWriter& out, SerializerFormat format) : out(out), format(format) {};
+
+        void writeValue(const WireStateValue& v) {
+            if (format == SerializerFormat::BINARY) {
+                out.putRaw<unsigned char>((unsigned char)v.type);
+                out.putRaw<unsigned short>(v.resistance);
+                if (v.type == WireStateValueType::FLOAT) {
+                    out.putLongDouble(v.fp);
+                } else {
+                    out.putRaw(v.ll);
+                }
+                return;
+            }
+            if (v.type == WireStateValueType::NONE) {
+                out.put("null", 4);
+                return;
+            }
+            out.put("{\"type\":", 8);
+            const char* t = wirestatetype_name(v.type);
+            putString(t, std::strlen(t));
+            out.put(",\"r\":", 5);
+            out.putInt(v.resistance);
+            out.put(",\"v\":", 5);
+            switch (v.type) {
+                case WireStateValueType::FLOAT:
+                    writeFloat(v.fp);
+                    break;
+                case WireStateValueType::OBJ:
+                    out.put('"');
+                    out.putHex((uintptr_t)v.ptr);
+                    out.put('"');
+                    break;
+                default:
+                    out.putInt(wire_value_bits(v));
+                    break;
+            }
+            out.put('}');
+        }
+        void writeWire(Wire* w) {
+            size_t n = w->getStateCount();
+            if (format == SerializerFormat::BINARY) {
+                out.put('W');
+                out.putRaw((unsigned long long)(uintptr_t)w);
+                out.putRaw<unsigned int>((unsigned int)n);
+                for (size_t i = 0; i < n; i++) writeValue(w->getWireState((unsigned short)i)->peekState());
+                return;
+            }
+            out.put('{');
+            putKeyedHex("wire", w);
+            out.put(",\"states\":[", 11);
+            for (size_t i = 0; i < n; i++) {
+                if (i != 0) out.put(',');
+                writeValue(w->getWireState((unsigned short)i)->peekState());
+            }
+            out.put("]}", 2);
+        }
+        void writeConfig(LogicSimObject* owner, ConfigTable& table) {
+            if (format == SerializerFormat::BINARY) {
+                out.put('C');
+                out.putRaw((unsigned long long)(uintptr_t)owner);
+                out.putRaw<unsigned int>((unsigned int)table.size());
+                for (auto& kv : table) {
+                    string name = config_key_name(kv.first);
+                    out.putRaw<unsigned short>((unsigned short)name.size());
+                    out.put(name.data(), name.size());
+                    writeEntry(kv.second.get());
+                }
+                return;
+            }
+            out.put('{');
+            putKeyedHex("object", owner);
+            out.put(",\"type\":", 8);
+            putString(owner->getObjectType(), std::strlen(owner->getObjectType()));
+            out.put(",\"config\":{", 11);
+            bool first = true;
+            for (auto& kv : table) {
+                if (!first) out.put(',');
+                first = false;
+                putString(config_key_name(kv.first));
+                out.put(':');
+                writeEntry(kv.second.get());
+            }
+            out.put("}}", 2);
+        }
+        // dumps every live Wire and every ConfigurableBasicGate's config table;
+        // walks a snapshot of objects, since nothing may register while iterating it
+        void writeCircuit() {
+            vector<LogicSimObject*> live = live_objects();
+            bool json = format == SerializerFormat::JSON;
+            if (json) out.put("{\"wires\":[", 10);
+            else {
+                // version 2 writes floats as full long doubles
+                out.put("LSIM", 4);
+                out.putRaw<unsigned char>(2);
+            }
+            bool first = true;
+            for (auto obj : live) {
+                auto w = dynamic_cast<Wire*>(obj);
+                if (w == nullptr) continue;
+                if (json && !first) out.put(',');
+                first = false;
+                writeWire(w);
+            }
+            if (json) out.put("],\"configs\":[", 13);
+            first = true;
+            for (auto obj : live) {
+                auto g = dynamic_cast<ConfigurableBasicGate*>(obj);
+                if (g == nullptr) continue;
+                if (json && !first) out.put(',');
+                first = false;
+                writeConfig(g, g->config_table);
+            }
+            if (json) out.put("]}", 2);
+            else out.put('E');
+        }
+    };
+};
@@ -0,0 +1,366 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <type_traits>
+#include <cstring>
+#include <unordered_map>
+
+#include "main_init.hpp"
+#include "serializer.hpp"
+#include "memorygates.hpp"
+
+namespace LogicSim {
+    namespace Exceptions {
+        class MalformedStimulusError : public LogicSimException {
+        public:
+            MalformedStimulusError(size_t offset, LogicSimObject* obj) :
+                LogicSimException("Malformed stimulus log at offset " + to_string((unsigned long long)offset), obj) {};
+        };
+    };
+
+    enum class StimulusKind : unsigned char {
+        PIN_WRITE = 'P',
+        EVENT = 'E',
+        NAME = 'N'
+    };
+    struct StimulusRecord {
+        StimulusKind kind = StimulusKind::PIN_WRITE;
+        unsigned long long time = 0;
+        unsigned int id = 0;
+        int index = 0;
+        WireStateValueType type = WireStateValueType::NONE;
+        unsigned short resistance = 0;
+        unsigned long long bits = 0;
+        long double fp = 0;
+        // event data, or the name of a NAME record
+        const unsigned char* payload = nullptr;
+        size_t payload_size = 0;
+    };
+
+    // Only pins and event channels added under a name are recorded. Ids are
+    // numbered per log in the order names are added and each one is defined
+    // by a NAME record before its first use, so a log replays against any
+    // circuit that binds the same names, however its objects were created.
+    // Log layout: "LSTM" 2, then records of
+    //   N: varint id, varint size, name
+    //   P: varint time delta (ns), varint id, varint index, type, u16 resistance,
+    //      varint bits (or raw long double)
+    //   E: varint time delta (ns), varint id, varint size, payload
+    class StimulusRecorder final : public LogicSimObject {
+        inline static StimulusRecorder* active = nullptr;
+        inline static std::mutex active_mtx;
+        inline static std::atomic<unsigned int> next_serial{1};
+        StateWriter& out;
+        std::mutex mtx;
+        unordered_map<Pin*, unsigned int> ids;
+        unordered_map<string, unsigned int> names;
+        struct Tap {
+            shared_ptr<void> handler;
+            void (*disconnect)(void*);
+        };
+        vector<Tap> taps;
+        unsigned int serial;
+        std::chrono::steady_clock::time_point start_time;
+        unsigned long long last_time = 0;
+        unsigned long long records = 0;
+
+        static void onPinWrite(Pin* pin, int in, const WireStateValue& value) {
+            if (active != nullptr) active->recordPinWrite(pin, in, value);
+        }
+        // runs on the event's handler thread; the instance only carries the
+        // recorder serial and channel id, so a stopped recorder is never touched
+        template <typename... Args>
+        static void onEventFire(void* instance, Args... args) {
+            unsigned long long key = (unsigned long long)(uintptr_t)instance;
+            static_assert((std::is_trivially_copyable<Args>::value && ...), "recorded event arguments must be trivially copyable");
+            unsigned char payload[(sizeof(Args) + ... + 0) + 1];
+            size_t n = 0;
+            ((std::memcpy(payload + n, &args, sizeof(Args)), n += sizeof(Args)), ...);
+            std::lock_guard<std::mutex> lck(active_mtx);
+            if (active == nullptr || active->serial != (unsigned int)(key >> 24)) return;
+            active->recordEvent((unsigned int)(key & 0xFFFFFF), payload, n);
+        }
+        template <typename... Args>
+        static void disconnectTap(void* handler) {
+            ((EventHandler<Args...>*)handler)->Disconnect();
+        }
+        void putVarint(unsigned long long v) {
+            while (v >= 0x80) {
+                out.put((char)(v | 0x80));
+                v >>= 7;
+            }
+            out.put((char)v);
+        }
+        unsigned int define(const string& name) {
+            std::lock_guard<std::mutex> lck(mtx);
+            auto it = names.find(name);
+            if (it != names.end()) return it->second;
+            unsigned int id = (unsigned int)names.size();
+            if (id > 0xFFFFFF) throw LogicSimException("Too many names in one stimulus log", this);
+            names[name] = id;
+            out.put((char)StimulusKind::NAME);
+            putVarint(id);
+            putVarint(name.size());
+            out.put(name.data(), name.size());
+            return id;
+        }
+        void putHeader(StimulusKind kind, unsigned int id) {
+            unsigned long long now = (unsigned long long)std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - start_time).count();
+            out.put((char)kind);
+            putVarint(now - last_time);
+            putVarint(id);
+            last_time = now;
+            records++;
+        }
+    public:
+        virtual const char* getObjectType() {
+            return "StimulusRecorder";
+        }
+        StimulusRecorder(StateWriter& out) : out(out), serial(next_serial++ & 0xFFFFFF) {
+            out.put("LSTM", 4);
+            out.put((char)2);
+            start_time = std::chrono::steady_clock::now();
+        }
+        ~StimulusRecorder() {
+            stop();
+            for (auto& t : taps) t.disconnect(t.handler.get());
+        }
+        // writes through pin are recorded once the recorder is started
+        unsigned int add(Pin* pin, const string& name) {
+            unsigned int id = define(name);
+            std::lock_guard<std::mutex> lck(mtx);
+            ids[pin] = id;
+            return id;
+        }
+        // every pin of gate, as name.0, name.1, ...
+        void add(BasicGate* gate, const string& name) {
+            for (size_t i = 0; i < gate->getPinCount(); i++) add(gate->getPin((unsigned short)i), name + "." + std::to_string(i));
+        }
+        // id for recordEvent()
+        unsigned int addChannel(const string& name) {
+            return define(name);
+        }
+        // every fire of e while the recorder is started becomes an EVENT
+        // record whose payload is the arguments packed back to back
+        template <typename... Args>
+        void watch(Event<Args...>& e, const string& name) {
+            unsigned long long key = ((unsigned long long)serial << 24) | addChannel(name);
+            taps.push_back({e.Connect(&StimulusRecorder::onEventFire<Args...>, (void*)(uintptr_t)key), &StimulusRecorder::disconnectTap<Args...>});
+        }
+        void start() {
+            std::lock_guard<std::mutex> lck(active_mtx);
+            if (active == this) return;
+            if (active != nullptr) active->detach();
+            active = this;
+            pin_write_hooks.push_back(&StimulusRecorder::onPinWrite);
+        }
+        void stop() {
+            {
+                std::lock_guard<std::mutex> lck(active_mtx);
+                if (active != this) return;
+                detach();
+            }
+            std::lock_guard<std::mutex> lck(mtx);
+            out.flush();
+        }
+    private:
+        void detach() {
+            active = nullptr;
+            pin_write_hooks.erase(std::remove(pin_write_hooks.begin(), pin_write_hooks.end(), &StimulusRecorder::onPinWrite), pin_write_hooks.end());
+        }
+    public:
+        void recordPinWrite(Pin* pin, int in, const WireStateValue& value) {
+            std::lock_guard<std::mutex> lck(mtx);
+            auto it = ids.find(pin);
+            if (it == ids.end()) return;
+            putHeader(StimulusKind::PIN_WRITE, it->second);
+            putVarint((unsigned long long)in);
+            out.put((char)value.type);
+            out.putRaw<unsigned short>(value.resistance);
+            if (value.type == WireStateValueType::FLOAT) {
+                out.put((const char*)&value.fp, sizeof(long double));
+            } else {
+                putVarint(value.ll);
+            }
+        }
+        void recordEvent(unsigned int channel, const void* data, size_t n) {
+            std::lock_guard<std::mutex> lck(mtx);
+            putHeader(StimulusKind::EVENT, channel);
+            putVarint(n);
+            out.put((const char*)data, n);
+        }
+        unsigned long long count() {
+            return records;
+        }
+    };
+
+    // Names are bound before replay; resolve() reads the log's NAME records
+    // once and turns every id into its pin or event channel, failing on a
+    // pin name that nothing was bound to.
+    class StimulusReplayer final : public LogicSimObject {
+        typedef std::tuple<void (*)(void*, const unsigned char*, size_t), void*> Channel;
+        shared_ptr<MemoryImage> image;
+        const unsigned char* data = nullptr;
+        size_t length = 0;
+        size_t offset = 0;
+        unsigned long long time = 0;
+        unordered_map<string, Pin*> bound_pins;
+        unordered_map<string, Channel> bound_channels;
+        vector<Pin*> pins;
+        vector<Channel> channels;
+        bool resolved = false;
+
+        unsigned long long getVarint() {
+            unsigned long long v = 0;
+            for (unsigned int shift = 0; shift < 64; shift += 7) {
+                if (offset >= length) throw Exceptions::MalformedStimulusError(offset, this);
+                unsigned char c = data[offset++];
+                v |= (unsigned long long)(c & 0x7F) << shift;
+                if ((c & 0x80) == 0) return v;
+            }
+            throw Exceptions::MalformedStimulusError(offset, this);
+        }
+        void need(size_t n) {
+            if (offset + n > length) throw Exceptions::MalformedStimulusError(offset, this);
+        }
+        void checkHeader() {
+            if (length < 5 || std::memcmp(data, "LSTM", 4) != 0 || data[4] != 2)
+                throw Exceptions::MalformedStimulusError(0, this);
+            offset = 5;
+        }
+    public:
+        virtual const char* getObjectType() {
+            return "StimulusReplayer";
+        }
+        StimulusReplayer(const string& path) : image(make_shared<MemoryImage>(path)) {
+            data = image->bytes();
+            length = image->size();
+            checkHeader();
+        }
+        StimulusReplayer(const void* buf, size_t n) : data((const unsigned char*)buf), length(n) {
+            checkHeader();
+        }
+        void bind(const string& name, Pin* pin) {
+            bound_pins[name] = pin;
+            resolved = false;
+        }
+        // pins of gate, named as StimulusRecorder::add(gate, name) does
+        void bind(const string& name, BasicGate* gate) {
+            for (size_t i = 0; i < gate->getPinCount(); i++) bind(name + "." + std::to_string(i), gate->getPin((unsigned short)i));
+        }
+        void onEvent(const string& name, void (*f)(void*, const unsigned char*, size_t), void* instance) {
+            bound_channels[name] = std::make_tuple(f, instance);
+            resolved = false;
+        }
+        void resolve() {
+            size_t saved_offset = offset;
+            unsigned long long saved_time = time;
+            offset = 5;
+            pins.clear();
+            channels.clear();
+            vector<bool> used;
+            vector<string> ids;
+            StimulusRecord r;
+            while (next(r)) {
+                if (r.kind == StimulusKind::NAME) {
+                    if (ids.size() <= r.id) ids.resize(r.id + 1);
+                    ids[r.id].assign((const char*)r.payload, r.payload_size);
+                } else if (r.kind == StimulusKind::PIN_WRITE) {
+                    if (used.size() <= r.id) used.resize(r.id + 1, false);
+                    used[r.id] = true;
+                }
+            }
+            pins.assign(ids.size(), nullptr);
+            channels.assign(ids.size(), Channel(nullptr, nullptr));
+            for (size_t id = 0; id < ids.size(); id++) {
+                auto p = bound_pins.find(ids[id]);
+                if (p != bound_pins.end()) pins[id] = p->second;
+                auto c = bound_channels.find(ids[id]);
+                if (c != bound_channels.end()) channels[id] = c->second;
+            }
+            for (size_t id = 0; id < used.size(); id++) {
+                if (!used[id]) continue;
+                if (id >= ids.size()) throw Exceptions::MalformedStimulusError(0, this);
+                if (pins[id] == nullptr) throw LogicSimException("Stimulus pin '" + ids[id] + "' is not bound", this);
+            }
+            offset = saved_offset;
+            time = saved_time;
+            resolved = true;
+        }
+        bool next(StimulusRecord& r) {
+            if (offset >= length) return false;
+            r.kind = (StimulusKind)data[offset++];
+            if (r.kind == StimulusKind::NAME) {
+                r.id = (unsigned int)getVarint();
+                r.payload_size = (size_t)getVarint();
+                need(r.payload_size);
+                r.payload = data + offset;
+                offset += r.payload_size;
+                r.time = time;
+                return true;
+            }
+            time += getVarint();
+            r.time = time;
+            r.id = (unsigned int)getVarint();
+            if (r.kind == StimulusKind::PIN_WRITE) {
+                r.index = (int)getVarint();
+                need(3);
+                r.type = (WireStateValueType)data[offset];
+                r.resistance = (unsigned short)(data[offset + 1] | (data[offset + 2] << 8));
+                offset += 3;
+                if (r.type == WireStateValueType::FLOAT) {
+                    need(sizeof(long double));
+                    std::memcpy(&r.fp, data + offset, sizeof(long double));
+                    offset += sizeof(long double);
+                } else {
+                    r.bits = getVarint();
+                }
+            } else if (r.kind == StimulusKind::EVENT) {
+                r.payload_size = (size_t)getVarint();
+                need(r.payload_size);
+                r.payload = data + offset;
+                offset += r.payload_size;
+            } else {
+                throw Exceptions::MalformedStimulusError(offset - 1, this);
+            }
+            return true;
+        }
+        void apply(const StimulusRecord& r) {
+            if (!resolved) resolve();
+            if (r.kind == StimulusKind::NAME) return;
+            if (r.id >= pins.size()) throw Exceptions::MalformedStimulusError(offset, this);
+            if (r.kind == StimulusKind::EVENT) {
+                auto& c = channels[r.id];
+                if (std::get<0>(c) != nullptr) std::get<0>(c)(std::get<1>(c), r.payload, r.payload_size);
+                return;
+            }
+            // object pointers from another run are meaningless
+            if (r.type == WireStateValueType::OBJ) return;
+            WireStateValue v;
+            v.type = r.type;
+            v.resistance = r.resistance;
+            if (r.type == WireStateValueType::FLOAT) v.fp = r.fp;
+            else v.ll = r.bits;
+            pins[r.id]->write(r.index, v);
+        }
+        // applies every remaining record back to back, ignoring recorded timing
+        size_t replay() {
+            if (!resolved) resolve();
+            StimulusRecord r;
+            size_t n = 0;
+            while (next(r)) {
+                if (r.kind == StimulusKind::NAME) continue;
+                apply(r);
+                n++;
+            }
+            return n;
+        }
+        void rewind() {
+            offset = 5;
+            time = 0;
+        }
+    };
+};
@@ -5,9 +5,7 @@
 namespace LogicSim {
     class StringConfigEntry : public ConfigEntry {
     public:
-        StringConfigEntry(string value) : ConfigEntry(value,"string") {
-            this->set_t<string>("");
-        };
+        StringConfigEntry(string value) : ConfigEntry(value,"string") {};
         virtual const char* getObjectType() override {
             return "StringConfigEntry";
         };
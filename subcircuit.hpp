@@ -0,0 +1,286 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "main_init.hpp"
+#include "netlist.hpp"
+#include "cyclesim.hpp"
+
+namespace LogicSim {
+    // A gate made of other gates. Each external input pin drives an internal
+    // wire (getInputWire) and each internal output wire (getOutputWire) drives
+    // the matching external output pin; the internal gates are added with
+    // add() and are not owned. Bus width of the ports is "Bits" (default 1).
+    //
+    // A pure SubCircuit (combinational gates with a logic function only) is
+    // not evaluated through its internal wires at all: packed input values
+    // are looked up in a bounded LRU cache, and only misses run the compiled
+    // internal logic. Internal wires of a pure SubCircuit are not driven.
+    class SubCircuit : public ConfigurableBasicGate {
+        class PortDriver final : public BasicGate {
+        protected:
+            virtual void update() override {};
+        public:
+            PortDriver() : BasicGate(0, 1) {};
+            virtual const char* getObjectType() override {
+                return "SubCircuit::PortDriver";
+            }
+            void drive(WireStateValue value) {
+                write_pin(0, value);
+            }
+        };
+        class PortProbe final : public BasicGate {
+            SubCircuit* parent;
+            unsigned short port;
+        protected:
+            virtual void update() override {
+                parent->write_pin(parent->inputs + port, read_pin(0));
+            }
+        public:
+            PortProbe(SubCircuit* parent, unsigned short port) : BasicGate(1, 0), parent(parent), port(port) {};
+            virtual const char* getObjectType() override {
+                return "SubCircuit::PortProbe";
+            }
+        };
+        // open addressing over node indices, LRU order kept as an index list
+        struct CacheNode {
+            unsigned long long hash;
+            unsigned int prev;
+            unsigned int next;
+        };
+
+        unsigned short inputs;
+        unsigned short outputs;
+        vector<unique_ptr<PortDriver>> drivers;
+        vector<unique_ptr<PortProbe>> probes;
+        // after the port gates so the wires release their pins first
+        vector<unique_ptr<Wire>> input_wires;
+        vector<unique_ptr<Wire>> output_wires;
+        vector<BasicGate*> gates;
+
+        bool pure = false;
+        unique_ptr<Netlist> netlist;
+        unique_ptr<CycleSimulator> evaluator;
+        size_t capacity = 0;
+        // width the key layout was built for; 0 until the first lookup
+        unsigned short key_bits = 0;
+        size_t key_words = 0;
+        vector<CacheNode> nodes;
+        vector<unsigned long long> keys;
+        vector<unsigned long long> results;
+        vector<unsigned int> slots;
+        vector<unsigned long long> key;
+        unsigned int head = NO_INDEX;
+        unsigned int tail = NO_INDEX;
+        unsigned long long hits = 0;
+        unsigned long long misses = 0;
+        unsigned long long evictions = 0;
+
+        unsigned short bits() {
+            if (!config_table.exists(ConfigKeys::Bits)) return 1;
+            return assert_config_bits();
+        }
+        static unsigned long long hashKey(const unsigned long long* k, size_t n) {
+            unsigned long long h = 0x9E3779B97F4A7C15ULL;
+            for (size_t i = 0; i < n; i++) {
+                h ^= k[i] + 0x9E3779B97F4A7C15ULL + (h << 6) + (h >> 2);
+                h *= 0xBF58476D1CE4E5B9ULL;
+            }
+            return h ^ (h >> 31);
+        }
+        void unlink(unsigned int n) {
+            CacheNode& c = nodes[n];
+            if (c.prev != NO_INDEX) nodes[c.prev].next = c.next;
+            else head = c.next;
+            if (c.next != NO_INDEX) nodes[c.next].prev = c.prev;
+            else tail = c.prev;
+        }
+        void pushFront(unsigned int n) {
+            nodes[n].prev = NO_INDEX;
+            nodes[n].next = head;
+            if (head != NO_INDEX) nodes[head].prev = n;
+            head = n;
+            if (tail == NO_INDEX) tail = n;
+        }
+        unsigned int* findSlot(unsigned long long h, const unsigned long long* k) {
+            size_t mask = slots.size() - 1;
+            for (size_t i = h & mask;; i = (i + 1) & mask) {
+                unsigned int n = slots[i];
+                if (n == NO_INDEX) return &slots[i];
+                if (nodes[n].hash == h && std::equal(k, k + key_words, &keys[n * key_words])) return &slots[i];
+            }
+        }
+        // backward-shift deletion keeps probe chains intact without tombstones
+        void eraseSlot(size_t i) {
+            size_t mask = slots.size() - 1;
+            size_t j = i;
+            while (true) {
+                slots[i] = NO_INDEX;
+                while (true) {
+                    j = (j + 1) & mask;
+                    if (slots[j] == NO_INDEX) return;
+                    size_t home = nodes[slots[j]].hash & mask;
+                    if (i <= j ? (home <= i || home > j) : (home <= i && home > j)) break;
+                }
+                slots[i] = slots[j];
+                i = j;
+            }
+        }
+        // "Bits" may change after setPure(); a new width changes the key
+        // layout and the cached results, so it starts an empty cache
+        void packInputs() {
+            unsigned short b = bits();
+            if (b != key_bits) {
+                key_bits = b;
+                key_words = ((size_t)inputs * b + 63) / 64;
+                if (key_words == 0) key_words = 1;
+                key.assign(key_words, 0);
+                clearCache();
+            }
+            unsigned long long mask = b >= 64 ? ~0ULL : (1ULL << b) - 1;
+            std::fill(key.begin(), key.end(), 0);
+            size_t bit = 0;
+            for (unsigned short i = 0; i < inputs; i++) {
+                unsigned long long v = wire_value_bits(read_pin(i)) & mask;
+                key[bit / 64] |= v << (bit % 64);
+                if (bit % 64 + b > 64) key[bit / 64 + 1] |= v >> (64 - bit % 64);
+                bit += b;
+            }
+        }
+        void writeOutputs(const unsigned long long* v) {
+            unsigned short b = bits();
+            for (unsigned short i = 0; i < outputs; i++) {
+                if (b == 1) write_pin(inputs + i, WireStateValue((bool)(v[i] & 1)));
+                else write_pin(inputs + i, WireStateValue(v[i]));
+            }
+        }
+        void evaluatePure() {
+            packInputs();
+            unsigned long long h = hashKey(key.data(), key_words);
+            unsigned int* slot = findSlot(h, key.data());
+            if (*slot != NO_INDEX) {
+                hits++;
+                unsigned int n = *slot;
+                if (n != head) {
+                    unlink(n);
+                    pushFront(n);
+                }
+                writeOutputs(&results[n * outputs]);
+                return;
+            }
+            misses++;
+            unsigned short b = bits();
+            unsigned long long mask = b >= 64 ? ~0ULL : (1ULL << b) - 1;
+            for (unsigned short i = 0; i < inputs; i++) {
+                evaluator->setInput(input_wires[i].get(), wire_value_bits(read_pin(i)) & mask);
+            }
+            evaluator->evaluate();
+            unsigned int n;
+            if (nodes.size() < capacity) {
+                n = (unsigned int)nodes.size();
+                nodes.push_back({h, NO_INDEX, NO_INDEX});
+                keys.resize(keys.size() + key_words);
+                results.resize(results.size() + outputs);
+            } else {
+                n = tail;
+                unlink(n);
+                unsigned int* old = findSlot(nodes[n].hash, &keys[n * key_words]);
+                eraseSlot((size_t)(old - slots.data()));
+                evictions++;
+                slot = findSlot(h, key.data());
+                nodes[n].hash = h;
+            }
+            std::copy(key.begin(), key.end(), keys.begin() + n * key_words);
+            for (unsigned short i = 0; i < outputs; i++) {
+                results[n * outputs + i] = evaluator->getValue(output_wires[i].get()) & mask;
+            }
+            *slot = n;
+            pushFront(n);
+            writeOutputs(&results[n * outputs]);
+        }
+    protected:
+        virtual void update() override {
+            if (pure) {
+                evaluatePure();
+                return;
+            }
+            for (unsigned short i = 0; i < inputs; i++) drivers[i]->drive(read_pin(i));
+        }
+    public:
+        virtual const char* getObjectType() override {
+            return "SubCircuit";
+        }
+        SubCircuit(unsigned short inputs, unsigned short outputs) : ConfigurableBasicGate(inputs, outputs), inputs(inputs), outputs(outputs) {
+            for (unsigned short i = 0; i < inputs; i++) {
+                input_wires.emplace_back(new Wire());
+                drivers.emplace_back(new PortDriver());
+                connect(drivers.back()->getPin(0), input_wires.back().get());
+            }
+            for (unsigned short i = 0; i < outputs; i++) {
+                output_wires.emplace_back(new Wire());
+                probes.emplace_back(new PortProbe(this, i));
+                connect(probes.back()->getPin(0), output_wires.back().get());
+            }
+        }
+        Wire* getInputWire(unsigned short i) {
+            return input_wires[i].get();
+        }
+        Wire* getOutputWire(unsigned short i) {
+            return output_wires[i].get();
+        }
+        void add(BasicGate* g) {
+            gates.push_back(g);
+            if (pure) setPure(capacity);
+        }
+        const vector<BasicGate*>& getGates() {
+            return gates;
+        }
+        // capacity 0 turns caching off and goes back to event-driven evaluation
+        void setPure(size_t entries) {
+            clearCache();
+            evaluator.reset();
+            netlist.reset();
+            pure = entries != 0;
+            capacity = entries;
+            if (!pure) return;
+            for (auto g : gates) {
+                if (g->isSequential() || g->getLogicFunction() == LogicFunction::NONE)
+                    throw LogicSimException("A pure SubCircuit may only contain combinational logic gates", g);
+            }
+            netlist.reset(new Netlist(gates));
+            evaluator.reset(new CycleSimulator(*netlist));
+            key_bits = 0;
+            size_t n = 1;
+            while (n < capacity * 2) n <<= 1;
+            slots.assign(n, NO_INDEX);
+            nodes.reserve(capacity);
+        }
+        bool isPure() {
+            return pure;
+        }
+        void clearCache() {
+            nodes.clear();
+            keys.clear();
+            results.clear();
+            std::fill(slots.begin(), slots.end(), NO_INDEX);
+            head = tail = NO_INDEX;
+        }
+        unsigned long long getHits() {
+            return hits;
+        }
+        unsigned long long getMisses() {
+            return misses;
+        }
+        unsigned long long getEvictions() {
+            return evictions;
+        }
+        double hitRate() {
+            unsigned long long n = hits + misses;
+            return n == 0 ? 0.0 : (double)hits / (double)n;
+        }
+        void resetStatistics() {
+            hits = misses = evictions = 0;
+        }
+    };
+};
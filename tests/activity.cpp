@@ -0,0 +1,104 @@
+// switching activity: quiet nets are reported, late nets count from the start,
+// an existing change hook is chained, and reset keeps cycle-mode widths
+#include <string>
+
+#include "main_init.hpp"
+#include "digitallogicgates.hpp"
+#include "netlist.hpp"
+#include "mainsim.hpp"
+#include "cyclesim.hpp"
+#include "activity.hpp"
+
+#include "check.hpp"
+
+using namespace LogicSim;
+
+class Driver final : public BasicGate {
+protected:
+    virtual void update() override {};
+public:
+    Driver() : BasicGate(0, 1) {};
+    virtual const char* getObjectType() override {
+        return "Driver";
+    }
+    void drive(WireStateValue v) {
+        write_pin(0, v);
+    }
+};
+
+static void raise(void* instance) {
+    ((Driver*)instance)->drive(WireStateValue(true));
+}
+static void lower(void* instance) {
+    ((Driver*)instance)->drive(WireStateValue(false));
+}
+static unsigned int hooked = 0;
+static void onHook(Wire*, unsigned short, unsigned long long, unsigned long long) {
+    hooked++;
+}
+
+int main() {
+    Wire x, quiet, late;
+    Driver dx, dquiet, dlate;
+    DigitalLogic::BufferGate buf;
+    connect(dx.getPin(0), &x);
+    connect(dquiet.getPin(0), &quiet);
+    connect(buf.getPin(0), &quiet);
+    connect(dlate.getPin(0), &late);
+    dx.drive(WireStateValue(false));
+    dquiet.drive(WireStateValue(true));
+    dlate.drive(WireStateValue(true));
+    Netlist net({&dx, &dquiet, &buf});
+
+    MainSim sim;
+    ActivityCollector act(&sim);
+    wire_change_hook = onHook;
+    act.start(net);
+    act.setName(&quiet, "quiet");
+    sim.schedule(10, raise, &dx);
+    // late is not in the netlist; it held 1 from the start until 20
+    sim.schedule(20, lower, &dlate);
+    sim.runUntil(30);
+    act.stop();
+    CHECK_EQ(hooked, 2);
+    CHECK(wire_change_hook == onHook);
+    wire_change_hook = nullptr;
+
+    CHECK_EQ(act.getDuration(), 30);
+    CHECK_EQ(act.getRises(&x), 1);
+    CHECK_EQ(act.getHighTime(&x), 20);
+    CHECK_EQ(act.getRises(&quiet) + act.getFalls(&quiet), 0);
+    CHECK_EQ(act.getHighTime(&quiet), 30);
+    CHECK_EQ(act.getFalls(&late), 1);
+    CHECK_EQ(act.getHighTime(&late), 20);
+
+    StateWriter out;
+    act.writeSAIF(out);
+    std::string saif(out.data(), out.size());
+    CHECK(saif.find("(quiet (T0 0) (T1 30) (TC 0) (IG 0))") != std::string::npos);
+
+    // a reset while the bus holds 0xFF still knows it is 8 bits wide
+    Wire bus, bit;
+    DigitalLogic::BufferGate cbuf;
+    connect(cbuf.getPin(0), &bus);
+    connect(cbuf.getPin(1), &bit);
+    Netlist cnet({&cbuf});
+    CycleSimulator cs(cnet);
+    ActivityCollector cact;
+    cs.setInput(&bus, 0);
+    cs.evaluate();
+    cact.sample(cs, cnet);
+    cs.setInput(&bus, 0xFF);
+    cs.evaluate();
+    cact.sample(cs, cnet);
+    cact.reset();
+    cact.setName(&bus, "bus");
+    cs.setInput(&bus, 1);
+    cs.evaluate();
+    cact.sample(cs, cnet);
+    StateWriter cycle_out;
+    cact.writeSAIF(cycle_out);
+    std::string csaif(cycle_out.data(), cycle_out.size());
+    CHECK(csaif.find("(bus (T0 7) (T1 1) (TC 7) (IG 0))") != std::string::npos);
+    return test_result();
+}
@@ -0,0 +1,99 @@
+// structural optimization: merged, constant and dead logic counts, and the
+// observed outputs unchanged by optimize()
+#include <vector>
+
+#include "main_init.hpp"
+#include "digitallogicgates.hpp"
+#include "netlist.hpp"
+#include "aig.hpp"
+
+#include "check.hpp"
+
+using namespace LogicSim;
+
+class Driver final : public BasicGate {
+protected:
+    virtual void update() override {};
+public:
+    Driver() : BasicGate(0, 1) {};
+    virtual const char* getObjectType() override {
+        return "Driver";
+    }
+    void drive(WireStateValue v) {
+        write_pin(0, v);
+    }
+};
+
+static Driver da, db, dc;
+static void apply(int v) {
+    da.drive(WireStateValue((bool)(v & 1)));
+    db.drive(WireStateValue((bool)(v & 2)));
+    dc.drive(WireStateValue((bool)(v & 4)));
+}
+
+int main() {
+    // w1 = a & b and w2 = b & a hash to one node; w3 = a ^ a and
+    // w5 = a & !a are constant; y = w2 | w3 is w1 again and z = w5 | c is c
+    Wire a, b, c, w1, w2, w3, wn, w5, y, z;
+    DigitalLogic::AndGate g1, g2, g5;
+    DigitalLogic::XorGate g3;
+    DigitalLogic::NotGate n;
+    DigitalLogic::OrGate gy, gz;
+    connect(da.getPin(0), &a);
+    connect(db.getPin(0), &b);
+    connect(dc.getPin(0), &c);
+    connect(g1.getPin(0), &a);
+    connect(g1.getPin(1), &b);
+    connect(g1.getPin(2), &w1);
+    connect(g2.getPin(0), &b);
+    connect(g2.getPin(1), &a);
+    connect(g2.getPin(2), &w2);
+    connect(g3.getPin(0), &a);
+    connect(g3.getPin(1), &a);
+    connect(g3.getPin(2), &w3);
+    connect(n.getPin(0), &a);
+    connect(n.getPin(1), &wn);
+    connect(g5.getPin(0), &a);
+    connect(g5.getPin(1), &wn);
+    connect(g5.getPin(2), &w5);
+    connect(gy.getPin(0), &w2);
+    connect(gy.getPin(1), &w3);
+    connect(gy.getPin(2), &y);
+    connect(gz.getPin(0), &w5);
+    connect(gz.getPin(1), &c);
+    connect(gz.getPin(2), &z);
+    Netlist net({&da, &db, &dc, &g1, &g2, &g3, &n, &g5, &gy, &gz});
+
+    std::vector<bool> ys, zs;
+    for (int v = 0; v < 8; v++) {
+        apply(v);
+        ys.push_back(y.getState(0).b);
+        zs.push_back(z.getState(0).b);
+        CHECK_EQ(ys.back(), (v & 3) == 3);
+        CHECK_EQ(zs.back(), (v & 4) != 0);
+    }
+
+    StructuralOptimizer opt(net);
+    StructuralReport r = opt.optimize();
+    CHECK_EQ(r.gates_before, 10);
+    CHECK_EQ(r.merged_wires, 2);
+    CHECK_EQ(r.constant_wires, 2);
+    // g2, g3, gy, n and g5 have no observable reader left
+    CHECK_EQ(r.removed_gates, 5);
+    CHECK_EQ(r.gates_after, 6);
+    CHECK(net.gateIndex(&g1) != NO_INDEX);
+    CHECK(net.gateIndex(&gz) != NO_INDEX);
+    CHECK_EQ(net.gateIndex(&gy), NO_INDEX);
+    CHECK(opt.observe(&y) == &w1);
+    CHECK(opt.observe(&z) == &z);
+    CHECK_EQ(opt.literalOf(&w1), opt.literalOf(&y));
+
+    Wire* oy = opt.observe(&y);
+    Wire* oz = opt.observe(&z);
+    for (int v = 0; v < 8; v++) {
+        apply(v);
+        CHECK_EQ(oy->getState(0).b, ys[v]);
+        CHECK_EQ(oz->getState(0).b, zs[v]);
+    }
+    return test_result();
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstdio>
+#include <type_traits>
+
+// Minimal assertion support for the test executables: CHECK records a
+// failure and keeps going, and main returns test_result(). CHECK_EQ
+// compares in the common type of its operands, so mixed signedness is
+// converted once instead of warned about at every use.
+inline int test_failures = 0;
+
+#define CHECK(cond) \
+    do { \
+        if (!(cond)) { \
+            std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+            test_failures++; \
+        } \
+    } while (0)
+
+#define CHECK_EQ(a, b) \
+    do { \
+        auto check_a_ = (a); \
+        auto check_b_ = (b); \
+        typedef std::common_type_t<decltype(check_a_), decltype(check_b_)> check_t_; \
+        if (!((check_t_)check_a_ == (check_t_)check_b_)) { \
+            std::fprintf(stderr, "%s:%d: CHECK_EQ(%s, %s) failed: %llu != %llu\n", __FILE__, __LINE__, #a, #b, \
+                (unsigned long long)check_a_, (unsigned long long)check_b_); \
+            test_failures++; \
+        } \
+    } while (0)
+
+inline int test_result() {
+    if (test_failures != 0) std::fprintf(stderr, "%d check(s) failed\n", test_failures);
+    return test_failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,26 @@
+// config keys: literal keys are named once stored, placeholders are not kept
+#include <memory>
+
+#include "main_init.hpp"
+#include "numberconfigentries.hpp"
+
+#include "check.hpp"
+
+using namespace LogicSim;
+
+int main() {
+    constexpr ConfigKey custom = "CustomLiteralKey";
+    size_t known = config_key_names().size();
+    CHECK(config_key_name(custom.id) != "CustomLiteralKey");
+    CHECK_EQ(config_key_names().size(), known);
+
+    ConfigTable table;
+    table.insert(custom, std::unique_ptr<ConfigEntry>(new UShortConfigEntry(3)));
+    CHECK(config_key_name(custom.id) == "CustomLiteralKey");
+    CHECK_EQ(config_key_names().size(), known + 1);
+    CHECK(table.toString().find("CustomLiteralKey:3") != string::npos);
+
+    CHECK(config_key_name(ConfigKeys::Bits.id) == "Bits");
+    CHECK(ConfigKey(string("CustomLiteralKey")) == custom);
+    return test_result();
+}
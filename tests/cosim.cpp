@@ -0,0 +1,147 @@
+// conservative co-simulation: data messages carry now + lookahead, and two
+// partitions with the smallest lookahead run against each other
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "main_init.hpp"
+#include "mainsim.hpp"
+#include "watchpoints.hpp"
+#include "cosim.hpp"
+
+#include "check.hpp"
+
+using namespace LogicSim;
+
+static void raise(void* instance) {
+    ((BoundaryGate*)instance)->drive(WireStateValue((unsigned long long)1));
+}
+
+struct Echo {
+    CosimRegion* region;
+    SimTime seen = NEVER;
+    MainSim* sim = nullptr;
+};
+static void onEcho(void* instance, Wire*, unsigned long long value) {
+    Echo* e = (Echo*)instance;
+    if (value == 1 && e->seen == NEVER) e->seen = e->sim->getTime();
+}
+// rank 0 raises a at 10; rank 1 imports it and exports it straight back as b
+static void partition(unsigned int rank, void* instance) {
+    Echo* e = (Echo*)instance;
+    alarm(20);
+    MainSim sim;
+    e->sim = &sim;
+    CosimPartition p(*e->region, sim, rank, 1);
+    Wire a, b;
+    BoundaryGate source;
+    if (rank == 0) {
+        connect(source.getPin(0), &a);
+        source.drive(WireStateValue((unsigned long long)0));
+        sim.schedule(10, raise, &source);
+        p.exportWire(&a, 1, {1});
+        p.importWire(&b, 2);
+        watch_change(&b, onEcho, e);
+    } else {
+        p.importWire(&a, 1);
+        p.exportWire(&a, 2, {0});
+    }
+    p.run(100);
+    if (rank == 1) _exit(sim.getTime() == 100 && a.getState(0).ll == 1 ? 0 : 1);
+}
+
+int main() {
+    const SimTime L = 5;
+    std::string name = "/lsim_test_cosim_" + std::to_string((long long)getpid());
+    CosimRegion region(name, 2, 64);
+
+    bool thrown = false;
+    try {
+        CosimRegion again(name, 2, 64);
+    } catch (Exceptions::CosimError&) {
+        thrown = true;
+    }
+    CHECK(thrown);
+
+    // partition 0 drives an exported wire to 1 at time 10
+    MainSim sim0;
+    Wire out;
+    BoundaryGate source;
+    connect(source.getPin(0), &out);
+    source.drive(WireStateValue((unsigned long long)0));
+    CosimPartition p0(region, sim0, 0, L);
+    p0.exportWire(&out, 7, {1});
+    sim0.schedule(10, raise, &source);
+    // partition 1 has promised nothing before 100
+    region.channel(1, 0).push({100, 0, CosimMessage::NULL_MESSAGE, 0});
+    p0.run(50);
+    CHECK_EQ(sim0.getTime(), 50);
+
+    std::vector<CosimMessage> seen;
+    CosimChannel to1 = region.channel(0, 1);
+    CosimMessage m;
+    while (to1.pop(m)) seen.push_back(m);
+    // the rise at 10 goes out stamped 10 + L, not with the end of the run
+    CHECK_EQ(seen.size(), 5);
+    if (seen.size() == 5) {
+        CHECK(!(seen[0].flags & CosimMessage::NULL_MESSAGE));
+        CHECK_EQ(seen[0].time, L);
+        CHECK_EQ(seen[0].value, 0);
+        CHECK(seen[1].flags & CosimMessage::NULL_MESSAGE);
+        CHECK_EQ(seen[1].time, L);
+        CHECK(!(seen[2].flags & CosimMessage::NULL_MESSAGE));
+        CHECK_EQ(seen[2].time, 10 + L);
+        CHECK_EQ(seen[2].wire, 7);
+        CHECK_EQ(seen[2].value, 1);
+        CHECK(seen[3].flags & CosimMessage::NULL_MESSAGE);
+        CHECK_EQ(seen[3].time, 10 + L);
+        CHECK_EQ(seen[4].time, 50 + L);
+    }
+
+    // partition 1 must not apply the second value before its stamp
+    MainSim sim1;
+    Wire in;
+    CosimPartition p1(region, sim1, 1, L);
+    p1.importWire(&in, 7);
+    for (auto& s : seen) to1.push(s);
+    p1.run(10 + L - 1);
+    CHECK_EQ(in.getState(0).ll, 0);
+    region.channel(0, 1).push({100, 0, CosimMessage::NULL_MESSAGE, 0});
+    p1.run(60);
+    CHECK_EQ(in.getState(0).ll, 1);
+    CHECK_EQ(p1.getReceived(), 6);
+
+    thrown = false;
+    try {
+        CosimPartition zero(region, sim1, 1, 0);
+    } catch (Exceptions::CosimError&) {
+        thrown = true;
+    }
+    CHECK(thrown);
+
+    // a segment that is not a region is rejected (and unmapped)
+    std::string other = name + "_other";
+    int fd = shm_open(other.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    CHECK(fd >= 0);
+    CHECK_EQ(ftruncate(fd, 4096), 0);
+    close(fd);
+    thrown = false;
+    try {
+        CosimRegion bogus(other);
+    } catch (Exceptions::CosimError&) {
+        thrown = true;
+    }
+    CHECK(thrown);
+    shm_unlink(other.c_str());
+
+    // lookahead 1 in both directions: a round trip takes exactly 2 ticks
+    CosimRegion shared(name + "_pair", 2, 64);
+    Echo echo;
+    echo.region = &shared;
+    CHECK_EQ(run_partitions(2, partition, &echo), 0);
+    CHECK_EQ(echo.seen, 12);
+    return test_result();
+}
@@ -0,0 +1,70 @@
+// cycle-based simulation: input settling, slots after a recompile, default
+// widths and config changes patched into the tape
+#include "main_init.hpp"
+#include "digitallogicgates.hpp"
+#include "numberconfigentries.hpp"
+#include "netlist.hpp"
+#include "cyclesim.hpp"
+
+#include "check.hpp"
+
+using namespace LogicSim;
+
+int main() {
+    // a -> not -> d -> register -> q; the not's second copy has no output wire
+    Wire a, d, q;
+    DigitalLogic::NotGate inv, dangling;
+    DigitalLogic::RegisterGate reg;
+    connect(inv.getPin(0), &a);
+    connect(inv.getPin(1), &d);
+    connect(dangling.getPin(0), &a);
+    connect(reg.getPin(0), &d);
+    connect(reg.getPin(2), &q);
+    Netlist net({&inv, &dangling, &reg});
+    CycleSimulator sim(net);
+
+    // no evaluate() between setting the input and the clock edge
+    sim.setInput(&a, 0);
+    sim.cycle();
+    CHECK_EQ(sim.getValue(&q), 1);
+    sim.setInput(&a, 1);
+    sim.cycle();
+    CHECK_EQ(sim.getValue(&q), 0);
+
+    // new wires take over the old zero and scratch slots and must start at 0
+    sim.setInput(&a, 0);
+    sim.evaluate();
+    Wire n1, n2, n3;
+    DigitalLogic::AndGate both;
+    connect(both.getPin(0), &n1);
+    connect(both.getPin(1), &n2);
+    connect(both.getPin(2), &n3);
+    net.addGate(&both);
+    sim.evaluate();
+    CHECK_EQ(sim.getValue(&n1), 0);
+    CHECK_EQ(sim.getValue(&n2), 0);
+    CHECK_EQ(sim.getValue(&n3), 0);
+    CHECK_EQ(sim.getValue(&d), 1);
+
+    // a register without "Bits" keeps all 64 bits, as RegisterGate does
+    Wire wide, wq;
+    DigitalLogic::RegisterGate wreg;
+    connect(wreg.getPin(0), &wide);
+    connect(wreg.getPin(2), &wq);
+    net.addGate(&wreg);
+    sim.setInput(&wide, 0x123456789ABCDEFULL);
+    sim.cycle();
+    CHECK_EQ(sim.getValue(&wq), 0x123456789ABCDEFULL);
+
+    // widening the inverter only patches its op; its reader sees 8 bits
+    inv.config_table.insert(ConfigKeys::Bits, std::unique_ptr<ConfigEntry>(new UShortConfigEntry(8)));
+    net.gateChanged(&inv);
+    sim.setInput(&a, 0);
+    sim.evaluate();
+    CHECK_EQ(sim.getValue(&d), 0xFF);
+    reg.config_table.insert(ConfigKeys::Bits, std::unique_ptr<ConfigEntry>(new UShortConfigEntry(4)));
+    net.gateChanged(&reg);
+    sim.cycle();
+    CHECK_EQ(sim.getValue(&q), 0xF);
+    return test_result();
+}
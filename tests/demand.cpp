@@ -0,0 +1,103 @@
+// demand-driven evaluation: dirty state follows netlist edits, unread
+// cones cost nothing, and clocked designs match CycleSimulator
+#include "main_init.hpp"
+#include "digitallogicgates.hpp"
+#include "netlist.hpp"
+#include "cyclesim.hpp"
+#include "demand.hpp"
+
+#include "check.hpp"
+
+using namespace LogicSim;
+
+int main() {
+    // a -> n1 -> b, and n2 (b -> c) joins the netlist later
+    Wire a, b, c;
+    DigitalLogic::NotGate n1, n2;
+    connect(n1.getPin(0), &a);
+    connect(n1.getPin(1), &b);
+    connect(n2.getPin(0), &b);
+    connect(n2.getPin(1), &c);
+    Netlist net({&n1});
+    DemandEvaluator eval(net);
+
+    eval.setInput(&a, 1);
+    CHECK(eval.isDirty(&b));
+    CHECK_EQ(eval.getValue(&b) & 1, 0);
+    CHECK(!eval.isDirty(&b));
+
+    // the new gate's output has never been evaluated
+    net.addGate(&n2);
+    CHECK(eval.isDirty(&c));
+    CHECK_EQ(eval.getValue(&c) & 1, 1);
+    CHECK(!eval.isDirty(&c));
+
+    // x -> p1 -> p2 -> p3 is never read while b is
+    Wire x, p1, p2, p3;
+    DigitalLogic::NotGate i1, i2, i3;
+    connect(i1.getPin(0), &x);
+    connect(i1.getPin(1), &p1);
+    connect(i2.getPin(0), &p1);
+    connect(i2.getPin(1), &p2);
+    connect(i3.getPin(0), &p2);
+    connect(i3.getPin(1), &p3);
+    net.addGate(&i1);
+    net.addGate(&i2);
+    net.addGate(&i3);
+    eval.getValue(&b);
+    eval.resetStatistics();
+    eval.setInput(&a, 0);
+    eval.setInput(&x, 1);
+    CHECK_EQ(eval.getValue(&b) & 1, 1);
+    CHECK_EQ(eval.getEvaluations(), 1);
+    // only b is marked: c and the unread cone are still dirty from the
+    // recompile after addGate
+    CHECK_EQ(eval.getInvalidations(), 1);
+    CHECK(eval.isDirty(&p3));
+
+    // reading the cone end evaluates it once; after a new input, reading
+    // its head leaves the rest dirty
+    CHECK_EQ(eval.getValue(&p3) & 1, 0);
+    CHECK_EQ(eval.getEvaluations(), 4);
+    eval.resetStatistics();
+    eval.setInput(&x, 0);
+    CHECK_EQ(eval.getInvalidations(), 3);
+    CHECK_EQ(eval.getValue(&p1) & 1, 1);
+    CHECK_EQ(eval.getEvaluations(), 1);
+    CHECK(eval.isDirty(&p2));
+    CHECK(eval.isDirty(&p3));
+
+    // a two-bit counter with a carry, clocked by both evaluators
+    Wire q0, q1, d0, d1, carry;
+    DigitalLogic::RegisterGate r0, r1;
+    DigitalLogic::NotGate toggle;
+    DigitalLogic::XorGate sum;
+    DigitalLogic::AndGate both;
+    connect(toggle.getPin(0), &q0);
+    connect(toggle.getPin(1), &d0);
+    connect(sum.getPin(0), &q0);
+    connect(sum.getPin(1), &q1);
+    connect(sum.getPin(2), &d1);
+    connect(both.getPin(0), &q0);
+    connect(both.getPin(1), &q1);
+    connect(both.getPin(2), &carry);
+    connect(r0.getPin(0), &d0);
+    connect(r0.getPin(2), &q0);
+    connect(r1.getPin(0), &d1);
+    connect(r1.getPin(2), &q1);
+    Netlist counter({&toggle, &sum, &both, &r0, &r1});
+    DemandEvaluator lazy(counter);
+    CycleSimulator full(counter);
+    bool same = true;
+    for (int i = 0; i < 10; i++) {
+        lazy.cycle();
+        full.cycle();
+        full.evaluate();
+        same = same && lazy.getValue(&q0) == full.getValue(&q0) && lazy.getValue(&q1) == full.getValue(&q1)
+            && lazy.getValue(&carry) == full.getValue(&carry);
+        CHECK_EQ(lazy.getValue(&q0) | lazy.getValue(&q1) << 1, (unsigned long long)(i + 1) % 4);
+    }
+    CHECK(same);
+    CHECK_EQ(lazy.getCycles(), 10);
+    return test_result();
+}
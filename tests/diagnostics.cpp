@@ -0,0 +1,83 @@
+// conflicts and lookup errors: policies, deferred messages
+#include <cstring>
+
+#include "main_init.hpp"
+
+#include "check.hpp"
+
+using namespace LogicSim;
+
+class Driver final : public BasicGate {
+protected:
+    virtual void update() override {};
+public:
+    Driver() : BasicGate(0, 1) {};
+    virtual const char* getObjectType() override {
+        return "Driver";
+    }
+    void drive(WireStateValue v) {
+        write_pin(0, v);
+    }
+};
+
+int main() {
+    Wire w;
+    Driver a, b;
+    connect(a.getPin(0), &w);
+    connect(b.getPin(0), &w);
+
+    a.drive(WireStateValue(true));
+    CHECK(w.getState(0).b);
+    CHECK_EQ(diagnostics.count(DiagnosticCode::SHORT_CIRCUIT), 0);
+
+    bool thrown = false;
+    try {
+        b.drive(WireStateValue(false));
+    } catch (Exceptions::ShortCircuitError& e) {
+        thrown = true;
+        CHECK(std::strstr(e.what(), "short circuit") != nullptr);
+        CHECK(std::strstr(e.what(), "Wire:") != nullptr);
+    }
+    CHECK(thrown);
+    CHECK_EQ(diagnostics.count(DiagnosticCode::SHORT_CIRCUIT), 1);
+
+    diagnostics.setPolicy(DiagnosticCode::SHORT_CIRCUIT, DiagnosticPolicy::COUNT);
+    a.drive(WireStateValue(false));
+    CHECK_EQ(diagnostics.count(DiagnosticCode::SHORT_CIRCUIT), 2);
+    CHECK_EQ(diagnostics.size(), 1);
+    diagnostics.setPolicy(DiagnosticCode::SHORT_CIRCUIT, DiagnosticPolicy::THROW);
+
+    ConfigTable table;
+    thrown = false;
+    try {
+        table[string("Missing")];
+    } catch (Exceptions::InvalidKeyError& e) {
+        thrown = true;
+        CHECK(std::strstr(e.what(), "Missing") != nullptr);
+        CHECK(std::strstr(e.what(), "ConfigTable") != nullptr);
+    }
+    CHECK(thrown);
+    CHECK_EQ(diagnostics.count(DiagnosticCode::INVALID_KEY), 1);
+    CHECK(diagnostics.snapshot().back().code == DiagnosticCode::INVALID_KEY);
+    CHECK(diagnostics.snapshot().back().obj == &table);
+
+    // a lookup has nothing to return, so it still throws; the policy only
+    // decides whether a record is kept
+    diagnostics.setPolicy(DiagnosticCode::INVALID_KEY, DiagnosticPolicy::COUNT);
+    size_t records = diagnostics.size();
+    thrown = false;
+    try {
+        table[string("Missing")];
+    } catch (Exceptions::InvalidKeyError&) {
+        thrown = true;
+    }
+    CHECK(thrown);
+    CHECK_EQ(diagnostics.count(DiagnosticCode::INVALID_KEY), 2);
+    CHECK_EQ(diagnostics.size(), records);
+    diagnostics.setPolicy(DiagnosticCode::INVALID_KEY, DiagnosticPolicy::THROW);
+
+    Exceptions::UnexpectedWireValueTypeError e(&w, WireStateValueType::BIT, WireStateValueType::FLOAT);
+    CHECK(std::strcmp(e.what(), e.what()) == 0);
+    CHECK(std::strstr(e.what(), "BIT expected, but got FLOAT") != nullptr);
+    return test_result();
+}
@@ -0,0 +1,88 @@
+// events: handlers run on the firing thread, may connect and disconnect
+// while firing, and may disconnect after (or while) the event is destroyed
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "main_init.hpp"
+
+#include "check.hpp"
+
+struct Counter {
+    int calls = 0;
+    int last = 0;
+    std::thread::id thread;
+    std::shared_ptr<EventHandler<int>> self;
+    Event<int>* event = nullptr;
+    Counter* spawn = nullptr;
+};
+static void onCount(void* instance, int v) {
+    Counter* c = (Counter*)instance;
+    c->calls++;
+    c->last = v;
+    c->thread = std::this_thread::get_id();
+}
+// disconnects itself and connects spawn, from inside the firing
+static void onceThenHandOver(void* instance, int v) {
+    Counter* c = (Counter*)instance;
+    onCount(instance, v);
+    c->self->Disconnect();
+    if (c->spawn != nullptr) c->spawn->self = c->event->Connect(onCount, c->spawn);
+}
+
+int main() {
+    Event<int> e;
+    Counter a, b;
+    auto ha = e.Connect(onCount, &a);
+    a.self = ha;
+    CHECK_EQ(e.HandlerCount(), 1);
+    e.createCaller()(7);
+    CHECK_EQ(a.calls, 1);
+    CHECK_EQ(a.last, 7);
+    CHECK(a.thread == std::this_thread::get_id());
+
+    Counter once;
+    once.event = &e;
+    once.spawn = &b;
+    once.self = e.Connect(onceThenHandOver, &once);
+    e.createCaller()(8);
+    CHECK_EQ(once.calls, 1);
+    CHECK(!once.self->Connected());
+    // b joined during the firing, so it only sees the next one
+    CHECK_EQ(b.calls, 0);
+    e.createCaller()(9);
+    CHECK_EQ(once.calls, 1);
+    CHECK_EQ(b.calls, 1);
+    CHECK_EQ(a.calls, 3);
+    CHECK_EQ(e.HandlerCount(), 2);
+
+    ha->Disconnect();
+    e.createCaller()(10);
+    CHECK_EQ(a.calls, 3);
+    CHECK_EQ(e.HandlerCount(), 1);
+
+    // a handler outliving its event disconnects as a no-op
+    std::shared_ptr<EventHandler<int>> orphan;
+    {
+        Event<int> gone;
+        Counter c;
+        orphan = gone.Connect(onCount, &c);
+    }
+    CHECK(!orphan->Connected());
+    orphan->Disconnect();
+
+    // Disconnect racing ~Event
+    for (int round = 0; round < 50; round++) {
+        std::unique_ptr<Event<int>> racing(new Event<int>());
+        Counter c;
+        std::vector<std::shared_ptr<EventHandler<int>>> handlers;
+        for (int i = 0; i < 64; i++) handlers.push_back(racing->Connect(onCount, &c));
+        std::thread t([&handlers]() {
+            for (auto& h : handlers) h->Disconnect();
+        });
+        racing.reset();
+        t.join();
+        for (auto& h : handlers) CHECK(!h->Connected());
+    }
+    return test_result();
+}
@@ -0,0 +1,119 @@
+// stuck-at fault simulation: detection per pattern and coverage, redundant
+// faults, and the same result on any number of threads
+#include <memory>
+#include <vector>
+
+#include "main_init.hpp"
+#include "digitallogicgates.hpp"
+#include "netlist.hpp"
+#include "random.hpp"
+#include "faultsim.hpp"
+
+#include "check.hpp"
+
+using namespace LogicSim;
+
+// pattern in the order of getInputs() from values per wire
+static std::vector<bool> pattern(FaultSimulator& sim, Netlist& net, const std::vector<std::pair<Wire*, bool>>& values) {
+    std::vector<bool> p(sim.getInputs().size(), false);
+    for (size_t i = 0; i < p.size(); i++) {
+        for (auto& v : values) {
+            if (net.wireIndex(v.first) == sim.getInputs()[i]) p[i] = v.second;
+        }
+    }
+    return p;
+}
+
+int main() {
+    // y = a & b: 11 finds both inputs and the output stuck at 0, 01 finds
+    // a and the output stuck at 1, 10 finds b stuck at 1
+    Wire a, b, y;
+    DigitalLogic::AndGate g;
+    connect(g.getPin(0), &a);
+    connect(g.getPin(1), &b);
+    connect(g.getPin(2), &y);
+    Netlist net({&g});
+    FaultSimulator sim(net);
+    CHECK_EQ(sim.getFaults().size(), 6);
+    CHECK_EQ(sim.getInputs().size(), 2);
+    std::vector<std::vector<bool>> patterns = {
+        pattern(sim, net, {{&a, true}, {&b, true}}),
+        pattern(sim, net, {{&a, false}, {&b, true}}),
+        pattern(sim, net, {{&a, true}, {&b, false}}),
+    };
+    FaultCoverageReport r = sim.run(patterns);
+    CHECK_EQ(r.total, 6);
+    CHECK_EQ(r.detected, 6);
+    CHECK(r.coverage() == 1.0);
+    CHECK(r.detected_after_pattern == std::vector<size_t>({3, 5, 6}));
+    // faults are listed per pin, stuck-at-0 first
+    CHECK(r.detected_by == std::vector<long long>({0, 1, 0, 2, 0, 1}));
+    CHECK(sim.getFaults()[3].pin == g.getPin(1));
+    CHECK(sim.getFaults()[3].stuck_at);
+
+    r = sim.run({patterns[0]});
+    CHECK_EQ(r.detected, 3);
+    CHECK(r.coverage() == 0.5);
+
+    // z = a | (a & b): the AND output stuck at 0 is redundant
+    Wire p, q, m, z;
+    DigitalLogic::AndGate and2;
+    DigitalLogic::OrGate or2;
+    connect(and2.getPin(0), &p);
+    connect(and2.getPin(1), &q);
+    connect(and2.getPin(2), &m);
+    connect(or2.getPin(0), &p);
+    connect(or2.getPin(1), &m);
+    connect(or2.getPin(2), &z);
+    Netlist redundant({&and2, &or2});
+    FaultSimulator rs(redundant);
+    std::vector<std::vector<bool>> all;
+    for (int v = 0; v < 4; v++) all.push_back({(v & 1) != 0, (v & 2) != 0});
+    r = rs.run(all);
+    CHECK(r.detected < r.total);
+    for (size_t i = 0; i < rs.getFaults().size(); i++) {
+        const Fault& f = rs.getFaults()[i];
+        if (f.pin == and2.getPin(2) && !f.stuck_at) CHECK_EQ(r.detected_by[i], -1);
+    }
+
+    // a random circuit with several 63-fault batches
+    const int inputs = 8;
+    Wire in[inputs];
+    std::vector<std::unique_ptr<Wire>> wires;
+    std::vector<std::unique_ptr<BasicGate>> gates;
+    std::vector<Wire*> pool;
+    for (auto& w : in) pool.push_back(&w);
+    RandomStream pick(17);
+    for (int i = 0; i < 60; i++) {
+        BasicGate* x;
+        switch (i % 4) {
+        case 0: x = new DigitalLogic::AndGate(); break;
+        case 1: x = new DigitalLogic::OrGate(); break;
+        case 2: x = new DigitalLogic::XorGate(); break;
+        default: x = new DigitalLogic::NandGate(); break;
+        }
+        gates.emplace_back(x);
+        for (size_t k = 0; k < x->getInputCount(); k++) connect(x->getInputPin(k), pool[pick.below(pool.size())]);
+        wires.emplace_back(new Wire());
+        connect(x->getOutputPin(0), wires.back().get());
+        pool.push_back(wires.back().get());
+    }
+    std::vector<BasicGate*> list;
+    for (auto& x : gates) list.push_back(x.get());
+    Netlist big(list);
+    FaultSimulator one(big), four(big);
+    CHECK(one.getFaults().size() > 3 * 63);
+    std::vector<std::vector<bool>> stim(32, std::vector<bool>(one.getInputs().size()));
+    for (auto& s : stim) {
+        for (size_t i = 0; i < s.size(); i++) s[i] = pick.bit();
+    }
+    one.setThreads(1);
+    four.setThreads(4);
+    FaultCoverageReport r1 = one.run(stim), r4 = four.run(stim);
+    CHECK(r1.detected > 0);
+    CHECK_EQ(r1.detected, r4.detected);
+    CHECK(r1.detected_by == r4.detected_by);
+    CHECK(r1.detected_after_pattern == r4.detected_after_pattern);
+    CHECK_EQ(r1.detected_after_pattern.back(), r1.detected);
+    return test_result();
+}
@@ -0,0 +1,30 @@
+// every header together in one translation unit
+#include "main_init.hpp"
+#include "digitallogicgates.hpp"
+#include "memorygates.hpp"
+#include "clockgate.hpp"
+#include "netlist.hpp"
+#include "cyclesim.hpp"
+#include "timing.hpp"
+#include "cosim.hpp"
+#include "partition.hpp"
+#include "stimulus.hpp"
+#include "serializer.hpp"
+#include "faultsim.hpp"
+#include "watchpoints.hpp"
+#include "vectorfile.hpp"
+#include "activity.hpp"
+#include "subcircuit.hpp"
+#include "aig.hpp"
+#include "resistive.hpp"
+#include "realtime.hpp"
+#include "random.hpp"
+#include "crand.hpp"
+#include "demand.hpp"
+#include "jit.hpp"
+
+#include "check.hpp"
+
+int main() {
+    return test_result();
+}
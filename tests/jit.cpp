@@ -0,0 +1,99 @@
+// native compilation: compiled and interpreted evaluation agree, cache reuse,
+// paths that would need shell quoting; exits 77 (skipped) without a compiler
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+#include "main_init.hpp"
+#include "digitallogicgates.hpp"
+#include "netlist.hpp"
+#include "cyclesim.hpp"
+#include "random.hpp"
+#include "jit.hpp"
+
+#include "check.hpp"
+
+using namespace LogicSim;
+
+int main() {
+    // every gate kind over a few inputs, with two registers fed back
+    const int inputs = 4;
+    Wire in[inputs], q0, q1;
+    std::vector<std::unique_ptr<Wire>> wires;
+    std::vector<std::unique_ptr<BasicGate>> gates;
+    std::vector<Wire*> pool = {&in[0], &in[1], &in[2], &in[3], &q0, &q1};
+    RandomStream pick(99);
+    for (int i = 0; i < 40; i++) {
+        BasicGate* g;
+        switch (i % 8) {
+        case 0: g = new DigitalLogic::AndGate(); break;
+        case 1: g = new DigitalLogic::OrGate(); break;
+        case 2: g = new DigitalLogic::XorGate(); break;
+        case 3: g = new DigitalLogic::NandGate(); break;
+        case 4: g = new DigitalLogic::NorGate(); break;
+        case 5: g = new DigitalLogic::XnorGate(); break;
+        case 6: g = new DigitalLogic::NotGate(); break;
+        default: g = new DigitalLogic::BufferGate(); break;
+        }
+        gates.emplace_back(g);
+        size_t n = g->getInputCount();
+        for (size_t k = 0; k < n; k++) connect(g->getInputPin(k), pool[pick.below(pool.size())]);
+        wires.emplace_back(new Wire());
+        connect(g->getOutputPin(0), wires.back().get());
+        pool.push_back(wires.back().get());
+    }
+    DigitalLogic::RegisterGate r0, r1;
+    connect(r0.getPin(0), pool[pool.size() - 1]);
+    connect(r0.getPin(2), &q0);
+    connect(r1.getPin(0), pool[pool.size() - 2]);
+    connect(r1.getPin(2), &q1);
+    std::vector<BasicGate*> all = {&r0, &r1};
+    for (auto& g : gates) all.push_back(g.get());
+    Netlist net(all);
+
+    CycleSimulator interpreted(net), native(net);
+    NativeCompiler jit("lsjit test's cache");
+    try {
+        jit.attach(native);
+    } catch (Exceptions::JitError& e) {
+        std::fprintf(stderr, "no native compiler, skipped: %s\n", e.what());
+        return 77;
+    }
+    CHECK(native.isNative());
+
+    RandomStream stim(5);
+    for (int c = 0; c < 64; c++) {
+        for (int i = 0; i < inputs; i++) {
+            unsigned long long v = stim.bit();
+            interpreted.setInput(&in[i], v);
+            native.setInput(&in[i], v);
+        }
+        interpreted.cycle();
+        native.cycle();
+        bool same = true;
+        for (Wire* w : pool) same = same && interpreted.getValue(w) == native.getValue(w);
+        CHECK(same);
+    }
+
+    // the same design again is served from the cache and replaces the handle
+    unsigned long long hash = jit.getHash();
+    jit.attach(native);
+    CHECK(jit.wasCached());
+    CHECK_EQ(jit.getHash(), hash);
+    CHECK(native.isNative());
+    native.evaluate();
+    interpreted.evaluate();
+    CHECK_EQ(native.getValue(&q0), interpreted.getValue(&q0));
+
+    // a compiler that cannot be started is an error, not a silent fallback
+    NativeCompiler missing("lsjit test's cache");
+    missing.setCompiler("lsjit-no-such-compiler");
+    bool threw = false;
+    try {
+        missing.attach(native);
+    } catch (Exceptions::JitError&) {
+        threw = true;
+    }
+    CHECK(threw);
+    return test_result();
+}
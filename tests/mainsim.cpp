@@ -0,0 +1,107 @@
+// clock sources and the scheduler: edge times from period, phase and duty
+// cycle, and idle time skipped instead of stepped through
+#include <memory>
+
+#include "main_init.hpp"
+#include "numberconfigentries.hpp"
+#include "clockgate.hpp"
+#include "mainsim.hpp"
+#include "watchpoints.hpp"
+
+#include "check.hpp"
+
+using namespace LogicSim;
+
+static void configure(ClockGate& c, unsigned long long period, unsigned long long phase, long double duty) {
+    c.config_table.insert(ConfigKeys::Period, std::unique_ptr<ConfigEntry>(new ULongLongConfigEntry(period)));
+    c.config_table.insert(ConfigKeys::Phase, std::unique_ptr<ConfigEntry>(new ULongLongConfigEntry(phase)));
+    c.config_table.insert(ConfigKeys::DutyCycle, std::unique_ptr<ConfigEntry>(new FloatConfigEntry(duty)));
+}
+// edges in (0, t] of a clock with phase 0 that starts low
+static unsigned long long edgesUpTo(SimTime t, SimTime period, SimTime high) {
+    return (t < high ? 0 : (t - high) / period + 1) + t / period;
+}
+static void onEdge(void* count, Wire*, unsigned long long) {
+    (*(int*)count)++;
+}
+static SimTime seen_at;
+static void record(void* sim) {
+    seen_at = ((MainSim*)sim)->getTime();
+}
+
+int main() {
+    // period 8, phase 3, high for 2 ticks
+    MainSim sim;
+    ClockGate c;
+    configure(c, 8, 3, 0.25L);
+    sim.addClock(&c);
+    CHECK(!c.levelAt(0));
+    CHECK(c.levelAt(3));
+    CHECK(c.levelAt(4));
+    CHECK(!c.levelAt(5));
+    CHECK(!c.levelAt(10));
+    CHECK(c.levelAt(11));
+    CHECK_EQ(c.nextEdge(0), 3);
+    CHECK_EQ(c.nextEdge(3), 5);
+    CHECK_EQ(c.nextEdge(5), 11);
+
+    // the clock drives its wire at the scheduled edges
+    Wire w;
+    connect(c.getPin(0), &w);
+    int rises = 0;
+    watch_edge(&w, true, 0, onEdge, &rises);
+    sim.schedule(6, record, &sim);
+    CHECK(sim.runUntil(40));
+    CHECK_EQ(rises, 5);
+    CHECK_EQ(seen_at, 6);
+    CHECK_EQ(sim.getTime(), 40);
+    CHECK_EQ(sim.nextEventTime(), 43);
+
+    // a slow clock next to a fast one costs its own edges, not the ticks
+    // between them; alone, a billion ticks is a few ten thousand steps
+    MainSim warp;
+    ClockGate slow, fast;
+    configure(slow, 30000, 0, 0.5L);
+    configure(fast, 2, 0, 0.5L);
+    warp.addClock(&slow);
+    warp.addClock(&fast);
+    warp.runUntil(100000);
+    CHECK_EQ(warp.getProcessed(), edgesUpTo(100000, 30000, 15000) + edgesUpTo(100000, 2, 1));
+    MainSim idle;
+    ClockGate rtc;
+    configure(rtc, 30000, 0, 0.5L);
+    idle.addClock(&rtc);
+    idle.runUntil(1000000000ULL);
+    CHECK_EQ(idle.getProcessed(), edgesUpTo(1000000000ULL, 30000, 15000));
+    CHECK_EQ(idle.getTime(), 1000000000ULL);
+
+    // always low or always high has no edges
+    MainSim flat;
+    ClockGate off, on;
+    configure(off, 10, 0, 0.0L);
+    configure(on, 10, 0, 1.0L);
+    flat.addClock(&off);
+    flat.addClock(&on);
+    CHECK(!off.getLevel());
+    CHECK(on.getLevel());
+    CHECK_EQ(flat.nextEventTime(), NEVER);
+
+    // bad settings are rejected when the clock is added
+    ClockGate bare, over;
+    configure(over, 10, 0, 1.5L);
+    bool threw = false;
+    try {
+        sim.addClock(&bare);
+    } catch (LogicSimException&) {
+        threw = true;
+    }
+    CHECK(threw);
+    threw = false;
+    try {
+        sim.addClock(&over);
+    } catch (LogicSimException&) {
+        threw = true;
+    }
+    CHECK(threw);
+    return test_result();
+}
@@ -0,0 +1,103 @@
+// memories: use before init(), oversized configs, mapped images and
+// copy-on-write forks
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+#include "main_init.hpp"
+#include "numberconfigentries.hpp"
+#include "stringconfigentry.hpp"
+#include "mainsim.hpp"
+#include "memorygates.hpp"
+
+#include "check.hpp"
+
+using namespace LogicSim;
+
+static void configure(DigitalLogic::MemoryGate& g, unsigned short bits, unsigned long long size) {
+    g.config_table.insert(ConfigKeys::Bits, std::unique_ptr<ConfigEntry>(new UShortConfigEntry(bits)));
+    g.config_table.insert(ConfigKeys::Size, std::unique_ptr<ConfigEntry>(new ULongLongConfigEntry(size)));
+}
+template <typename F>
+static bool throws(F f) {
+    try {
+        f();
+    } catch (LogicSimException&) {
+        return true;
+    }
+    return false;
+}
+
+int main() {
+    MainSim sim;
+
+    // no memory before init(), and a size whose byte count overflows
+    DigitalLogic::RAMGate early;
+    CHECK(throws([&] { early.peek(0); }));
+    CHECK(throws([&] { early.poke(0, 1); }));
+    DigitalLogic::RAMGate huge;
+    configure(huge, 64, 1ULL << 62);
+    CHECK(throws([&] { sim.addGate(&huge); }));
+    PagedMemory edge(16);
+    edge.writeWord(~0ULL - 1, 8, ~0ULL);
+    CHECK_EQ(edge.readWord(~0ULL - 1, 8), 0);
+    CHECK_EQ(edge.residentPages(), 0);
+
+    // a two-page image; 3-byte words put word 1365 across the page boundary
+    const char* path = "memorygates_image.bin";
+    std::vector<unsigned char> bytes(2 * MemoryPage::size + 100);
+    for (size_t i = 0; i < bytes.size(); i++) bytes[i] = (unsigned char)(i * 7 + 3);
+    FILE* f = std::fopen(path, "wb");
+    CHECK(f != nullptr);
+    std::fwrite(bytes.data(), 1, bytes.size(), f);
+    std::fclose(f);
+    auto image = std::make_shared<MemoryImage>(path);
+    CHECK_EQ(image->size(), bytes.size());
+    CHECK(std::equal(bytes.begin(), bytes.end(), image->bytes()));
+    CHECK(throws([] { MemoryImage missing("memorygates_missing.bin"); }));
+
+    DigitalLogic::ROMGate rom;
+    configure(rom, 24, bytes.size() / 3);
+    rom.config_table.insert(ConfigKeys::Image, std::unique_ptr<ConfigEntry>(new StringConfigEntry(path)));
+    sim.addGate(&rom);
+    auto word = [&](size_t w) {
+        return bytes[3 * w] | (unsigned long long)bytes[3 * w + 1] << 8 | (unsigned long long)bytes[3 * w + 2] << 16;
+    };
+    CHECK_EQ(rom.peek(0), word(0));
+    CHECK_EQ(rom.peek(1365), word(1365));
+    CHECK_EQ(rom.peek(bytes.size() / 3 - 1), word(bytes.size() / 3 - 1));
+    CHECK_EQ(rom.peek(bytes.size()), 0);
+    // reading never copies image pages
+    CHECK_EQ(rom.getMemory()->residentPages(), 0);
+
+    // a fork shares pages until one side writes them
+    auto base = std::make_shared<PagedMemory>(bytes.size(), image);
+    base->writeByte(10, 0xAA);
+    auto child = base->fork();
+    CHECK_EQ(child->readByte(10), 0xAA);
+    child->writeByte(10, 0x55);
+    child->writeByte(MemoryPage::size + 1, 0x66);
+    CHECK_EQ(base->readByte(10), 0xAA);
+    CHECK_EQ(base->readByte(MemoryPage::size + 1), bytes[MemoryPage::size + 1]);
+    CHECK_EQ(child->readByte(10), 0x55);
+    CHECK_EQ(child->readByte(11), bytes[11]);
+    CHECK_EQ(base->residentPages(), 1);
+    CHECK_EQ(child->residentPages(), 2);
+    base->writeByte(12, 0x77);
+    CHECK_EQ(child->readByte(12), bytes[12]);
+
+    // gates sharing memory fork it
+    DigitalLogic::RAMGate ram, copy;
+    configure(ram, 16, 1024);
+    sim.addGate(&ram);
+    ram.poke(3, 0x1234);
+    copy.shareMemory(ram);
+    configure(copy, 16, 1024);
+    sim.addGate(&copy);
+    CHECK_EQ(copy.peek(3), 0x1234);
+    copy.poke(3, 0xBEEF);
+    CHECK_EQ(ram.peek(3), 0x1234);
+    CHECK_EQ(copy.peek(3), 0xBEEF);
+    std::remove(path);
+    return test_result();
+}
@@ -0,0 +1,81 @@
+// incremental netlist edits: listener notifications, pin cleanup and the
+// values a removed or rewired driver leaves behind
+#include <algorithm>
+#include <vector>
+
+#include "main_init.hpp"
+#include "digitallogicgates.hpp"
+#include "netlist.hpp"
+
+#include "check.hpp"
+
+using namespace LogicSim;
+
+class Driver final : public BasicGate {
+protected:
+    virtual void update() override {};
+public:
+    Driver() : BasicGate(0, 1) {};
+    virtual const char* getObjectType() override {
+        return "Driver";
+    }
+    void drive(WireStateValue v) {
+        write_pin(0, v);
+    }
+};
+
+static std::vector<unsigned int> last;
+static void onChange(void*, const std::vector<unsigned int>& affected) {
+    last = affected;
+}
+
+int main() {
+    // a -> n1 -> b -> n2 -> c; later `loop` ANDs c with e and drives a,
+    // closing a cycle through n1 and n2
+    Wire a, b, c, d, e;
+    Driver src;
+    DigitalLogic::NotGate n1, n2;
+    DigitalLogic::AndGate loop;
+    connect(src.getPin(0), &a);
+    connect(n1.getPin(0), &a);
+    connect(n1.getPin(1), &b);
+    connect(n2.getPin(0), &b);
+    connect(n2.getPin(1), &c);
+    Netlist net({&n1, &n2});
+    net.onChange(onChange, nullptr);
+    src.drive(WireStateValue(true));
+    CHECK_EQ(b.getState(0).b, false);
+    CHECK_EQ(c.getState(0).b, true);
+
+    // the removed gate's value leaves c, which then has no driver
+    net.removeGate(&n2);
+    CHECK(!n2.getPin(0)->hasWire());
+    CHECK(!n2.getPin(1)->hasWire());
+    CHECK_EQ(b.getPins().size(), 1);
+    CHECK_EQ(c.getPins().size(), 0);
+    CHECK(c.getState(0).type == WireStateValueType::NONE);
+    CHECK_EQ(b.getState(0).b, false);
+    net.addGate(&n2);
+    CHECK_EQ(net.getGates()[net.gateIndex(&n2)].inputs[0], NO_INDEX);
+
+    // a feedback loop forces a full levelize; every gate must be reported
+    net.connectPin(n2.getPin(0), &b);
+    net.connectPin(n2.getPin(1), &c);
+    CHECK_EQ(c.getState(0).b, true);
+    // loop overrides src on a
+    WireStateValue weak(true);
+    weak.resistance = 1000;
+    src.drive(weak);
+    connect(loop.getPin(0), &c);
+    connect(loop.getPin(1), &e);
+    connect(loop.getPin(2), &a);
+    net.addGate(&loop);
+    CHECK(!net.getCyclic().empty());
+    // moving n2's output takes its value from c over to d
+    net.connectPin(n2.getPin(1), &d);
+    std::sort(last.begin(), last.end());
+    CHECK_EQ(last.size(), 3);
+    CHECK(c.getState(0).type == WireStateValueType::NONE);
+    CHECK(d.getState(0).type != WireStateValueType::NONE);
+    return test_result();
+}
@@ -0,0 +1,106 @@
+// min-cut partitioning: cliques joined by single edges are split along
+// those edges, and a shard plan cuts a long chain once
+#include <memory>
+#include <tuple>
+#include <vector>
+
+#include "main_init.hpp"
+#include "digitallogicgates.hpp"
+#include "netlist.hpp"
+#include "partition.hpp"
+
+#include "check.hpp"
+
+using namespace LogicSim;
+
+// `cliques` complete graphs of `size` vertices, clique i joined to clique
+// i + 1 (and the last to the first when ring) by one edge
+static PartitionGraph cliqueChain(unsigned int cliques, unsigned int size, bool ring) {
+    unsigned int n = cliques * size;
+    std::vector<std::vector<unsigned int>> adj(n);
+    auto link = [&](unsigned int u, unsigned int v) {
+        adj[u].push_back(v);
+        adj[v].push_back(u);
+    };
+    for (unsigned int c = 0; c < cliques; c++) {
+        for (unsigned int i = 0; i < size; i++) {
+            for (unsigned int j = i + 1; j < size; j++) link(c * size + i, c * size + j);
+        }
+        if (c + 1 < cliques || (ring && cliques > 2)) link(c * size + size - 1, ((c + 1) % cliques) * size);
+    }
+    PartitionGraph g;
+    g.xadj.push_back(0);
+    for (auto& a : adj) {
+        for (auto v : a) {
+            g.adjncy.push_back(v);
+            g.adjwgt.push_back(1);
+        }
+        g.xadj.push_back((unsigned int)g.adjncy.size());
+        g.vwgt.push_back(1);
+    }
+    return g;
+}
+static unsigned int cutOf(const PartitionGraph& g, const std::vector<unsigned int>& part) {
+    unsigned int c = 0;
+    for (unsigned int u = 0; u < g.size(); u++) {
+        for (unsigned int e = g.xadj[u]; e < g.xadj[u + 1]; e++) {
+            if (part[u] != part[g.adjncy[e]]) c += g.adjwgt[e];
+        }
+    }
+    return c / 2;
+}
+// every clique whole in one part, and no two cliques sharing a part
+static bool cliquesWhole(const std::vector<unsigned int>& part, unsigned int cliques, unsigned int size) {
+    std::vector<bool> used(cliques, false);
+    for (unsigned int c = 0; c < cliques; c++) {
+        unsigned int p = part[c * size];
+        if (p >= cliques || used[p]) return false;
+        used[p] = true;
+        for (unsigned int i = 1; i < size; i++) {
+            if (part[c * size + i] != p) return false;
+        }
+    }
+    return true;
+}
+
+int main() {
+    GraphPartitioner partitioner;
+    PartitionGraph two = cliqueChain(2, 8, false);
+    auto part = partitioner.partition(two, 2);
+    CHECK_EQ(cutOf(two, part), 1);
+    CHECK(cliquesWhole(part, 2, 8));
+
+    // four cliques in a ring cost four edges; big enough to be coarsened
+    PartitionGraph four = cliqueChain(4, 40, true);
+    part = partitioner.partition(four, 4);
+    CHECK_EQ(cutOf(four, part), 4);
+    CHECK(cliquesWhole(part, 4, 40));
+
+    // a chain of 64 inverters splits into two halves with one cut wire
+    const int n = 64;
+    std::vector<std::unique_ptr<Wire>> wires;
+    std::vector<std::unique_ptr<DigitalLogic::NotGate>> gates;
+    std::vector<BasicGate*> list;
+    wires.emplace_back(new Wire());
+    for (int i = 0; i < n; i++) {
+        gates.emplace_back(new DigitalLogic::NotGate());
+        wires.emplace_back(new Wire());
+        connect(gates.back()->getPin(0), wires[i].get());
+        connect(gates.back()->getPin(1), wires[i + 1].get());
+        list.push_back(gates.back().get());
+    }
+    Netlist net(list);
+    ShardPlan plan(net, 2);
+    CHECK_EQ(plan.getShardCount(), 2);
+    CHECK_EQ(plan.getCutWires().size(), 1);
+    CHECK_EQ(plan.getGates(0).size() + plan.getGates(1).size(), (size_t)n);
+    CHECK(plan.getGates(0).size() >= n / 2 - 2 && plan.getGates(0).size() <= n / 2 + 2);
+    // the cut wire lives with its driver and is read in the other shard
+    unsigned int cut = plan.getCutWires()[0];
+    unsigned int reader = net.getFanout(cut)[0];
+    CHECK(plan.shardOfWire(cut) != plan.shardOfGate(reader));
+    CHECK_EQ(plan.shardOfWire(cut), plan.shardOfGate(net.getDrivers(cut)[0]));
+    size_t owned = plan.getWires(0).size() + plan.getWires(1).size();
+    CHECK_EQ(owned, net.getWires().size());
+    return test_result();
+}
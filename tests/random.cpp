@@ -0,0 +1,103 @@
+// random streams: fixed sequences per seed and stream, on any thread
+#include <thread>
+#include <vector>
+
+#include "main_init.hpp"
+#include "random.hpp"
+
+#include "check.hpp"
+
+using namespace LogicSim;
+
+static void draw(unsigned int index, unsigned long long* out) {
+    RandomStream& r = Random::local(index);
+    for (int i = 0; i < 4; i++) out[i] = Random::local(index).next();
+    CHECK(&r == &Random::local(index));
+}
+
+int main() {
+    // the sequence for a seed and stream number is part of the interface
+    RandomStream r(42, 3);
+    CHECK_EQ(r.next(), 0x612c2b2df2b93b3cULL);
+    CHECK_EQ(r.next(), 0x543b64c0ca8cdc86ULL);
+    CHECK_EQ(r.next(), 0x91686df1e22bcdb2ULL);
+    CHECK_EQ(r.below(1000003), 659189ULL);
+
+    // bulk output continues the same sequence as next()
+    RandomStream a(7, 1), b(7, 1), c(7, 2);
+    std::vector<unsigned long long> bulk(3 + 2 * RandomStream::LANES);
+    a.next();
+    a.fill(bulk.data(), bulk.size());
+    b.next();
+    bool same = true, other = true;
+    for (auto v : bulk) {
+        same = same && v == b.next();
+        other = other && v == c.next();
+    }
+    CHECK(same);
+    CHECK(!other);
+
+    // the 128-bit product without __int128
+    unsigned long long lo, plo;
+    const unsigned long long xs[] = {0, 1, 0xFFFFFFFFULL, 0x100000000ULL, ~0ULL, 0x9E3779B97F4A7C15ULL};
+    for (auto x : xs) {
+        for (auto y : xs) {
+            CHECK_EQ(mulhi64(x, y, lo), mulhi64_portable(x, y, plo));
+            CHECK_EQ(lo, plo);
+        }
+    }
+    for (int i = 0; i < 1000; i++) {
+        unsigned long long x = r.next(), y = r.next();
+        CHECK_EQ(mulhi64(x, y, lo), mulhi64_portable(x, y, plo));
+        CHECK_EQ(lo, plo);
+    }
+
+    // one-hot values stay one bit of the word at any width
+    for (unsigned short w : {1, 63, 64, 65, 200}) {
+        for (int i = 0; i < 64; i++) {
+            unsigned long long v = r.onehot(w);
+            CHECK(v != 0 && (v & (v - 1)) == 0);
+            if (w < 64) CHECK(v < (1ULL << w));
+        }
+    }
+
+    // a thread's stream depends on its index and the seed only, and repeated
+    // local(index) calls continue it instead of restarting it
+    Random::setSeed(1234);
+    unsigned long long t0[4], t1[4], again[4];
+    std::thread w0(draw, 0u, t0), w1(draw, 1u, t1);
+    w0.join();
+    w1.join();
+    std::thread w2(draw, 1u, again);
+    w2.join();
+    RandomStream ref(1234, 1);
+    for (int i = 0; i < 4; i++) {
+        CHECK_EQ(t1[i], again[i]);
+        CHECK_EQ(t1[i], ref.next());
+    }
+    CHECK(t0[0] != t1[0]);
+
+    // setSeed restarts the stream on its next use
+    unsigned long long first = Random::local(5).next();
+    CHECK(Random::local(5).next() != first);
+    Random::setSeed(1234);
+    CHECK_EQ(Random::local(5).next(), first);
+
+    // setSeed racing with restarts: every restart takes one of the seeds,
+    // and after the writer stops the stream follows the last one
+    std::thread writer([] {
+        for (int i = 0; i < 2000; i++) Random::setSeed(i & 1 ? 99 : 1234);
+    });
+    bool seeded = true;
+    for (int i = 0; i < 2000; i++) {
+        unsigned long long s = Random::local(5).getSeed();
+        seeded = seeded && (s == 99 || s == 1234);
+        std::this_thread::yield();
+    }
+    writer.join();
+    CHECK(seeded);
+    CHECK_EQ(Random::local(5).getSeed(), Random::getSeed());
+    Random::setSeed(1234);
+    CHECK_EQ(Random::local(5).next(), first);
+    return test_result();
+}
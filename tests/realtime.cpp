@@ -0,0 +1,96 @@
+// realtime runner: ring wrap-around and ordering across threads, histogram
+// buckets and percentiles, and a stimulus/response round trip
+#include <thread>
+
+#include "main_init.hpp"
+#include "digitallogicgates.hpp"
+#include "realtime.hpp"
+
+#include "check.hpp"
+
+using namespace LogicSim;
+
+int main() {
+    // capacity rounds up to a power of two
+    SpscRing<unsigned int> ring(5);
+    for (unsigned int i = 0; i < 8; i++) CHECK(ring.push(i));
+    CHECK(!ring.push(8));
+    unsigned int v = 0;
+    for (unsigned int i = 0; i < 8; i++) {
+        CHECK(ring.pop(v));
+        CHECK_EQ(v, i);
+    }
+    CHECK(!ring.pop(v));
+    CHECK(ring.empty());
+
+    const unsigned int n = 20000;
+    SpscRing<unsigned int> shared(64);
+    std::thread producer([&shared]() {
+        for (unsigned int i = 0; i < n; i++) {
+            while (!shared.push(i)) std::this_thread::yield();
+        }
+    });
+    unsigned int expect = 0;
+    bool ordered = true;
+    while (expect < n) {
+        if (!shared.pop(v)) {
+            std::this_thread::yield();
+            continue;
+        }
+        if (v != expect) ordered = false;
+        expect++;
+    }
+    producer.join();
+    CHECK(ordered);
+
+    // exact below 16, then within one sub-bucket (1/16) above
+    LatencyHistogram h;
+    CHECK_EQ(h.percentile(50), 0);
+    for (unsigned long long i = 1; i <= 10; i++) h.record(i);
+    CHECK_EQ(h.count(), 10);
+    CHECK_EQ(h.min(), 1);
+    CHECK_EQ(h.max(), 10);
+    CHECK_EQ(h.percentile(50), 5);
+    CHECK_EQ(h.percentile(100), 10);
+    h.reset();
+    for (int i = 0; i < 99; i++) h.record(1000);
+    h.record(1000000);
+    unsigned long long p50 = h.percentile(50), p99 = h.percentile(99);
+    CHECK(p50 >= 1000 && p50 < 1000 + 1000 / 16);
+    CHECK_EQ(p99, p50);
+    CHECK_EQ(h.percentile(100), 1000000);
+
+    CHECK(!Thread::pinSelf(-1));
+    CHECK(!Thread::pinSelf(1 << 20));
+
+    // in -> not -> out; every posted level comes back inverted
+    Wire in, out;
+    DigitalLogic::NotGate inv;
+    connect(inv.getPin(0), &in);
+    connect(inv.getPin(1), &out);
+    MainSim sim;
+    RealtimeRunner runner(sim);
+    unsigned int ip = runner.bindInput(&in);
+    unsigned int op = runner.bindOutput(&out);
+    bool thrown = false;
+    try {
+        runner.post(ip + 1, 1);
+    } catch (LogicSimException&) {
+        thrown = true;
+    }
+    CHECK(thrown);
+    runner.start();
+    RealtimeMessage m;
+    for (unsigned long long level : {0ULL, 1ULL, 0ULL}) {
+        CHECK(runner.post(ip, level));
+        CHECK(runner.pollWait(m, 5000000000ULL));
+        CHECK_EQ(m.port, op);
+        CHECK_EQ(m.value, level ^ 1);
+    }
+    runner.stop();
+    CHECK(!runner.isRunning());
+    CHECK_EQ(runner.getApplied(), 3);
+    CHECK_EQ(runner.getLatency().count(), 3);
+    CHECK_EQ(runner.getDropped(), 0);
+    return test_result();
+}
@@ -0,0 +1,140 @@
+// resistive networks: coupled nets report their changes, wires, switches
+// and the network may be destroyed in any order
+#include "main_init.hpp"
+#include "watchpoints.hpp"
+#include "resistive.hpp"
+
+#include "check.hpp"
+
+using namespace LogicSim;
+
+class Driver final : public BasicGate {
+protected:
+    virtual void update() override {};
+public:
+    Driver() : BasicGate(0, 1) {};
+    virtual const char* getObjectType() override {
+        return "Driver";
+    }
+    void drive(WireStateValue v) {
+        write_pin(0, v);
+    }
+};
+
+static unsigned int hooked_b = 0;
+static Wire* wire_b = nullptr;
+static void onHook(Wire* w, unsigned short, unsigned long long, unsigned long long) {
+    if (w == wire_b) hooked_b++;
+}
+static void onWatch(void* instance, Wire*, unsigned long long) {
+    (*(unsigned int*)instance)++;
+}
+
+static WireStateValue level(bool v, unsigned short resistance) {
+    WireStateValue r(v);
+    r.resistance = resistance;
+    return r;
+}
+
+int main() {
+    Wire a, b, ctl;
+    wire_b = &b;
+    Driver da, db, dctl;
+    ResistiveSwitch sw(10);
+    connect(da.getPin(0), &a);
+    connect(db.getPin(0), &b);
+    connect(dctl.getPin(0), &ctl);
+    connect(sw.getPin(0), &ctl);
+    connect(sw.getPin(1), &a);
+    connect(sw.getPin(2), &b);
+    da.drive(level(true, 0));
+    db.drive(level(false, 1000));
+    dctl.drive(WireStateValue(false));
+
+    unsigned int watched_b = 0;
+    watch_change(&b, onWatch, &watched_b);
+    wire_change_hook = onHook;
+    {
+        ResistiveNetwork net;
+        net.addSwitch(&sw);
+        CHECK_EQ(b.getState(0).b, false);
+
+        // closing the switch rewrites b without any pin on b driving it
+        dctl.drive(WireStateValue(true));
+        CHECK(sw.isConducting());
+        CHECK_EQ(b.getState(0).b, true);
+        CHECK_EQ(hooked_b, 1u);
+        CHECK_EQ(watched_b, 1u);
+
+        // a driven change on a reaches b through the coupled solve
+        da.drive(level(false, 0));
+        CHECK_EQ(b.getState(0).b, false);
+        CHECK_EQ(hooked_b, 2u);
+        CHECK_EQ(watched_b, 2u);
+        da.drive(level(true, 0));
+        CHECK_EQ(b.getState(0).b, true);
+        CHECK_EQ(b.getState(0).resistance, 0);
+        CHECK_EQ(hooked_b, 3u);
+
+        // removing b hands it back to plain resolution and reports it
+        net.removeNet(&b);
+        CHECK_EQ(b.getState(0).b, false);
+        CHECK_EQ(b.getState(0).resistance, 1000);
+        CHECK_EQ(hooked_b, 4u);
+        CHECK_EQ(watched_b, 4u);
+        CHECK(b.getResolver() == nullptr);
+        CHECK(a.getResolver() == &net);
+
+        net.addSwitch(&sw);
+        CHECK_EQ(b.getState(0).b, true);
+        CHECK_EQ(hooked_b, 5u);
+        net.removeSwitch(&sw);
+        CHECK_EQ(b.getState(0).b, false);
+        CHECK_EQ(hooked_b, 6u);
+        net.addSwitch(&sw);
+        CHECK_EQ(b.getState(0).b, true);
+    }
+    // the network's destructor re-resolves quietly: b keeps its weak driver
+    CHECK_EQ(b.getState(0).b, false);
+    CHECK_EQ(b.getState(0).resistance, 1000);
+    CHECK_EQ(hooked_b, 7u);
+    CHECK_EQ(a.getState(0).b, true);
+    CHECK(b.getResolver() == nullptr);
+    wire_change_hook = nullptr;
+
+    // network declared first, so its wires and switches die before it
+    {
+        ResistiveNetwork net;
+        Wire x, y, z, on;
+        Driver dx, dy, don;
+        connect(dx.getPin(0), &x);
+        connect(dy.getPin(0), &y);
+        connect(don.getPin(0), &on);
+        dx.drive(level(true, 0));
+        dy.drive(level(false, 1000));
+        don.drive(WireStateValue(true));
+        ResistiveSwitch* xy = new ResistiveSwitch(10);
+        ResistiveSwitch yz(10);
+        connect(xy->getPin(0), &on);
+        connect(xy->getPin(1), &x);
+        connect(xy->getPin(2), &y);
+        connect(yz.getPin(0), &on);
+        connect(yz.getPin(1), &y);
+        connect(yz.getPin(2), &z);
+        net.addSwitch(xy);
+        net.addSwitch(&yz);
+        CHECK_EQ(y.getState(0).b, true);
+        CHECK_EQ(z.getState(0).b, true);
+
+        // a switch destroyed while attached splits its component
+        delete xy;
+        CHECK_EQ(y.getState(0).b, false);
+        CHECK_EQ(z.getState(0).b, false);
+        CHECK(x.getResolver() == &net);
+        dy.drive(level(true, 1000));
+        CHECK_EQ(z.getState(0).b, true);
+        dy.drive(level(false, 1000));
+        CHECK_EQ(z.getState(0).b, false);
+    }
+    return test_result();
+}
@@ -0,0 +1,70 @@
+// state dumps: values are read in place, floats stay valid JSON and keep
+// their full precision in binary dumps
+#include <cmath>
+#include <cstring>
+#include <string>
+
+#include "main_init.hpp"
+#include "serializer.hpp"
+
+#include "check.hpp"
+
+using namespace LogicSim;
+
+class Driver final : public BasicGate {
+protected:
+    virtual void update() override {};
+public:
+    Driver() : BasicGate(0, 1) {};
+    virtual const char* getObjectType() override {
+        return "Driver";
+    }
+    void drive(WireStateValue v) {
+        write_pin(0, v);
+    }
+};
+
+static std::string dump(Wire& w) {
+    StateWriter out;
+    StateSerializer s(out, SerializerFormat::JSON);
+    s.writeWire(&w);
+    return std::string(out.data(), out.size());
+}
+
+int main() {
+    Wire w;
+    Driver d;
+    connect(d.getPin(0), &w);
+
+    d.drive(WireStateValue((long double)INFINITY));
+    CHECK(dump(w).find("\"v\":\"inf\"") != std::string::npos);
+    d.drive(WireStateValue(-(long double)INFINITY));
+    CHECK(dump(w).find("\"v\":\"-inf\"") != std::string::npos);
+    d.drive(WireStateValue((long double)NAN));
+    CHECK(dump(w).find("\"v\":\"nan\"") != std::string::npos);
+    d.drive(WireStateValue((long double)1.5));
+    CHECK(dump(w).find("\"type\":\"FLOAT\",\"r\":0,\"v\":1.5") != std::string::npos);
+
+    // a value between two doubles survives a binary dump: type, resistance,
+    // then the long double's bytes
+    long double fine = 1.0L + std::ldexp(1.0L, -60);
+    d.drive(WireStateValue(fine));
+    StateWriter bin;
+    StateSerializer bs(bin, SerializerFormat::BINARY);
+    bs.writeValue(w.getState(0));
+    CHECK_EQ(bin.size(), 3 + StateWriter::LONG_DOUBLE_BYTES);
+    CHECK_EQ((unsigned char)bin.data()[0], (unsigned char)WireStateValueType::FLOAT);
+    long double back = 0;
+    std::memcpy(&back, bin.data() + 3, StateWriter::LONG_DOUBLE_BYTES);
+    CHECK(back == fine);
+
+    // the dump itself must not add or remove registered objects
+    size_t before = objects.size();
+    StateWriter out;
+    StateSerializer s(out, SerializerFormat::JSON);
+    s.writeCircuit();
+    CHECK_EQ(objects.size(), before);
+    std::string json(out.data(), out.size());
+    CHECK(json.rfind("{\"wires\":[{\"wire\":", 0) == 0);
+    return test_result();
+}
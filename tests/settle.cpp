@@ -0,0 +1,107 @@
+// event settling: deep acyclic logic is not an oscillation, a real loop is
+// broken, its nets fall back to their other drivers, and an input change
+// re-enables the gates that were forced to X
+#include <memory>
+#include <vector>
+
+#include "main_init.hpp"
+#include "digitallogicgates.hpp"
+
+#include "check.hpp"
+
+using namespace LogicSim;
+
+class Driver final : public BasicGate {
+protected:
+    virtual void update() override {};
+public:
+    Driver() : BasicGate(0, 1) {};
+    virtual const char* getObjectType() override {
+        return "Driver";
+    }
+    void drive(WireStateValue v) {
+        write_pin(0, v);
+    }
+};
+
+int main() {
+    settle_limit = 8;
+
+    // 40 inverters in a row settle in 40 deltas, each gate evaluated once
+    {
+        std::vector<std::unique_ptr<Wire>> wires;
+        std::vector<std::unique_ptr<DigitalLogic::NotGate>> gates;
+        Driver in;
+        wires.emplace_back(new Wire());
+        connect(in.getPin(0), wires.back().get());
+        for (int i = 0; i < 40; i++) {
+            Wire* prev = wires.back().get();
+            wires.emplace_back(new Wire());
+            gates.emplace_back(new DigitalLogic::NotGate());
+            connect(gates.back()->getPin(0), prev);
+            connect(gates.back()->getPin(1), wires.back().get());
+        }
+        in.drive(WireStateValue(true));
+        CHECK_EQ(wires.back()->getState(0).b, true);
+        in.drive(WireStateValue(false));
+        CHECK_EQ(wires.back()->getState(0).b, false);
+        CHECK_EQ(diagnostics.count(DiagnosticCode::OSCILLATION), 0);
+        while (!gates.empty()) gates.pop_back();
+    }
+
+    // x = NAND(en, z), y = NOT x, z = NOT y: three inversions ring while en is
+    // high; x also has a weak pull-down
+    Wire en, x, y, z;
+    Driver den, pull;
+    DigitalLogic::NandGate nand;
+    DigitalLogic::NotGate n1, n2;
+    connect(den.getPin(0), &en);
+    connect(pull.getPin(0), &x);
+    connect(nand.getPin(0), &en);
+    connect(nand.getPin(1), &z);
+    connect(nand.getPin(2), &x);
+    connect(n1.getPin(0), &x);
+    connect(n1.getPin(1), &y);
+    connect(n2.getPin(0), &y);
+    connect(n2.getPin(1), &z);
+    WireStateValue weak(false);
+    weak.resistance = 1000;
+    pull.drive(weak);
+    den.drive(WireStateValue(false));
+    CHECK_EQ(x.getState(0).b, true);
+    CHECK_EQ(z.getState(0).b, true);
+
+    bool thrown = false;
+    try {
+        den.drive(WireStateValue(true));
+    } catch (Exceptions::OscillationError&) {
+        thrown = true;
+    }
+    CHECK(thrown);
+    CHECK_EQ(diagnostics.count(DiagnosticCode::OSCILLATION), 1);
+
+    den.drive(WireStateValue(false));
+    CHECK_EQ(x.getState(0).b, true);
+    CHECK_EQ(z.getState(0).b, true);
+
+    diagnostics.setPolicy(DiagnosticCode::OSCILLATION, DiagnosticPolicy::COUNT);
+    den.drive(WireStateValue(true));
+    CHECK(diagnostics.count(DiagnosticCode::OSCILLATION) > 1);
+    CHECK(nand.isForcedX());
+    // the forced gate's value is gone, so the pull-down decides x
+    CHECK(!x.getState(0).is(WireStateValue()));
+    CHECK_EQ(x.getState(0).b, false);
+    CHECK_EQ(x.getState(0).resistance, 1000);
+
+    // the change on en re-enables the forced gates; with en low the ring holds
+    den.drive(WireStateValue(false));
+    CHECK(!nand.isForcedX());
+    CHECK(!n1.isForcedX());
+    CHECK(!n2.isForcedX());
+    CHECK_EQ(x.getState(0).b, true);
+    CHECK_EQ(x.getState(0).resistance, 0);
+    CHECK_EQ(y.getState(0).b, false);
+    CHECK_EQ(z.getState(0).b, true);
+    diagnostics.setPolicy(DiagnosticCode::OSCILLATION, DiagnosticPolicy::THROW);
+    return test_result();
+}
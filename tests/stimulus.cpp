@@ -0,0 +1,90 @@
+// record/replay round trip across differently built circuits
+#include <cstring>
+#include <memory>
+
+#include "main_init.hpp"
+#include "stimulus.hpp"
+
+#include "check.hpp"
+
+using namespace LogicSim;
+
+class Driver final : public BasicGate {
+protected:
+    virtual void update() override {};
+public:
+    Driver() : BasicGate(0, 1) {};
+    virtual const char* getObjectType() override {
+        return "Driver";
+    }
+};
+
+static int replayed_event = 0;
+static void onReplayedEvent(void*, const unsigned char* data, size_t n) {
+    if (n == sizeof(int)) std::memcpy(&replayed_event, data, sizeof(int));
+}
+
+int main() {
+    StateWriter out;
+    {
+        Wire a, b;
+        Driver da, db;
+        connect(da.getPin(0), &a);
+        connect(db.getPin(0), &b);
+        Event<int> irq;
+
+        StimulusRecorder rec(out);
+        rec.add(&da, "a");
+        rec.add(db.getPin(0), "b");
+        rec.watch(irq, "irq");
+        rec.start();
+        // external writes are stimulus; a gate's own output writes are not
+        da.getPin(0)->write(0, WireStateValue(true));
+        db.getPin(0)->write(0, WireStateValue((unsigned long long)0x1234));
+        da.getPin(0)->write(0, WireStateValue(false));
+        // event handlers run on the firing thread
+        irq.createCaller()(42);
+        CHECK_EQ(rec.count(), 4);
+        rec.stop();
+        CHECK(!a.getState(0).b);
+        CHECK_EQ(b.getState(0).ll, 0x1234);
+    }
+
+    // built in another order, with unrelated objects in between
+    std::unique_ptr<Wire> filler(new Wire());
+    Driver db;
+    Wire b;
+    Driver unrecorded;
+    Driver da;
+    Wire a;
+    connect(db.getPin(0), &b);
+    connect(da.getPin(0), &a);
+
+    {
+        StimulusReplayer unbound(out.data(), out.size());
+        unbound.bind("a", &da);
+        bool thrown = false;
+        try {
+            unbound.resolve();
+        } catch (LogicSimException&) {
+            thrown = true;
+        }
+        CHECK(thrown);
+    }
+
+    StimulusReplayer rep(out.data(), out.size());
+    rep.bind("a", &da);
+    rep.bind("b", db.getPin(0));
+    rep.onEvent("irq", onReplayedEvent, nullptr);
+    StimulusRecord r;
+    CHECK(rep.next(r));
+    CHECK(r.kind == StimulusKind::NAME);
+    rep.rewind();
+
+    CHECK_EQ(rep.replay(), 4);
+    CHECK(!a.getState(0).b);
+    CHECK(a.getState(0).type == WireStateValueType::BIT);
+    CHECK_EQ(b.getState(0).ll, 0x1234);
+    CHECK_EQ(replayed_event, 42);
+    return test_result();
+}
@@ -0,0 +1,98 @@
+// pure subcircuits: cache hits and misses, LRU eviction order, and a width
+// change after setPure() starting a new key layout
+#include <memory>
+
+#include "main_init.hpp"
+#include "digitallogicgates.hpp"
+#include "numberconfigentries.hpp"
+#include "subcircuit.hpp"
+
+#include "check.hpp"
+
+using namespace LogicSim;
+
+class Driver final : public BasicGate {
+protected:
+    virtual void update() override {};
+public:
+    Driver() : BasicGate(0, 1) {};
+    virtual const char* getObjectType() override {
+        return "Driver";
+    }
+    void drive(WireStateValue v) {
+        write_pin(0, v);
+    }
+};
+
+static Driver* da;
+static Driver* db;
+// both inputs change in one batch, so the subcircuit looks up once
+static void apply(unsigned long long a, unsigned long long b, bool wide) {
+    bool was = BasicGate::beginUpdate();
+    if (wide) {
+        da->drive(WireStateValue(a));
+        db->drive(WireStateValue(b));
+    } else {
+        da->drive(WireStateValue((bool)a));
+        db->drive(WireStateValue((bool)b));
+    }
+    BasicGate::endUpdate(was);
+}
+
+int main() {
+    Wire a, b, y;
+    Driver pa, pb;
+    da = &pa;
+    db = &pb;
+    SubCircuit sc(2, 1);
+    DigitalLogic::AndGate inner;
+    connect(inner.getPin(0), sc.getInputWire(0));
+    connect(inner.getPin(1), sc.getInputWire(1));
+    connect(inner.getPin(2), sc.getOutputWire(0));
+    sc.add(&inner);
+    sc.setPure(2);
+    connect(pa.getPin(0), &a);
+    connect(pb.getPin(0), &b);
+    connect(sc.getPin(0), &a);
+    connect(sc.getPin(1), &b);
+    connect(sc.getPin(2), &y);
+
+    apply(0, 0, false);
+    CHECK_EQ(y.getState(0).b, false);
+    apply(1, 1, false);
+    CHECK_EQ(y.getState(0).b, true);
+    CHECK_EQ(sc.getMisses(), 2);
+    CHECK_EQ(sc.getHits(), 0);
+    // (0,0) becomes the most recent, so (1,1) is evicted next
+    apply(0, 0, false);
+    CHECK_EQ(sc.getHits(), 1);
+    apply(1, 0, false);
+    CHECK_EQ(y.getState(0).b, false);
+    CHECK_EQ(sc.getMisses(), 3);
+    CHECK_EQ(sc.getEvictions(), 1);
+    apply(0, 0, false);
+    CHECK_EQ(sc.getHits(), 2);
+    apply(1, 1, false);
+    CHECK_EQ(y.getState(0).b, true);
+    CHECK_EQ(sc.getMisses(), 4);
+    CHECK_EQ(sc.getEvictions(), 2);
+    // (1,0) went out, (0,0) stayed
+    apply(1, 0, false);
+    CHECK_EQ(sc.getMisses(), 5);
+    apply(0, 0, false);
+    CHECK_EQ(sc.getMisses(), 6);
+    CHECK_EQ(sc.getHits(), 2);
+
+    // 64-bit ports need two key words; the old one-word entries must not hit
+    sc.config_table.insert(ConfigKeys::Bits, std::unique_ptr<ConfigEntry>(new UShortConfigEntry(64)));
+    apply(~0ULL, 1, true);
+    CHECK_EQ(sc.getMisses(), 7);
+    CHECK_EQ(y.getState(0).ll, 1);
+    apply(0, 0, true);
+    CHECK_EQ(sc.getMisses(), 8);
+    CHECK_EQ(sc.getHits(), 2);
+    apply(~0ULL, 1, true);
+    CHECK_EQ(sc.getHits(), 3);
+    CHECK_EQ(y.getState(0).ll, 1);
+    return test_result();
+}
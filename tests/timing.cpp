@@ -0,0 +1,139 @@
+// static timing through a register: paths restart at its output; parallel
+// sweeps match a single thread, and rewiring re-times the old fanin
+#include <memory>
+#include <vector>
+
+#include "main_init.hpp"
+#include "digitallogicgates.hpp"
+#include "numberconfigentries.hpp"
+#include "netlist.hpp"
+#include "timing.hpp"
+
+#include "check.hpp"
+
+using namespace LogicSim;
+
+static void setDelay(ConfigurableBasicGate& g, long double d) {
+    g.config_table.insert(ConfigKeys::Delay, std::unique_ptr<ConfigEntry>(new FloatConfigEntry(d)));
+}
+
+// every wire's arrival and required time agree between the two analyzers
+static bool same(Netlist& net, TimingAnalyzer& x, TimingAnalyzer& y) {
+    for (auto w : net.getWires()) {
+        if (x.getArrival(w) != y.getArrival(w) || x.getRequired(w) != y.getRequired(w)) return false;
+    }
+    return true;
+}
+
+int main() {
+    // in -> a (2) -> d -> reg (1) -> q -> b (3) -> out
+    Wire in, d, q, out;
+    DigitalLogic::NotGate a, b;
+    DigitalLogic::RegisterGate reg;
+    connect(a.getPin(0), &in);
+    connect(a.getPin(1), &d);
+    connect(reg.getPin(0), &d);
+    connect(reg.getPin(2), &q);
+    connect(b.getPin(0), &q);
+    connect(b.getPin(1), &out);
+    setDelay(a, 2);
+    setDelay(reg, 1);
+    setDelay(b, 3);
+    // b comes first, so it is looked at before the register it reads
+    Netlist net({&b, &reg, &a});
+
+    for (unsigned int threads : {1u, 4u}) {
+        // too small to split; the large design below runs the threads
+        TimingAnalyzer sta(net, 10);
+        sta.setThreads(threads);
+        sta.analyze();
+        CHECK_EQ(sta.getArrival(&d), 2);
+        CHECK_EQ(sta.getArrival(&q), 1);
+        CHECK_EQ(sta.getArrival(&out), 4);
+        CHECK_EQ(sta.getSlack(&out), 6);
+        CHECK_EQ(sta.getSlack(&d), 8);
+    }
+
+    // an incremental change behind the register moves only its own path
+    TimingAnalyzer sta(net, 10);
+    sta.analyze();
+    setDelay(reg, 2);
+    sta.delaysChanged(&reg);
+    sta.update();
+    CHECK_EQ(sta.getArrival(&q), 2);
+    CHECK_EQ(sta.getArrival(&out), 5);
+    CHECK_EQ(sta.getArrival(&d), 2);
+
+    // moving c off x relaxes x, so the driver of x must be re-timed too
+    //   i -> p (2) -> x -> r (1) -> o1
+    //                 x -> c (3) -> y -> e (3) -> o2
+    {
+        Wire i, i2, x, y, o1, o2;
+        DigitalLogic::NotGate p, r, c, e;
+        connect(p.getPin(0), &i);
+        connect(p.getPin(1), &x);
+        connect(r.getPin(0), &x);
+        connect(r.getPin(1), &o1);
+        connect(c.getPin(0), &x);
+        connect(c.getPin(1), &y);
+        connect(e.getPin(0), &y);
+        connect(e.getPin(1), &o2);
+        setDelay(p, 2);
+        setDelay(r, 1);
+        setDelay(c, 3);
+        setDelay(e, 3);
+        Netlist rn({&p, &r, &c, &e});
+        TimingAnalyzer inc(rn, 10);
+        inc.analyze();
+        CHECK_EQ(inc.getRequired(&i), 2);
+        rn.connectPin(c.getPin(0), &i2);
+        inc.update();
+        TimingAnalyzer full(rn, 10);
+        full.analyze();
+        CHECK_EQ(full.getRequired(&i), 7);
+        CHECK_EQ(inc.getRequired(&i), 7);
+        CHECK_EQ(inc.getSlack(&i), 7);
+        CHECK(same(rn, inc, full));
+        rn.removeGate(&r);
+        inc.update();
+        TimingAnalyzer again(rn, 10);
+        again.analyze();
+        CHECK_EQ(inc.getRequired(&i), 8);
+        CHECK(same(rn, inc, again));
+    }
+
+    // 1024 chains of 5 gates: past the size at which the sweep goes parallel,
+    // with levels wide enough to hand every thread its own grain
+    {
+        const int chains = 1024, depth = 5;
+        std::vector<std::unique_ptr<Wire>> wires;
+        std::vector<std::unique_ptr<DigitalLogic::NotGate>> gates;
+        std::vector<BasicGate*> all;
+        for (int ch = 0; ch < chains; ch++) {
+            wires.emplace_back(new Wire());
+            for (int k = 0; k < depth; k++) {
+                Wire* prev = wires.back().get();
+                wires.emplace_back(new Wire());
+                gates.emplace_back(new DigitalLogic::NotGate());
+                connect(gates.back()->getPin(0), prev);
+                connect(gates.back()->getPin(1), wires.back().get());
+                setDelay(*gates.back(), (long double)((ch * 7 + k * 3) % 5 + 1));
+                all.push_back(gates.back().get());
+            }
+        }
+        {
+            Netlist big(all);
+            TimingAnalyzer one(big, 250), four(big, 250);
+            one.setThreads(1);
+            four.setThreads(4);
+            one.analyze();
+            four.analyze();
+            CHECK(same(big, one, four));
+            CHECK(one.getSlack(wires.back().get()) == 250 - one.getArrival(wires.back().get()));
+        }
+        // newest first keeps the registry erase short
+        while (!gates.empty()) gates.pop_back();
+        while (!wires.empty()) wires.pop_back();
+    }
+    return test_result();
+}
@@ -0,0 +1,78 @@
+// vector files: valid files load, truncated and corrupt ones are rejected
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#include "main_init.hpp"
+#include "serializer.hpp"
+#include "vectorfile.hpp"
+
+#include "check.hpp"
+
+using namespace LogicSim;
+
+static const char* path = "vectorfile_test.lsvf";
+
+static void save(const std::string& bytes) {
+    FILE* f = std::fopen(path, "wb");
+    std::fwrite(bytes.data(), 1, bytes.size(), f);
+    std::fclose(f);
+}
+static bool rejected(const std::string& bytes) {
+    save(bytes);
+    try {
+        VectorSource src(path);
+    } catch (Exceptions::MalformedVectorFileError&) {
+        return true;
+    }
+    return false;
+}
+template <typename T>
+static void patch(std::string& bytes, size_t at, T v) {
+    std::memcpy(&bytes[at], &v, sizeof(T));
+}
+
+int main() {
+    // one 64-bit input column "a" and one 1-bit expect column "e"
+    VectorFileBuilder builder;
+    builder.addColumn("a", VectorColumnKind::INPUT, 64);
+    builder.addColumn("e", VectorColumnKind::EXPECT, 1);
+    for (unsigned long long r = 0; r < 100; r++) builder.addRow({r * 3, r & 1});
+    StateWriter out;
+    builder.write(out);
+    const std::string good(out.data(), out.size());
+
+    save(good);
+    {
+        VectorSource src(path);
+        CHECK_EQ(src.getRows(), 100ULL);
+        CHECK_EQ(src.getColumns().size(), 2ULL);
+        CHECK_EQ(src.getColumns()[0].width, 8);
+    }
+
+    CHECK(rejected(std::string()));
+    CHECK(rejected(good.substr(0, 20)));
+    std::string magic = good;
+    magic[0] = 'X';
+    CHECK(rejected(magic));
+    // cut inside the column table, then inside the column data
+    CHECK(rejected(good.substr(0, 30)));
+    CHECK(rejected(good.substr(0, good.size() - 1)));
+
+    std::string width = good;
+    patch<unsigned char>(width, 24 + 1, 3);
+    CHECK(rejected(width));
+    std::string name = good;
+    patch<unsigned int>(name, 24 + 4, 0xFFFFFFFFu);
+    CHECK(rejected(name));
+    std::string offset = good;
+    patch<unsigned long long>(offset, 24 + 8, ~0ULL - 16);
+    CHECK(rejected(offset));
+    // 2^61 rows of 8 bytes wraps to 0 in a plain product
+    std::string rows = good;
+    patch<unsigned long long>(rows, 16, 1ULL << 61);
+    CHECK(rejected(rows));
+
+    std::remove(path);
+    return test_result();
+}
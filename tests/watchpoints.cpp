@@ -0,0 +1,103 @@
+// watchpoints: each predicate fires on entering its condition only,
+// removal, hit counts, and breakpoints and events on a simulator
+#include <vector>
+
+#include "main_init.hpp"
+#include "mainsim.hpp"
+#include "watchpoints.hpp"
+
+#include "check.hpp"
+
+using namespace LogicSim;
+
+class Driver final : public BasicGate {
+protected:
+    virtual void update() override {};
+public:
+    Driver() : BasicGate(0, 1) {};
+    virtual const char* getObjectType() override {
+        return "Driver";
+    }
+    void drive(unsigned long long v) {
+        write_pin(0, WireStateValue(v));
+    }
+};
+
+struct Hits {
+    int calls = 0;
+    unsigned long long last = 0;
+};
+static void onHit(void* instance, Wire*, unsigned long long v) {
+    Hits* h = (Hits*)instance;
+    h->calls++;
+    h->last = v;
+}
+static void onEvent(void* instance, Wire* w, unsigned long long v) {
+    onHit(instance, w, v);
+}
+
+static Driver* scheduled;
+static unsigned long long next_value;
+static void driveNext(void*) {
+    scheduled->drive(next_value++);
+}
+
+int main() {
+    Wire w;
+    Driver d;
+    connect(d.getPin(0), &w);
+    d.drive(0);
+
+    Hits eq, mask, rise, change, range;
+    unsigned int eq_id = watch_equal(&w, 5, onHit, &eq);
+    watch_mask(&w, 0xF0, 0x50, onHit, &mask);
+    watch_edge(&w, true, 1, onHit, &rise);
+    watch_change(&w, onHit, &change);
+    watch_range(&w, 10, 20, onHit, &range);
+
+    const unsigned long long seq[] = {5, 5, 3, 5, 0x52, 0x57, 12, 15, 30, 11};
+    for (auto v : seq) d.drive(v);
+    // 5 is entered twice; driving the same value again is no change
+    CHECK_EQ(eq.calls, 2);
+    CHECK_EQ(mask.calls, 1);
+    CHECK_EQ(mask.last, 0x52);
+    // bit 1 rises at 3, 0x52 and 15
+    CHECK_EQ(rise.calls, 3);
+    CHECK_EQ(change.calls, 9);
+    CHECK_EQ(range.calls, 2);
+    CHECK_EQ(range.last, 11);
+    CHECK_EQ(w.getWatch(eq_id)->hits, 2);
+
+    // a removed watchpoint no longer fires; the list goes with the last one
+    CHECK(w.removeWatch(eq_id));
+    CHECK(!w.removeWatch(eq_id));
+    d.drive(0);
+    d.drive(5);
+    CHECK_EQ(eq.calls, 2);
+    CHECK(w.getWatch(eq_id) == nullptr);
+
+    // a breakpoint stops the run after the step in which the value became 7;
+    // the same predicate also fires an event
+    Wire s;
+    Driver sd;
+    connect(sd.getPin(0), &s);
+    sd.drive(0);
+    scheduled = &sd;
+    next_value = 1;
+    MainSim sim;
+    for (SimTime t = 10; t <= 100; t += 10) sim.schedule(t, driveNext, nullptr);
+    Watchpoint seven = watch_predicate(WatchKind::EQUAL, ~0ULL, 7);
+    break_on(&s, seven, sim);
+    Event<Wire*, unsigned long long> event;
+    Hits ev;
+    auto handler = event.Connect(onEvent, &ev);
+    notify_on(&s, seven, event);
+    CHECK(!sim.runUntil(1000));
+    CHECK_EQ(sim.getTime(), 70);
+    CHECK_EQ(ev.calls, 1);
+    CHECK_EQ(ev.last, 7);
+    CHECK(sim.runUntil(1000));
+    CHECK_EQ(s.getState(0).ll, 10);
+    CHECK_EQ(ev.calls, 1);
+    return test_result();
+}
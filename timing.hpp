@@ -0,0 +1,408 @@
+#pragma once
+
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <queue>
+#include <limits>
+#include <memory>
+#include <algorithm>
+
+#include "main_init.hpp"
+#include "netlist.hpp"
+
+namespace LogicSim {
+    struct TimingPath {
+        unsigned int endpoint = NO_INDEX;
+        double arrival = 0;
+        double required = 0;
+        double slack = 0;
+        // both listed from the startpoint to the endpoint
+        vector<unsigned int> gates;
+        vector<unsigned int> wires;
+    };
+
+    // Static timing over a Netlist. Arc delays come from each
+    // gate's ConfigTable: "Delay.<n>" (float) for input pin n, falling back
+    // to "Delay" and then to the default delay. Sequential gates start paths
+    // (arrival = their delay) and end paths at their inputs, as do primary
+    // outputs. Arrival and required times are pulled per gate, so each level
+    // only reads results of lower (or, going back, higher) levels and can be
+    // split across threads without locking.
+    class TimingAnalyzer final : public LogicSimObject {
+        static constexpr double INF = std::numeric_limits<double>::infinity();
+        Netlist& netlist;
+        double required;
+        double default_delay = 1.0;
+        unsigned int threads = 0;
+        vector<double> gate_delay;
+        vector<vector<double>> arcs;
+        vector<double> gate_out;
+        vector<double> gate_req;
+        vector<double> input_arrival;
+        vector<ConfigKey> pin_keys;
+        vector<unsigned int> dirty;
+        vector<unsigned int> level;
+        vector<vector<unsigned int>> buckets;
+        bool full = true;
+        bool relevel_needed = true;
+
+        struct Barrier {
+            std::atomic<unsigned int> count{0};
+            std::atomic<unsigned int> generation{0};
+            unsigned int n;
+            Barrier(unsigned int n) : n(n) {};
+            void wait() {
+                unsigned int g = generation.load();
+                if (count.fetch_add(1) + 1 == n) {
+                    count = 0;
+                    generation++;
+                } else {
+                    while (generation.load() == g) std::this_thread::yield();
+                }
+            }
+        };
+
+        static void onNetlistChange(void* self, const vector<unsigned int>& affected) {
+            auto t = (TimingAnalyzer*)self;
+            t->dirty.insert(t->dirty.end(), affected.begin(), affected.end());
+            t->relevel_needed = true;
+        }
+        bool sequential(unsigned int g) {
+            auto gate = netlist.getGates()[g].gate;
+            return gate != nullptr && gate->isSequential();
+        }
+        double readDelay(ConfigurableBasicGate* c, ConfigKey key, double fallback) {
+            if (c == nullptr) return fallback;
+            auto a = c->config_table.find(key);
+            if (a == c->config_table.end() || a->second.get()->isNull()) return fallback;
+            return (double)a->second.get()->get_t<long double>();
+        }
+        const ConfigKey& pinKey(size_t k) {
+            while (pin_keys.size() <= k) pin_keys.push_back(ConfigKey("Delay." + to_string((unsigned long long)pin_keys.size())));
+            return pin_keys[k];
+        }
+        void loadDelays(unsigned int g) {
+            NetlistGate& ng = netlist.getGates()[g];
+            arcs[g].clear();
+            if (ng.gate == nullptr) return;
+            auto c = ng.gate->isConfigurable() ? dynamic_cast<ConfigurableBasicGate*>(ng.gate) : nullptr;
+            gate_delay[g] = readDelay(c, ConfigKeys::Delay, default_delay);
+            arcs[g].resize(ng.inputs.size());
+            for (size_t k = 0; k < ng.inputs.size(); k++) {
+                arcs[g][k] = readDelay(c, pinKey(k), gate_delay[g]);
+            }
+        }
+        void resize() {
+            size_t n = netlist.getGates().size();
+            gate_delay.resize(n, default_delay);
+            arcs.resize(n);
+            gate_out.resize(n, 0);
+            gate_req.resize(n, INF);
+            input_arrival.resize(netlist.getWires().size(), 0);
+        }
+        bool isEndpoint(unsigned int w) {
+            auto& fanout = netlist.getFanout(w);
+            if (fanout.empty()) return !netlist.getDrivers(w).empty();
+            for (auto r : fanout) {
+                if (sequential(r)) return true;
+            }
+            return false;
+        }
+        double forwardGate(unsigned int g) {
+            NetlistGate& ng = netlist.getGates()[g];
+            if (ng.gate == nullptr) return 0;
+            if (ng.gate->isSequential() || ng.inputs.empty()) return gate_delay[g];
+            double t = -INF;
+            for (size_t k = 0; k < ng.inputs.size(); k++) {
+                t = std::max(t, arrivalOf(ng.inputs[k]) + arcs[g][k]);
+            }
+            return t;
+        }
+        double backwardGate(unsigned int g) {
+            NetlistGate& ng = netlist.getGates()[g];
+            double t = INF;
+            if (ng.gate == nullptr) return t;
+            for (auto w : ng.outputs) {
+                if (w != NO_INDEX) t = std::min(t, requiredOf(w));
+            }
+            return t;
+        }
+        // Netlist levels run through registers; timing levels start over at
+        // every sequential gate, so only combinational loops are rejected.
+        // Level 0 holds the sequential gates alone: combinational gates start
+        // at 1, so a gate fed only by registers runs after their outputs exist.
+        void levelize() {
+            auto& gates = netlist.getGates();
+            size_t n = gates.size();
+            level.assign(n, 0);
+            buckets.clear();
+            vector<unsigned int> pending(n, 0), ready;
+            size_t live = 0;
+            for (unsigned int g = 0; g < n; g++) {
+                if (gates[g].gate == nullptr) continue;
+                live++;
+                if (!gates[g].gate->isSequential()) {
+                    level[g] = 1;
+                    for (auto w : gates[g].inputs) {
+                        if (w == NO_INDEX) continue;
+                        for (auto d : netlist.getDrivers(w)) {
+                            if (d != g && !sequential(d)) pending[g]++;
+                        }
+                    }
+                }
+                if (pending[g] == 0) ready.push_back(g);
+            }
+            for (size_t i = 0; i < ready.size(); i++) {
+                unsigned int g = ready[i];
+                if (buckets.size() <= level[g]) buckets.resize(level[g] + 1);
+                buckets[level[g]].push_back(g);
+                if (gates[g].gate->isSequential()) continue;
+                for (auto w : gates[g].outputs) {
+                    if (w == NO_INDEX) continue;
+                    for (auto r : netlist.getFanout(w)) {
+                        if (r == g || sequential(r)) continue;
+                        level[r] = std::max(level[r], level[g] + 1);
+                        if (--pending[r] == 0) ready.push_back(r);
+                    }
+                }
+            }
+            if (ready.size() != live)
+                throw LogicSimException("Static timing requires a netlist without combinational loops", this);
+            relevel_needed = false;
+        }
+        template <typename F>
+        void sweep(const vector<vector<unsigned int>>& buckets, bool reverse, F kernel) {
+            size_t total = 0;
+            for (auto& b : buckets) total += b.size();
+            unsigned int n = threads != 0 ? threads : std::max(1u, std::thread::hardware_concurrency());
+            if (total < 4096) n = 1;
+            const size_t grain = 256;
+            size_t count = buckets.size();
+            std::unique_ptr<std::atomic<size_t>[]> cursors(new std::atomic<size_t>[count]);
+            for (size_t i = 0; i < count; i++) cursors[i] = 0;
+            Barrier barrier(n);
+            auto worker = [&]() {
+                for (size_t i = 0; i < count; i++) {
+                    size_t l = reverse ? count - 1 - i : i;
+                    const vector<unsigned int>& b = buckets[l];
+                    for (size_t s = cursors[l].fetch_add(grain); s < b.size(); s = cursors[l].fetch_add(grain)) {
+                        size_t e = std::min(b.size(), s + grain);
+                        for (size_t j = s; j < e; j++) kernel(b[j]);
+                    }
+                    if (n > 1) barrier.wait();
+                }
+            };
+            vector<std::thread> pool;
+            for (unsigned int i = 1; i < n; i++) pool.emplace_back(worker);
+            worker();
+            for (auto& t : pool) t.join();
+        }
+        void incremental() {
+            auto& gates = netlist.getGates();
+            vector<bool> queued(gates.size(), false), seed(gates.size(), false);
+            typedef std::pair<unsigned int, unsigned int> Item;
+            std::priority_queue<Item, vector<Item>, std::greater<Item>> fwd;
+            std::priority_queue<Item> bwd;
+            vector<unsigned int> seeds;
+            seeds.swap(dirty);
+            for (auto g : seeds) {
+                if (g >= gates.size()) continue;
+                loadDelays(g);
+                seed[g] = true;
+                if (!queued[g]) {
+                    queued[g] = true;
+                    fwd.push({level[g], g});
+                }
+            }
+            while (!fwd.empty()) {
+                unsigned int g = fwd.top().second;
+                fwd.pop();
+                queued[g] = false;
+                double v = forwardGate(g);
+                if (v == gate_out[g] && !seed[g]) continue;
+                gate_out[g] = v;
+                for (auto w : gates[g].outputs) {
+                    if (w == NO_INDEX) continue;
+                    for (auto r : netlist.getFanout(w)) {
+                        if (r == g || queued[r] || sequential(r)) continue;
+                        queued[r] = true;
+                        fwd.push({level[r], r});
+                    }
+                }
+            }
+            auto pushDrivers = [&](unsigned int g) {
+                for (auto w : gates[g].inputs) {
+                    if (w == NO_INDEX) continue;
+                    for (auto d : netlist.getDrivers(w)) {
+                        if (d == g || queued[d]) continue;
+                        queued[d] = true;
+                        bwd.push({level[d], d});
+                    }
+                }
+            };
+            for (auto g : seeds) {
+                if (g >= gates.size()) continue;
+                if (!queued[g]) {
+                    queued[g] = true;
+                    bwd.push({level[g], g});
+                }
+                pushDrivers(g);
+            }
+            while (!bwd.empty()) {
+                unsigned int g = bwd.top().second;
+                bwd.pop();
+                queued[g] = false;
+                double v = backwardGate(g);
+                if (v == gate_req[g]) continue;
+                gate_req[g] = v;
+                pushDrivers(g);
+            }
+        }
+    public:
+        virtual const char* getObjectType() {
+            return "TimingAnalyzer";
+        }
+        TimingAnalyzer(Netlist& netlist, double required) : netlist(netlist), required(required) {
+            netlist.onChange(onNetlistChange, this);
+        }
+        TimingAnalyzer(const TimingAnalyzer&) = delete;
+        TimingAnalyzer& operator=(const TimingAnalyzer&) = delete;
+        ~TimingAnalyzer() {
+            netlist.removeListener(this);
+        }
+        void setThreads(unsigned int n) {
+            threads = n;
+        }
+        void setDefaultDelay(double d) {
+            default_delay = d;
+            full = true;
+        }
+        void setRequired(double t) {
+            required = t;
+            full = true;
+        }
+        void setInputArrival(Wire* w, double t) {
+            unsigned int id = netlist.wireIndex(w);
+            if (id == NO_INDEX) return;
+            resize();
+            input_arrival[id] = t;
+            for (auto r : netlist.getFanout(id)) dirty.push_back(r);
+        }
+        // delays in a gate's ConfigTable changed
+        void delaysChanged(BasicGate* g) {
+            unsigned int id = netlist.gateIndex(g);
+            if (id != NO_INDEX) dirty.push_back(id);
+        }
+        void analyze() {
+            resize();
+            levelize();
+            dirty.clear();
+            full = false;
+            for (auto& b : buckets) {
+                for (auto g : b) loadDelays(g);
+            }
+            sweep(buckets, false, [this](unsigned int g) { gate_out[g] = forwardGate(g); });
+            sweep(buckets, true, [this](unsigned int g) { gate_req[g] = backwardGate(g); });
+        }
+        // re-times only what the edits since the last call can reach
+        void update() {
+            if (full) {
+                analyze();
+                return;
+            }
+            if (dirty.empty()) return;
+            resize();
+            if (relevel_needed) levelize();
+            incremental();
+        }
+        double arrivalOf(unsigned int w) {
+            if (w == NO_INDEX) return 0;
+            auto& d = netlist.getDrivers(w);
+            if (d.empty()) return w < input_arrival.size() ? input_arrival[w] : 0;
+            double t = -INF;
+            for (auto g : d) t = std::max(t, gate_out[g]);
+            return t;
+        }
+        double requiredOf(unsigned int w) {
+            auto& fanout = netlist.getFanout(w);
+            double t = fanout.empty() ? required : INF;
+            for (auto r : fanout) {
+                if (sequential(r)) {
+                    t = std::min(t, required);
+                    continue;
+                }
+                auto& ins = netlist.getGates()[r].inputs;
+                for (size_t k = 0; k < ins.size(); k++) {
+                    if (ins[k] == w) t = std::min(t, gate_req[r] - arcs[r][k]);
+                }
+            }
+            return t;
+        }
+        double slackOf(unsigned int w) {
+            return requiredOf(w) - arrivalOf(w);
+        }
+        double getArrival(Wire* w) {
+            return arrivalOf(netlist.wireIndex(w));
+        }
+        double getRequired(Wire* w) {
+            unsigned int id = netlist.wireIndex(w);
+            return id == NO_INDEX ? INF : requiredOf(id);
+        }
+        double getSlack(Wire* w) {
+            unsigned int id = netlist.wireIndex(w);
+            return id == NO_INDEX ? INF : slackOf(id);
+        }
+        vector<double> slacks() {
+            vector<double> ret(netlist.getWires().size());
+            for (unsigned int w = 0; w < ret.size(); w++) ret[w] = slackOf(w);
+            return ret;
+        }
+        // the critical path into each of the n endpoints with the least slack
+        vector<TimingPath> worstPaths(size_t n) {
+            auto& gates = netlist.getGates();
+            vector<std::pair<double, unsigned int>> ends;
+            for (unsigned int w = 0; w < netlist.getWires().size(); w++) {
+                if (isEndpoint(w)) ends.push_back({slackOf(w), w});
+            }
+            n = std::min(n, ends.size());
+            std::partial_sort(ends.begin(), ends.begin() + n, ends.end());
+            vector<TimingPath> ret;
+            for (size_t i = 0; i < n; i++) {
+                TimingPath p;
+                p.endpoint = ends[i].second;
+                p.slack = ends[i].first;
+                p.arrival = arrivalOf(p.endpoint);
+                p.required = p.arrival + p.slack;
+                unsigned int w = p.endpoint;
+                for (size_t steps = 0; steps <= gates.size(); steps++) {
+                    p.wires.push_back(w);
+                    auto& d = netlist.getDrivers(w);
+                    if (d.empty()) break;
+                    unsigned int g = d[0];
+                    for (auto x : d) {
+                        if (gate_out[x] > gate_out[g]) g = x;
+                    }
+                    p.gates.push_back(g);
+                    NetlistGate& ng = gates[g];
+                    if (ng.gate->isSequential() || ng.inputs.empty()) break;
+                    size_t best = 0;
+                    double t = -INF;
+                    for (size_t k = 0; k < ng.inputs.size(); k++) {
+                        double a = arrivalOf(ng.inputs[k]) + arcs[g][k];
+                        if (a > t) {
+                            t = a;
+                            best = k;
+                        }
+                    }
+                    if (ng.inputs[best] == NO_INDEX) break;
+                    w = ng.inputs[best];
+                }
+                std::reverse(p.gates.begin(), p.gates.end());
+                std::reverse(p.wires.begin(), p.wires.end());
+                ret.push_back(std::move(p));
+            }
+            return ret;
+        }
+    };
+};
@@ -1,7 +1,8 @@
 #pragma once
 #include <string>
-#include <sstream>
 #include <vector>
+#include <charconv>
+#include <cstdint>
 inline std::string to_string(const std::string& str) {
     return str;
 }
@@ -58,27 +59,33 @@ inline std::string to_string(double i) {
 inline std::string to_string(long double i) {
     return std::to_string(i);
 }
+inline char* hex_to_chars(char* first, char* last, uintptr_t v) {
+    *first++ = '0';
+    *first++ = 'x';
+    char* end = std::to_chars(first, last, v, 16).ptr;
+    for (char* c = first; c != end; c++) {
+        if (*c >= 'a' && *c <= 'f') *c -= 'a' - 'A';
+    }
+    return end;
+}
 inline std::string to_string(void* i) {
-    std::stringstream ss;
-    ss << std::hex << "0x" << std::uppercase <<(uintptr_t)i;
-    return ss.str();
+    char buf[2 + sizeof(uintptr_t) * 2];
+    return std::string(buf, hex_to_chars(buf, buf + sizeof(buf), (uintptr_t)i));
 }
-inline std::string to_string(uintptr_t v) {
-    std::stringstream ss;
-    ss << std::hex << "0x" << std::uppercase << v;
-    return ss.str();
+inline std::string to_hex_string(uintptr_t v) {
+    char buf[2 + sizeof(uintptr_t) * 2];
+    return std::string(buf, hex_to_chars(buf, buf + sizeof(buf), v));
 }
 template <typename T>
-inline std::string to_string(std::vector<T> v) {
+inline std::string to_string(const std::vector<T>& v) {
     if (v.size() == 0) {
         return "[]";
     }
-    std::stringstream ss;
-    ss << "[";
+    std::string s = "[";
     for (auto& i : v) {
-        ss << to_string(i) << ",";
+        s += to_string(i);
+        s += ',';
     }
-    ss.seekp(-1,ss.cur);
-    ss << "]";
-    return ss.str();
+    s.back() = ']';
+    return s;
 }
\ No newline at end of file
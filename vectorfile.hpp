@@ -0,0 +1,376 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <string>
+#include <cstring>
+
+#ifndef WIN32
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include "main_init.hpp"
+#include "serializer.hpp"
+#include "memorygates.hpp"
+#include "mainsim.hpp"
+#include "watchpoints.hpp"
+
+namespace LogicSim {
+    namespace Exceptions {
+        class MalformedVectorFileError : public LogicSimException {
+        public:
+            MalformedVectorFileError(const string& what, LogicSimObject* obj) :
+                LogicSimException("Malformed vector file: " + what, obj) {};
+            MalformedVectorFileError(const string& what) :
+                LogicSimException("Malformed vector file: " + what) {};
+        };
+        class StimulusMismatchError : public LogicSimException {
+        public:
+            StimulusMismatchError(unsigned long long row, const string& column, LogicSimObject* obj) :
+                LogicSimException("Expected value mismatch in column '" + column + "' at row " + to_string(row), obj) {};
+        };
+    };
+
+    enum class VectorColumnKind : unsigned char {
+        INPUT = 'I',
+        EXPECT = 'E',
+        TIME = 'T'
+    };
+    struct VectorColumn {
+        string name;
+        VectorColumnKind kind = VectorColumnKind::INPUT;
+        unsigned short bits = 1;
+        unsigned char width = 1;
+        unsigned long long offset = 0;
+    };
+    struct VectorMismatch {
+        unsigned long long row;
+        unsigned int column;
+        unsigned long long expected;
+        unsigned long long actual;
+    };
+
+    // Layout (little endian): "LSVF", u32 version 1, u32 columns, u32 0,
+    // u64 rows, then per column: kind, u8 width (1/2/4/8 bytes), u16 bits,
+    // u32 name length, u64 data offset, name. Every column's data is a
+    // contiguous, 64-byte aligned array of rows * width bytes.
+    class VectorFileBuilder final : public LogicSimObject {
+        vector<VectorColumn> columns;
+        vector<vector<unsigned long long>> data;
+    public:
+        virtual const char* getObjectType() {
+            return "VectorFileBuilder";
+        }
+        unsigned int addColumn(const string& name, VectorColumnKind kind, unsigned short bits) {
+            VectorColumn c;
+            c.name = name;
+            c.kind = kind;
+            c.bits = kind == VectorColumnKind::TIME ? 64 : bits;
+            c.width = c.bits <= 8 ? 1 : c.bits <= 16 ? 2 : c.bits <= 32 ? 4 : 8;
+            columns.push_back(c);
+            data.emplace_back();
+            return (unsigned int)columns.size() - 1;
+        }
+        // values are given in column order
+        void addRow(const vector<unsigned long long>& values) {
+            for (size_t c = 0; c < columns.size(); c++) {
+                data[c].push_back(c < values.size() ? values[c] : 0);
+            }
+        }
+        void write(StateWriter& out) {
+            unsigned long long rows = data.empty() ? 0 : data[0].size();
+            unsigned long long offset = 24;
+            for (auto& c : columns) offset += 16 + c.name.size();
+            for (auto& c : columns) {
+                offset = (offset + 63) & ~63ULL;
+                c.offset = offset;
+                offset += rows * c.width;
+            }
+            unsigned long long pos = 0;
+            auto pad = [&](unsigned long long to) {
+                while (pos < to) {
+                    out.put('\0');
+                    pos++;
+                }
+            };
+            out.put("LSVF", 4);
+            out.putRaw<unsigned int>(1);
+            out.putRaw<unsigned int>((unsigned int)columns.size());
+            out.putRaw<unsigned int>(0);
+            out.putRaw<unsigned long long>(rows);
+            pos = 24;
+            for (auto& c : columns) {
+                out.putRaw<unsigned char>((unsigned char)c.kind);
+                out.putRaw<unsigned char>(c.width);
+                out.putRaw<unsigned short>(c.bits);
+                out.putRaw<unsigned int>((unsigned int)c.name.size());
+                out.putRaw<unsigned long long>(c.offset);
+                out.put(c.name.data(), c.name.size());
+                pos += 16 + c.name.size();
+            }
+            for (size_t i = 0; i < columns.size(); i++) {
+                pad(columns[i].offset);
+                for (auto v : data[i]) {
+                    for (unsigned char b = 0; b < columns[i].width; b++) out.put((char)(v >> (8 * b)));
+                }
+                pos += rows * columns[i].width;
+            }
+        }
+    };
+
+    // Drives one output pin per INPUT column straight from the mapped file.
+    // A row is applied inside a single BasicGate::beginUpdate/endUpdate
+    // bracket, so the circuit settles once per row rather than once per pin,
+    // and only columns whose value changed are written. EXPECT columns of a
+    // row are compared against their wires just before the next row is
+    // applied (and by finish()).
+    class VectorSource final : public BasicGate {
+        struct InputBinding {
+            unsigned int column;
+            unsigned long long last;
+            bool written;
+        };
+        struct ExpectBinding {
+            unsigned int column;
+            Wire* wire;
+        };
+        unique_ptr<MemoryImage> image;
+        vector<VectorColumn> columns;
+        unsigned long long rows = 0;
+        vector<InputBinding> inputs;
+        vector<ExpectBinding> expects;
+        int time_column = -1;
+        unsigned long long row = 0;
+        bool checked = true;
+        unsigned long long prefetch_rows = 4096;
+        unsigned long long prefetched = 0;
+        unsigned long long mismatch_count = 0;
+        vector<VectorMismatch> mismatches;
+        MainSim* sim = nullptr;
+        SimTime start_time = 0;
+        SimTime period = 0;
+
+        static unsigned short countInputs(MemoryImage* img) {
+            const unsigned char* p = img->bytes();
+            if (img->size() < 24 || std::memcmp(p, "LSVF", 4) != 0) {
+                delete img;
+                throw Exceptions::MalformedVectorFileError("bad header");
+            }
+            unsigned int n;
+            std::memcpy(&n, p + 8, 4);
+            size_t off = 24;
+            unsigned short inputs = 0;
+            for (unsigned int c = 0; c < n; c++) {
+                unsigned int len;
+                if (off + 16 > img->size()) {
+                    delete img;
+                    throw Exceptions::MalformedVectorFileError("truncated column table");
+                }
+                std::memcpy(&len, p + off + 4, 4);
+                if (p[off] == (unsigned char)VectorColumnKind::INPUT && inputs++ == 0xFFFF) {
+                    delete img;
+                    throw Exceptions::MalformedVectorFileError("too many input columns");
+                }
+                off += 16 + len;
+            }
+            return inputs;
+        }
+        VectorSource(MemoryImage* img) : BasicGate(0, countInputs(img)), image(img) {
+            const unsigned char* p = image->bytes();
+            unsigned int n;
+            std::memcpy(&n, p + 8, 4);
+            std::memcpy(&rows, p + 16, 8);
+            size_t off = 24;
+            for (unsigned int c = 0; c < n; c++) {
+                VectorColumn col;
+                unsigned int len;
+                col.kind = (VectorColumnKind)p[off];
+                col.width = p[off + 1];
+                std::memcpy(&col.bits, p + off + 2, 2);
+                std::memcpy(&len, p + off + 4, 4);
+                std::memcpy(&col.offset, p + off + 8, 8);
+                off += 16;
+                if (off + len > image->size())
+                    throw Exceptions::MalformedVectorFileError("truncated column name", this);
+                col.name.assign((const char*)p + off, len);
+                off += len;
+                if (col.width != 1 && col.width != 2 && col.width != 4 && col.width != 8)
+                    throw Exceptions::MalformedVectorFileError("column '" + col.name + "' has an invalid width", this);
+                // written so that neither the product nor the sum can wrap
+                if (col.offset > image->size() || rows > (image->size() - col.offset) / col.width)
+                    throw Exceptions::MalformedVectorFileError("column '" + col.name + "' extends past the end of the file", this);
+                if (col.kind == VectorColumnKind::INPUT) inputs.push_back({c, 0, false});
+                if (col.kind == VectorColumnKind::TIME) time_column = (int)c;
+                columns.push_back(col);
+            }
+#ifndef WIN32
+            if (image->size() > 0) madvise((void*)image->bytes(), image->size(), MADV_SEQUENTIAL);
+#endif
+        }
+        unsigned long long load(unsigned int c, unsigned long long r) {
+            const VectorColumn& col = columns[c];
+            const unsigned char* p = image->bytes() + col.offset + r * col.width;
+            switch (col.width) {
+            case 1:
+                return *p;
+            case 2: {
+                unsigned short v;
+                std::memcpy(&v, p, 2);
+                return v;
+            }
+            case 4: {
+                unsigned int v;
+                std::memcpy(&v, p, 4);
+                return v;
+            }
+            default: {
+                unsigned long long v;
+                std::memcpy(&v, p, 8);
+                return v;
+            }
+            }
+        }
+        // asks the kernel for the next window of every column before it is needed
+        void prefetch(unsigned long long r) {
+            if (r < prefetched || prefetch_rows == 0) return;
+            unsigned long long end = std::min(rows, r + 2 * prefetch_rows);
+#ifndef WIN32
+            static const size_t page = (size_t)sysconf(_SC_PAGESIZE);
+            for (auto& col : columns) {
+                uintptr_t a = (uintptr_t)(image->bytes() + col.offset + r * col.width);
+                uintptr_t b = (uintptr_t)(image->bytes() + col.offset + end * col.width);
+                a &= ~(uintptr_t)(page - 1);
+                if (b > a) madvise((void*)a, b - a, MADV_WILLNEED);
+            }
+#endif
+            prefetched = r + prefetch_rows;
+        }
+        void check() {
+            if (checked || row == 0) return;
+            checked = true;
+            unsigned long long r = row - 1;
+            for (auto& e : expects) {
+                const VectorColumn& col = columns[e.column];
+                unsigned long long mask = col.bits >= 64 ? ~0ULL : (1ULL << col.bits) - 1;
+                unsigned long long expected = load(e.column, r);
+                unsigned long long actual = wire_value_bits(e.wire->getState(0)) & mask;
+                if (actual == (expected & mask)) continue;
+                mismatch_count++;
+                if (mismatches.size() < Diagnostics::capacity) mismatches.push_back({r, e.column, expected, actual});
+                WireStateValue ev(expected), av(actual);
+                if (diagnostics.report(DiagnosticCode::STIMULUS_MISMATCH, e.wire, &ev, &av))
+                    throw Exceptions::StimulusMismatchError(r, col.name, this);
+            }
+        }
+        static void onEdge(void* self, Wire*, unsigned long long) {
+            ((VectorSource*)self)->step();
+        }
+        static void onSchedule(void* self) {
+            VectorSource* s = (VectorSource*)self;
+            if (s->step()) s->scheduleNext();
+        }
+        void scheduleNext() {
+            if (row >= rows) return;
+            SimTime t = time_column >= 0 ? (SimTime)load((unsigned int)time_column, row) : start_time + row * period;
+            sim->schedule(t, onSchedule, this);
+        }
+    protected:
+        virtual void update() override {};
+    public:
+        virtual const char* getObjectType() override {
+            return "VectorSource";
+        }
+        VectorSource(const string& path) : VectorSource(new MemoryImage(path)) {};
+        unsigned long long getRows() {
+            return rows;
+        }
+        unsigned long long getRow() {
+            return row;
+        }
+        const vector<VectorColumn>& getColumns() {
+            return columns;
+        }
+        int findColumn(const string& name) {
+            for (size_t c = 0; c < columns.size(); c++) {
+                if (columns[c].name == name) return (int)c;
+            }
+            return -1;
+        }
+        // INPUT columns drive the wire, EXPECT columns are compared against it
+        void bind(const string& column, Wire* wire) {
+            int c = findColumn(column);
+            if (c < 0) throw LogicSimException("No column '" + column + "' in vector file", this);
+            if (columns[c].kind == VectorColumnKind::EXPECT) {
+                expects.push_back({(unsigned int)c, wire});
+                return;
+            }
+            for (size_t i = 0; i < inputs.size(); i++) {
+                if (inputs[i].column == (unsigned int)c) {
+                    connect(getPin((unsigned short)i), wire);
+                    return;
+                }
+            }
+            throw LogicSimException("Column '" + column + "' cannot be bound", this);
+        }
+        void bind(const string& column, Pin* pin) {
+            if (pin->getWire() == nullptr) throw LogicSimException("Pin is not connected to a wire", pin);
+            bind(column, pin->getWire());
+        }
+        void setPrefetchRows(unsigned long long n) {
+            prefetch_rows = n;
+        }
+        // applies the next row; false once the file is exhausted
+        bool step() {
+            check();
+            if (row >= rows) return false;
+            prefetch(row);
+            bool was = beginUpdate();
+            try {
+                for (size_t i = 0; i < inputs.size(); i++) {
+                    InputBinding& b = inputs[i];
+                    unsigned long long v = load(b.column, row);
+                    if (b.written && v == b.last) continue;
+                    b.last = v;
+                    b.written = true;
+                    if (columns[b.column].bits == 1) write_pin((unsigned short)i, WireStateValue((bool)(v & 1)));
+                    else write_pin((unsigned short)i, WireStateValue(v));
+                }
+            } catch (...) {
+                endUpdate(was);
+                throw;
+            }
+            row++;
+            checked = false;
+            endUpdate(was);
+            return true;
+        }
+        // compares the last applied row
+        void finish() {
+            check();
+        }
+        void rewind() {
+            row = 0;
+            checked = true;
+            prefetched = 0;
+            for (auto& b : inputs) b.written = false;
+        }
+        // one row per rising edge of the clock wire
+        unsigned int clockOn(Wire* clock) {
+            return watch_edge(clock, true, 0, onEdge, this);
+        }
+        // rows are applied at their TIME column, or at start + row * period without one
+        void schedule(MainSim& s, SimTime start = 0, SimTime row_period = 1) {
+            sim = &s;
+            start_time = start;
+            period = row_period;
+            scheduleNext();
+        }
+        unsigned long long getMismatchCount() {
+            return mismatch_count;
+        }
+        const vector<VectorMismatch>& getMismatches() {
+            return mismatches;
+        }
+    };
+};
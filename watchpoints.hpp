@@ -0,0 +1,72 @@
+#pragma once
+
+#include "main_init.hpp"
+#include "mainsim.hpp"
+
+namespace LogicSim {
+    // Builders for the predicates understood by Wire::addWatch.
+    // watch_predicate() only fills in a Watchpoint, to be attached with
+    // break_on() or notify_on(); the watch_* builders attach theirs and
+    // return the watchpoint id, which Wire::removeWatch accepts.
+    inline Watchpoint watch_predicate(WatchKind kind, unsigned long long mask, unsigned long long value, unsigned long long high = 0, unsigned short index = 0) {
+        Watchpoint w;
+        w.kind = kind;
+        w.mask = mask;
+        w.value = value & mask;
+        w.high = high;
+        w.index = index;
+        return w;
+    }
+    inline unsigned int watch_equal(Wire* wire, unsigned long long value, void (*f)(void*, Wire*, unsigned long long), void* instance) {
+        Watchpoint w = watch_predicate(WatchKind::EQUAL, ~0ULL, value);
+        w.callback = f;
+        w.instance = instance;
+        return wire->addWatch(w);
+    }
+    inline unsigned int watch_mask(Wire* wire, unsigned long long mask, unsigned long long value, void (*f)(void*, Wire*, unsigned long long), void* instance) {
+        Watchpoint w = watch_predicate(WatchKind::MASK, mask, value);
+        w.callback = f;
+        w.instance = instance;
+        return wire->addWatch(w);
+    }
+    // edges are taken on a single bit of the value
+    inline unsigned int watch_edge(Wire* wire, bool rising, unsigned short bit, void (*f)(void*, Wire*, unsigned long long), void* instance) {
+        Watchpoint w = watch_predicate(rising ? WatchKind::RISING : WatchKind::FALLING, 1ULL << (bit & 63), 0);
+        w.callback = f;
+        w.instance = instance;
+        return wire->addWatch(w);
+    }
+    inline unsigned int watch_change(Wire* wire, void (*f)(void*, Wire*, unsigned long long), void* instance) {
+        Watchpoint w = watch_predicate(WatchKind::CHANGE, ~0ULL, 0);
+        w.callback = f;
+        w.instance = instance;
+        return wire->addWatch(w);
+    }
+    // fires when the value enters [low, high]
+    inline unsigned int watch_range(Wire* wire, unsigned long long low, unsigned long long high, void (*f)(void*, Wire*, unsigned long long), void* instance) {
+        Watchpoint w = watch_predicate(WatchKind::RANGE, ~0ULL, low, high);
+        w.callback = f;
+        w.instance = instance;
+        return wire->addWatch(w);
+    }
+
+    namespace Watch {
+        inline void pauseSim(void* sim, Wire*, unsigned long long) {
+            ((MainSim*)sim)->pause();
+        }
+        inline void fireEvent(void* event, Wire* wire, unsigned long long value) {
+            ((Event<Wire*, unsigned long long>*)event)->createCaller()(wire, value);
+        }
+    };
+    // breakpoint: the scheduler stops after the time step in which the predicate matched
+    inline unsigned int break_on(Wire* wire, Watchpoint w, MainSim& sim) {
+        w.callback = Watch::pauseSim;
+        w.instance = &sim;
+        return wire->addWatch(w);
+    }
+    inline unsigned int notify_on(Wire* wire, Watchpoint w, Event<Wire*, unsigned long long>& event) {
+        w.callback = Watch::fireEvent;
+        w.instance = &event;
+        return wire->addWatch(w);
+    }
+};